@@ -0,0 +1,147 @@
+/**
+ * @file Main.cpp
+ * @brief Command-line tool for looking things up in .wpilog files
+ *
+ * Built for the desktop only (see the logReader component in build.gradle):
+ *
+ * ```bash
+ * ./gradlew logReaderReleaseExecutable   # Binary is under build/exe/logReader
+ * logReader match.wpilog                              # List entries
+ * logReader match.wpilog get robot/drive/pose 42.3    # Value at t = 42.3 s
+ * logReader match.wpilog range robot/drive/pose 40 45 # Values in 40-45 s
+ * ```
+ *
+ * Times are in seconds, matching the timestamps AdvantageScope shows.
+ * Index and query times are printed to stderr.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <string>
+
+#include "WPILogFormatter.h"
+#include "WPILogIndex.h"
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    using Clock = chrono::steady_clock;
+
+    int Usage()
+    {
+        fprintf(stderr,
+                "usage: logReader <file.wpilog>\n"
+                "       logReader <file.wpilog> get <key> <seconds>\n"
+                "       logReader <file.wpilog> range <key> <start seconds> "
+                "<end seconds>\n");
+        return 1;
+    }
+
+    int64_t ToMicroseconds(const char* seconds)
+    {
+        return static_cast<int64_t>(stod(seconds) * 1e6);
+    }
+
+    double Milliseconds(Clock::duration duration)
+    {
+        return chrono::duration<double, milli>(duration).count();
+    }
+
+    void PrintRecord(WPILogFormatter& formatter,
+                     const WPILogIndex::Entry& entry,
+                     const WPILogIndex::Record& record)
+    {
+        printf("%.6f %s\n", record.timestamp * 1e-6,
+               formatter.Format(entry, record.payload).c_str());
+    }
+
+    void List(const WPILogIndex& log)
+    {
+        for (const auto& entry : log.Entries())
+        {
+            printf("%-48s %-24s %8zu", entry.name.c_str(), entry.type.c_str(),
+                   entry.records.size());
+            if (!entry.records.empty())
+            {
+                printf("  %.3f-%.3f s", entry.records.front().timestamp * 1e-6,
+                       entry.records.back().timestamp * 1e-6);
+            }
+            printf("\n");
+        }
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2 && argc != 5 && argc != 6)
+    {
+        return Usage();
+    }
+
+    try
+    {
+        auto start = Clock::now();
+        WPILogIndex log{argv[1]};
+        fprintf(stderr, "Indexed %zu records in %zu entries in %.2f ms\n",
+                log.RecordCount(), log.Entries().size(),
+                Milliseconds(Clock::now() - start));
+
+        if (argc == 2)
+        {
+            List(log);
+            return 0;
+        }
+
+        string command = argv[2];
+        const auto* entry = log.Find(argv[3]);
+        if (!entry)
+        {
+            fprintf(stderr, "No entry (or more than one) matches %s\n",
+                    argv[3]);
+            return 1;
+        }
+
+        WPILogFormatter formatter{log};
+        if (command == "get" && argc == 5)
+        {
+            int64_t time = ToMicroseconds(argv[4]);
+            start = Clock::now();
+            auto record = log.ValueAt(*entry, time);
+            fprintf(stderr, "Query took %.3f ms\n",
+                    Milliseconds(Clock::now() - start));
+            if (!record)
+            {
+                fprintf(stderr, "%s has no value at %s s\n",
+                        entry->name.c_str(), argv[4]);
+                return 1;
+            }
+            PrintRecord(formatter, *entry, *record);
+        }
+        else if (command == "range" && argc == 6)
+        {
+            int64_t first = ToMicroseconds(argv[4]);
+            int64_t last = ToMicroseconds(argv[5]);
+            start = Clock::now();
+            auto records = log.Range(*entry, first, last);
+            fprintf(stderr, "Query took %.3f ms (%zu records)\n",
+                    Milliseconds(Clock::now() - start), records.size());
+            for (const auto& ref : records)
+            {
+                PrintRecord(formatter, *entry, log.Get(ref));
+            }
+        }
+        else
+        {
+            return Usage();
+        }
+    }
+    catch (const exception& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
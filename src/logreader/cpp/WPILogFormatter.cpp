@@ -0,0 +1,401 @@
+#include "WPILogFormatter.h"
+
+#include <charconv>
+#include <cstring>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /** @brief Bytes in a WPILog or struct-schema primitive, or 0 */
+    size_t PrimitiveSize(string_view type)
+    {
+        if (type == "boolean" || type == "bool" || type == "char" ||
+            type == "int8" || type == "uint8")
+        {
+            return 1;
+        }
+        if (type == "int16" || type == "uint16")
+        {
+            return 2;
+        }
+        if (type == "float" || type == "float32" || type == "int32" ||
+            type == "uint32")
+        {
+            return 4;
+        }
+        if (type == "double" || type == "float64" || type == "int64" ||
+            type == "uint64")
+        {
+            return 8;
+        }
+        return 0;
+    }
+
+    uint32_t ReadU32(const uint8_t* data)
+    {
+        return static_cast<uint32_t>(data[0]) |
+               static_cast<uint32_t>(data[1]) << 8 |
+               static_cast<uint32_t>(data[2]) << 16 |
+               static_cast<uint32_t>(data[3]) << 24;
+    }
+
+    template <typename T>
+    void AppendNumber(const uint8_t* data, string& out)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        char text[32];
+        auto result = to_chars(text, text + sizeof(text), value);
+        out.append(text, result.ptr);
+    }
+
+    /** @brief Formats a primitive; the type must have a PrimitiveSize */
+    void AppendPrimitive(string_view type, const uint8_t* data, string& out)
+    {
+        if (type == "boolean" || type == "bool")
+        {
+            out += data[0] ? "true" : "false";
+        }
+        else if (type == "char")
+        {
+            out += static_cast<char>(data[0]);
+        }
+        else if (type == "int8")
+        {
+            AppendNumber<int8_t>(data, out);
+        }
+        else if (type == "uint8")
+        {
+            AppendNumber<uint8_t>(data, out);
+        }
+        else if (type == "int16")
+        {
+            AppendNumber<int16_t>(data, out);
+        }
+        else if (type == "uint16")
+        {
+            AppendNumber<uint16_t>(data, out);
+        }
+        else if (type == "int32")
+        {
+            AppendNumber<int32_t>(data, out);
+        }
+        else if (type == "uint32")
+        {
+            AppendNumber<uint32_t>(data, out);
+        }
+        else if (type == "int64")
+        {
+            AppendNumber<int64_t>(data, out);
+        }
+        else if (type == "uint64")
+        {
+            AppendNumber<uint64_t>(data, out);
+        }
+        else if (type == "float" || type == "float32")
+        {
+            AppendNumber<float>(data, out);
+        }
+        else
+        {
+            AppendNumber<double>(data, out);
+        }
+    }
+
+    void AppendHex(span<const uint8_t> payload, string& out)
+    {
+        constexpr size_t kMaxBytes = 64;
+        constexpr char kDigits[] = "0123456789abcdef";
+        out += "0x";
+        for (size_t i = 0; i < min(payload.size(), kMaxBytes); ++i)
+        {
+            out += kDigits[payload[i] >> 4];
+            out += kDigits[payload[i] & 0xf];
+        }
+        if (payload.size() > kMaxBytes)
+        {
+            out += "... (" + to_string(payload.size()) + " bytes)";
+        }
+    }
+
+    string_view Trim(string_view text)
+    {
+        size_t start = text.find_first_not_of(" \t\r\n");
+        if (start == string_view::npos)
+        {
+            return {};
+        }
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(start, end - start + 1);
+    }
+}  // namespace
+
+WPILogFormatter::WPILogFormatter(const WPILogIndex& log) : log(log)
+{
+}
+
+string WPILogFormatter::Format(const WPILogIndex::Entry& entry,
+                               span<const uint8_t> payload)
+{
+    string out;
+    string_view type = entry.type;
+
+    if (type.ends_with("[]"))
+    {
+        FormatArray(type.substr(0, type.size() - 2), payload, out);
+    }
+    else if (size_t size = PrimitiveSize(type); size > 0)
+    {
+        if (payload.size() == size)
+        {
+            AppendPrimitive(type, payload.data(), out);
+        }
+        else
+        {
+            AppendHex(payload, out);
+        }
+    }
+    else if (type == "string" || type == "json" || type == "structschema")
+    {
+        out.assign(reinterpret_cast<const char*>(payload.data()),
+                   payload.size());
+    }
+    else if (type.starts_with("struct:"))
+    {
+        const Schema* schema = GetSchema(type.substr(7));
+        if (schema && payload.size() == schema->size)
+        {
+            FormatStruct(*schema, payload.data(), out);
+        }
+        else
+        {
+            AppendHex(payload, out);
+        }
+    }
+    else
+    {
+        AppendHex(payload, out);
+    }
+    return out;
+}
+
+void WPILogFormatter::FormatArray(string_view type,
+                                  span<const uint8_t> payload, string& out)
+{
+    if (type == "string")
+    {
+        // Count, then length-prefixed strings
+        size_t start = out.size();
+        out += '[';
+        bool valid = payload.size() >= 4;
+        size_t count = valid ? ReadU32(payload.data()) : 0;
+        size_t position = 4;
+        for (size_t i = 0; valid && i < count; ++i)
+        {
+            valid = position + 4 <= payload.size();
+            if (!valid)
+            {
+                break;
+            }
+            size_t length = ReadU32(payload.data() + position);
+            position += 4;
+            valid = length <= payload.size() - position;
+            if (valid)
+            {
+                out += i ? ", \"" : "\"";
+                out.append(
+                    reinterpret_cast<const char*>(payload.data()) + position,
+                    length);
+                out += '"';
+                position += length;
+            }
+        }
+        if (!valid)
+        {
+            out.resize(start);
+            AppendHex(payload, out);
+            return;
+        }
+        out += ']';
+        return;
+    }
+
+    const Schema* schema = nullptr;
+    size_t elementSize = PrimitiveSize(type);
+    if (elementSize == 0 && type.starts_with("struct:"))
+    {
+        schema = GetSchema(type.substr(7));
+        elementSize = schema ? schema->size : 0;
+    }
+    if (elementSize == 0 || payload.size() % elementSize != 0)
+    {
+        AppendHex(payload, out);
+        return;
+    }
+
+    out += '[';
+    for (size_t offset = 0; offset < payload.size(); offset += elementSize)
+    {
+        if (offset > 0)
+        {
+            out += ", ";
+        }
+        if (schema)
+        {
+            FormatStruct(*schema, payload.data() + offset, out);
+        }
+        else
+        {
+            AppendPrimitive(type, payload.data() + offset, out);
+        }
+    }
+    out += ']';
+}
+
+void WPILogFormatter::FormatStruct(const Schema& schema, const uint8_t* data,
+                                   string& out)
+{
+    out += '{';
+    for (size_t i = 0; i < schema.fields.size(); ++i)
+    {
+        const Field& field = schema.fields[i];
+        if (i > 0)
+        {
+            out += ", ";
+        }
+        out += field.name;
+        out += ": ";
+
+        if (field.count > 1 && field.type == "char")
+        {
+            const char* text = reinterpret_cast<const char*>(data);
+            out += '"';
+            out.append(text, strnlen(text, field.count));
+            out += '"';
+        }
+        else
+        {
+            if (field.count > 1)
+            {
+                out += '[';
+            }
+            for (size_t n = 0; n < field.count; ++n)
+            {
+                if (n > 0)
+                {
+                    out += ", ";
+                }
+                const uint8_t* element = data + n * field.size;
+                if (field.nested)
+                {
+                    FormatStruct(*field.nested, element, out);
+                }
+                else
+                {
+                    AppendPrimitive(field.type, element, out);
+                }
+            }
+            if (field.count > 1)
+            {
+                out += ']';
+            }
+        }
+        data += field.count * field.size;
+    }
+    out += '}';
+}
+
+const WPILogFormatter::Schema* WPILogFormatter::GetSchema(
+    string_view structName)
+{
+    string name{structName};
+    if (auto it = schemas.find(name); it != schemas.end())
+    {
+        return it->second.get();
+    }
+
+    // Insert a placeholder first, so a schema that refers to itself fails
+    // instead of recursing forever. Map references survive the inserts that
+    // nested schemas make.
+    auto& slot = schemas[name];
+    const auto* entry = log.Find("/.schema/struct:" + name);
+    if (!entry || entry->records.empty())
+    {
+        return nullptr;
+    }
+    auto record = log.Get(entry->records.back());
+    slot = ParseSchema({reinterpret_cast<const char*>(record.payload.data()),
+                        record.payload.size()});
+    return slot.get();
+}
+
+unique_ptr<WPILogFormatter::Schema> WPILogFormatter::ParseSchema(
+    string_view text)
+{
+    // Declarations look like "double x", "int8 data[4]" or
+    // "enum {a=1, b=2} int8 mode", separated by ';'
+    auto schema = make_unique<Schema>();
+    while (!text.empty())
+    {
+        size_t end = min(text.find(';'), text.size());
+        string_view declaration = Trim(text.substr(0, end));
+        text.remove_prefix(min(end + 1, text.size()));
+        if (declaration.empty())
+        {
+            continue;
+        }
+
+        if (declaration.starts_with("enum"))
+        {
+            size_t close = declaration.find('}');
+            if (close == string_view::npos)
+            {
+                return nullptr;
+            }
+            declaration = Trim(declaration.substr(close + 1));
+        }
+        if (declaration.find(':') != string_view::npos)
+        {
+            return nullptr;  // Bit-fields aren't supported
+        }
+
+        size_t count = 1;
+        if (size_t open = declaration.find('['); open != string_view::npos)
+        {
+            string_view digits = Trim(declaration.substr(open + 1));
+            auto result =
+                from_chars(digits.data(), digits.data() + digits.size(),
+                           count);
+            const char* digitsEnd = digits.data() + digits.size();
+            if (result.ec != errc{} || result.ptr == digitsEnd ||
+                *result.ptr != ']' || count == 0)
+            {
+                return nullptr;
+            }
+            declaration = Trim(declaration.substr(0, open));
+        }
+
+        size_t space = declaration.find_first_of(" \t");
+        if (space == string_view::npos)
+        {
+            return nullptr;
+        }
+        Field field{string{Trim(declaration.substr(space))},
+                    string{declaration.substr(0, space)}, count, 0, nullptr};
+        field.size = PrimitiveSize(field.type);
+        if (field.size == 0)
+        {
+            field.nested = GetSchema(field.type);
+            if (!field.nested)
+            {
+                return nullptr;
+            }
+            field.size = field.nested->size;
+        }
+        schema->size += field.size * field.count;
+        schema->fields.push_back(move(field));
+    }
+    return schema;
+}
@@ -0,0 +1,271 @@
+#include "WPILogIndex.h"
+
+#include <wpi/fs.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    constexpr size_t kHeaderSize = 12;  // "WPILOG", version, extra length
+    constexpr uint16_t kVersion = 0x0100;
+
+    constexpr uint8_t kControlStart = 0;
+    constexpr uint8_t kControlFinish = 1;
+    constexpr uint8_t kControlSetMetadata = 2;
+
+    /** @brief Reads an n-byte little-endian unsigned integer */
+    uint64_t ReadLE(const uint8_t* data, size_t n)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Reads a length-prefixed string from a control record
+     *
+     * @return false if the record is too short
+     */
+    bool ReadString(span<const uint8_t>& payload, string_view& out)
+    {
+        if (payload.size() < 4)
+        {
+            return false;
+        }
+        size_t length = ReadLE(payload.data(), 4);
+        payload = payload.subspan(4);
+        if (payload.size() < length)
+        {
+            return false;
+        }
+        out = {reinterpret_cast<const char*>(payload.data()), length};
+        payload = payload.subspan(length);
+        return true;
+    }
+
+    bool ByTimestamp(const WPILogIndex::RecordRef& a,
+                     const WPILogIndex::RecordRef& b)
+    {
+        return a.timestamp < b.timestamp;
+    }
+}  // namespace
+
+WPILogIndex::WPILogIndex(const string& path)
+{
+    error_code ec;
+    uint64_t size = fs::file_size(path, ec);
+    if (ec)
+    {
+        throw runtime_error("Could not open log file: " + path + " (" +
+                            ec.message() + ")");
+    }
+    if (size < kHeaderSize)
+    {
+        throw runtime_error("Not a WPILog file: " + path);
+    }
+
+    fs::file_t file = fs::OpenFileForRead(path, ec);
+    if (ec)
+    {
+        throw runtime_error("Could not open log file: " + path + " (" +
+                            ec.message() + ")");
+    }
+    region = wpi::MappedFileRegion{file, size, 0,
+                                   wpi::MappedFileRegion::kReadOnly, ec};
+    // The mapping stays valid after the file is closed
+    fs::CloseFile(file);
+    if (ec)
+    {
+        throw runtime_error("Could not map log file: " + path + " (" +
+                            ec.message() + ")");
+    }
+
+    const uint8_t* data = region.const_data();
+    if (memcmp(data, "WPILOG", 6) != 0 || ReadLE(data + 6, 2) != kVersion)
+    {
+        throw runtime_error("Not a WPILog file (or unsupported version): " +
+                            path);
+    }
+    size_t extraLength = ReadLE(data + 8, 4);
+    if (kHeaderSize + extraLength > region.size())
+    {
+        throw runtime_error("Corrupt WPILog header: " + path);
+    }
+    extraHeader.assign(reinterpret_cast<const char*>(data + kHeaderSize),
+                       extraLength);
+
+    Build();
+}
+
+void WPILogIndex::Build()
+{
+    const uint8_t* data = region.const_data();
+    const size_t size = region.size();
+    size_t position = kHeaderSize + extraHeader.size();
+
+    while (position < size)
+    {
+        // Header byte: field widths minus one for the entry ID (bits 0-1),
+        // payload size (bits 2-3) and timestamp (bits 4-6)
+        const uint8_t lengths = data[position];
+        const size_t idLength = (lengths & 0x3) + 1;
+        const size_t sizeLength = ((lengths >> 2) & 0x3) + 1;
+        const size_t timestampLength = ((lengths >> 4) & 0x7) + 1;
+        const size_t headerLength =
+            1 + idLength + sizeLength + timestampLength;
+        if (position + headerLength > size)
+        {
+            break;  // Truncated
+        }
+
+        const uint8_t* field = data + position + 1;
+        const auto id = static_cast<uint32_t>(ReadLE(field, idLength));
+        field += idLength;
+        const size_t payloadSize = ReadLE(field, sizeLength);
+        field += sizeLength;
+        const auto timestamp =
+            static_cast<int64_t>(ReadLE(field, timestampLength));
+
+        const size_t payloadOffset = position + headerLength;
+        if (payloadSize > size - payloadOffset)
+        {
+            break;  // Truncated
+        }
+        position = payloadOffset + payloadSize;
+
+        if (id == 0)
+        {
+            Control({data + payloadOffset, payloadSize});
+            continue;
+        }
+        auto it = active.find(id);
+        if (it == active.end())
+        {
+            continue;  // Data for an entry that was never started
+        }
+        entries[it->second].records.push_back(
+            {timestamp, payloadOffset, static_cast<uint32_t>(payloadSize)});
+        ++recordCount;
+    }
+
+    // Writers may stamp records out of order (e.g. values logged with an
+    // explicit timestamp), but queries need them sorted
+    for (auto& entry : entries)
+    {
+        if (!is_sorted(entry.records.begin(), entry.records.end(),
+                       ByTimestamp))
+        {
+            stable_sort(entry.records.begin(), entry.records.end(),
+                        ByTimestamp);
+        }
+    }
+
+    active.clear();
+    byNameAndType.clear();
+}
+
+void WPILogIndex::Control(span<const uint8_t> payload)
+{
+    if (payload.size() < 5)
+    {
+        return;
+    }
+    const uint8_t type = payload[0];
+    const auto id = static_cast<uint32_t>(ReadLE(payload.data() + 1, 4));
+    payload = payload.subspan(5);
+
+    if (type == kControlStart)
+    {
+        string_view name;
+        string_view entryType;
+        string_view metadata;
+        if (!ReadString(payload, name) || !ReadString(payload, entryType) ||
+            !ReadString(payload, metadata))
+        {
+            return;
+        }
+
+        string key{name};
+        key += '\n';
+        key += entryType;
+        auto [it, inserted] = byNameAndType.try_emplace(key, entries.size());
+        if (inserted)
+        {
+            entries.push_back(
+                {string{name}, string{entryType}, string{metadata}, {}});
+        }
+        active[id] = it->second;
+    }
+    else if (type == kControlFinish)
+    {
+        active.erase(id);
+    }
+    else if (type == kControlSetMetadata)
+    {
+        string_view metadata;
+        auto it = active.find(id);
+        if (it != active.end() && ReadString(payload, metadata))
+        {
+            entries[it->second].metadata = metadata;
+        }
+    }
+}
+
+const WPILogIndex::Entry* WPILogIndex::Find(string_view name) const
+{
+    for (const auto& entry : entries)
+    {
+        if (entry.name == name)
+        {
+            return &entry;
+        }
+    }
+
+    const Entry* match = nullptr;
+    for (const auto& entry : entries)
+    {
+        string_view candidate = entry.name;
+        if (candidate.size() > name.size() && candidate.ends_with(name) &&
+            candidate[candidate.size() - name.size() - 1] == '/')
+        {
+            if (match && match->name != entry.name)
+            {
+                return nullptr;  // Ambiguous
+            }
+            match = match ? match : &entry;
+        }
+    }
+    return match;
+}
+
+optional<WPILogIndex::Record> WPILogIndex::ValueAt(const Entry& entry,
+                                                   int64_t timestamp) const
+{
+    auto it = upper_bound(entry.records.begin(), entry.records.end(),
+                          RecordRef{timestamp, 0, 0}, ByTimestamp);
+    if (it == entry.records.begin())
+    {
+        return nullopt;
+    }
+    return Get(*prev(it));
+}
+
+span<const WPILogIndex::RecordRef> WPILogIndex::Range(const Entry& entry,
+                                                      int64_t start,
+                                                      int64_t end) const
+{
+    auto first = lower_bound(entry.records.begin(), entry.records.end(),
+                             RecordRef{start, 0, 0}, ByTimestamp);
+    auto last = upper_bound(first, entry.records.end(),
+                            RecordRef{end, 0, 0}, ByTimestamp);
+    return {first, last};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "WPILogIndex.h"
+
+namespace nfr
+{
+    /**
+     * @brief Turns record payloads into readable text
+     *
+     * Handles every basic WPILog type and their arrays. Struct types
+     * ("struct:Pose2d") are decoded field by field using the schemas the
+     * writer stored under "/.schema/", e.g.
+     *
+     * ```
+     * {translation: {x: 1.25, y: 3.5}, rotation: {value: 0.5}}
+     * ```
+     *
+     * Anything that can't be decoded (unknown types, structs with bit-fields
+     * or without a schema) is printed as hex.
+     */
+    class WPILogFormatter
+    {
+    public:
+        explicit WPILogFormatter(const WPILogIndex& log);
+
+        /** @brief Formats one of an entry's payloads */
+        std::string Format(const WPILogIndex::Entry& entry,
+                           std::span<const std::uint8_t> payload);
+
+    private:
+        struct Schema;
+
+        struct Field
+        {
+            std::string name;
+            std::string type;
+            std::size_t count;      // 1 unless the field is an array
+            std::size_t size;       // Bytes per element
+            const Schema* nested;   // Set for struct-typed fields
+        };
+
+        struct Schema
+        {
+            std::vector<Field> fields;
+            std::size_t size = 0;
+        };
+
+        /** @brief Gets a struct's schema, or nullptr if it can't be decoded */
+        const Schema* GetSchema(std::string_view structName);
+        std::unique_ptr<Schema> ParseSchema(std::string_view text);
+
+        void FormatStruct(const Schema& schema, const std::uint8_t* data,
+                          std::string& out);
+        void FormatArray(std::string_view type,
+                         std::span<const std::uint8_t> payload,
+                         std::string& out);
+
+        const WPILogIndex& log;
+        // Parsed schemas by struct name; nullptr if it couldn't be parsed
+        std::unordered_map<std::string, std::unique_ptr<Schema>> schemas;
+    };
+}  // namespace nfr
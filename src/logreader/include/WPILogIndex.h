@@ -0,0 +1,147 @@
+#pragma once
+
+#include <wpi/MappedFileRegion.h>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace nfr
+{
+    /**
+     * @brief Memory-mapped .wpilog file with an index of every data record
+     *
+     * Opening a log maps it read-only and walks the record headers once,
+     * remembering where each entry's records are. Payloads are never copied:
+     * the OS pages in only the parts of the file a query touches, so even
+     * large logs open quickly and use little memory. The index itself costs
+     * 24 bytes per record.
+     *
+     * Queries binary search an entry's records by timestamp, so they take
+     * microseconds regardless of log size:
+     *
+     * ```cpp
+     * WPILogIndex log{"match.wpilog"};
+     * if (auto* pose = log.Find("robot/drive/pose"))
+     * {
+     *     auto record = log.ValueAt(*pose, 42'300'000);  // t = 42.3 s
+     * }
+     * ```
+     *
+     * Entries that are started more than once with the same name and type
+     * (e.g. after the entry ID was reused) share one Entry.
+     */
+    class WPILogIndex
+    {
+    public:
+        /** @brief Where one data record's payload lives in the file */
+        struct RecordRef
+        {
+            std::int64_t timestamp;  ///< Microseconds
+            std::uint64_t offset;    ///< File offset of the payload
+            std::uint32_t size;      ///< Payload size in bytes
+        };
+
+        /** @brief A data record handed back by a query */
+        struct Record
+        {
+            std::int64_t timestamp;  ///< Microseconds
+            std::span<const std::uint8_t> payload;  ///< Points into the map
+        };
+
+        struct Entry
+        {
+            std::string name;
+            std::string type;
+            std::string metadata;
+            std::vector<RecordRef> records;  ///< Sorted by timestamp
+        };
+
+        /**
+         * @brief Maps and indexes a log file
+         *
+         * A truncated final record (e.g. from a brownout) is ignored.
+         *
+         * @param path Path to the .wpilog file
+         * @throws std::runtime_error if the file can't be mapped or isn't a
+         *         WPILog file
+         */
+        explicit WPILogIndex(const std::string& path);
+
+        WPILogIndex(const WPILogIndex&) = delete;
+        WPILogIndex& operator=(const WPILogIndex&) = delete;
+
+        /**
+         * @brief Finds an entry by name
+         *
+         * Tries an exact match first, then a unique match on a trailing
+         * path, so "robot/drive/pose" also finds "NT:/logs/robot/drive/pose".
+         *
+         * @return The entry, or nullptr if there is no (unique) match
+         */
+        const Entry* Find(std::string_view name) const;
+
+        /** @brief Every entry, in the order they were started */
+        std::span<const Entry> Entries() const
+        {
+            return entries;
+        }
+
+        /** @brief Number of data records in the log */
+        std::size_t RecordCount() const
+        {
+            return recordCount;
+        }
+
+        /** @brief Free-form header text the log was written with */
+        std::string_view ExtraHeader() const
+        {
+            return extraHeader;
+        }
+
+        /**
+         * @brief Gets the value an entry had at a point in time
+         *
+         * @param timestamp Microseconds
+         * @return The last record at or before the timestamp, or nothing if
+         *         the entry had no value yet
+         */
+        std::optional<Record> ValueAt(const Entry& entry,
+                                      std::int64_t timestamp) const;
+
+        /**
+         * @brief Gets every record of an entry in [start, end]
+         *
+         * @param start First timestamp included, in microseconds
+         * @param end Last timestamp included, in microseconds
+         */
+        std::span<const RecordRef> Range(const Entry& entry,
+                                         std::int64_t start,
+                                         std::int64_t end) const;
+
+        /** @brief Resolves a record reference to its payload */
+        Record Get(const RecordRef& ref) const
+        {
+            return {ref.timestamp,
+                    {region.const_data() + ref.offset, ref.size}};
+        }
+
+    private:
+        void Build();
+        void Control(std::span<const std::uint8_t> payload);
+
+        wpi::MappedFileRegion region;
+        std::string extraHeader;
+        std::vector<Entry> entries;
+        std::size_t recordCount = 0;
+
+        // Entry ID -> index into entries, for the entries currently started
+        std::unordered_map<std::uint32_t, std::size_t> active;
+        // "name\ntype" -> index into entries
+        std::unordered_map<std::string, std::size_t> byNameAndType;
+    };
+}  // namespace nfr
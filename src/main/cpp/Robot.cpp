@@ -5,11 +5,17 @@
 #include "Robot.h"
 
 #include <frc/DriverStation.h>
+#include <frc/Preferences.h>
+#include <frc/RobotController.h>
+#include <frc/smartdashboard/SmartDashboard.h>
 #include <frc2/command/CommandScheduler.h>
 
+#include <exception>
 #include <iostream>
 
+#include "constants/Constants.h"
 #include "logging/Logger.h"
+#include "replay/LogReplay.h"
 #include "util/GitMetadataLoader.h"
 
 /**
@@ -27,20 +33,55 @@ bool isCompetition()
     return frc::DriverStation::IsFMSAttached();
 }
 
+/**
+ * @brief NT limits for the field network
+ *
+ * Keeps the dashboards alive, but within a fixed share of the field network,
+ * with the pose first in line.
+ */
+nfr::LogBandwidthBudget competitionNTBudget()
+{
+    nfr::LogBandwidthBudget budget;
+    budget.bytesPerSecond = nfr::LoggingConstants::kNTBytesPerSecond;
+    budget.rates =
+        nfr::LogRateRules::Parse(nfr::LoggingConstants::kNTRates).value();
+    budget.defaultRate = nfr::LoggingConstants::kNTDefaultRate;
+    return budget;
+}
+
 Robot::Robot()
 {
-    nfr::logger.EnableWPILogging();
-    if (!isCompetition())
-    {
-        nfr::logger.EnableNTLogging();
-        std::cout << "Running in non-competition mode. Enabling NT logging."
-                  << std::endl;
-    }
-    else
-    {
-        std::cout << "Running in competition mode. No NT logging enabled."
-                  << std::endl;
-    }
+    // Keep every value from the last few seconds in memory, so faults can be
+    // dumped in full detail while the regular log file gets every Nth value
+    nfr::logger.EnableFlightRecorder(
+        nfr::LoggingConstants::kFlightRecorderWindow,
+        nfr::LoggingConstants::kFlightRecorderCapacity,
+        nfr::LoggingConstants::kFlightRecorderExcludedKeys);
+    nfr::logger.EnableWPILogging(nfr::LoggingConstants::kWPILogDecimation);
+    frc::SmartDashboard::PutBoolean(
+        nfr::LoggingConstants::kFlightRecorderButton, false);
+    // Unlimited for practice; UpdateNTBudget() limits it once the FMS
+    // attaches, which is usually well after startup
+    nfr::logger.EnableNTLogging();
+
+    // Windowed summaries of the signals we read in the pits
+    nfr::logger.EnableStatistics(nfr::LoggingConstants::kStatisticsKeys,
+                                 nfr::LoggingConstants::kStatisticsWindow);
+
+    // Hand sink writes to a background thread so logging can't eat into the
+    // 20ms loop budget
+    nfr::logger.EnableAsyncLogging();
+
+    // Debug keys are off at competitions unless the preferences say
+    // otherwise
+    frc::Preferences::InitString(nfr::LoggingConstants::kLogLevelPreference,
+                                 "");
+    frc::Preferences::InitString(nfr::LoggingConstants::kLogRulesPreference,
+                                 "");
+    UpdateLogVerbosity();
+    // The program may also restart while the FMS is attached
+    UpdateNTBudget();
+    m_logSettingsTimer.Start();
 
     // Log information about which version of our code is running
     // This helps us know exactly what code was deployed to the robot
@@ -49,18 +90,133 @@ Robot::Robot()
 
 void Robot::RobotPeriodic()
 {
-    // Run the command scheduler - this manages all active commands
-    // Commands are like "drive forward", "shoot ball", etc.
-    // The scheduler makes sure they run properly and don't conflict
-    frc2::CommandScheduler::GetInstance().Run();
+    // Time the whole loop and each phase of it, so loop overruns can be
+    // traced to where the time went. Results are logged under "perf"; the
+    // loop and flush phases finish after logging, so they show up one cycle
+    // later.
+    nfr::ScopedTimer loopTimer{m_loopPhase};
+
+    // Everything logged this cycle shares one timestamp
+    nfr::logger.BeginFrame();
+
+    {
+        nfr::ScopedTimer timer{m_schedulerPhase};
+        // Run the command scheduler - this manages all active commands
+        // Commands are like "drive forward", "shoot ball", etc.
+        // The scheduler makes sure they run properly and don't conflict
+        try
+        {
+            frc2::CommandScheduler::GetInstance().Run();
+        }
+        catch (const std::exception& e)
+        {
+            // Save the seconds leading up to the crash before letting it take
+            // the robot program down
+            std::cerr << "Command scheduler threw: " << e.what() << std::endl;
+            nfr::logger.Flush();
+            nfr::logger.EndFrame();
+            if (auto* recorder = nfr::logger.GetSink<nfr::FlightRecorder>())
+            {
+                recorder->Trigger("exception");
+                recorder->Wait();
+            }
+            throw;
+        }
+    }
+
+    {
+        nfr::ScopedTimer timer{m_logPhase};
+        // Log current robot state for debugging and analysis
+        // This includes drivetrain position, sensor values, etc.
+        nfr::logger["robot"] << m_container;
+        nfr::logger["perf"] << m_loopTimer;
+        CheckFlightRecorderTriggers();
+        if (m_logSettingsTimer.AdvanceIfElapsed(
+                nfr::LoggingConstants::kLogSettingsPeriod))
+        {
+            UpdateLogVerbosity();
+            UpdateNTBudget();
+        }
+    }
+
+    {
+        nfr::ScopedTimer timer{m_flushPhase};
+        // Actually write all pending log data
+        // Logs are buffered for performance, this forces them to be written
+        nfr::logger.Flush();
+        nfr::logger.EndFrame();
+    }
+}
+
+void Robot::CheckFlightRecorderTriggers()
+{
+    auto* recorder = nfr::logger.GetSink<nfr::FlightRecorder>();
+    if (!recorder)
+    {
+        return;
+    }
+
+    // Dump once when the battery sags, not every cycle while it stays low
+    bool lowBattery = frc::RobotController::IsBrownedOut() ||
+                      frc::RobotController::GetBatteryVoltage() <
+                          nfr::LoggingConstants::kLowBatteryVoltage;
+    if (lowBattery && !m_lowBattery)
+    {
+        recorder->Trigger("low_battery");
+    }
+    m_lowBattery = lowBattery;
+
+    // Dashboard button for "that looked wrong, save it"
+    if (frc::SmartDashboard::GetBoolean(
+            nfr::LoggingConstants::kFlightRecorderButton, false))
+    {
+        recorder->Trigger("dashboard");
+        frc::SmartDashboard::PutBoolean(
+            nfr::LoggingConstants::kFlightRecorderButton, false);
+    }
+}
+
+void Robot::UpdateLogVerbosity()
+{
+    std::string level = frc::Preferences::GetString(
+        nfr::LoggingConstants::kLogLevelPreference);
+    auto parsed = nfr::ParseLogLevel(level);
+    if (level != m_logLevel)
+    {
+        m_logLevel = level;
+        if (!parsed && !level.empty())
+        {
+            std::cerr << "Unknown log level \"" << level << "\"" << std::endl;
+        }
+    }
+    // Re-evaluated every check: the FMS may connect after startup
+    nfr::logger.SetLogLevel(parsed.value_or(
+        isCompetition() ? nfr::LogLevel::kInfo : nfr::LogLevel::kDebug));
 
-    // Log current robot state for debugging and analysis
-    // This includes drivetrain position, sensor values, etc.
-    nfr::logger["robot"] << m_container;
+    std::string rules = frc::Preferences::GetString(
+        nfr::LoggingConstants::kLogRulesPreference);
+    if (rules != m_logRules)
+    {
+        m_logRules = rules;
+        if (!nfr::logger.SetLogLevelRules(rules))
+        {
+            std::cerr << "Malformed log level rules \"" << rules << "\""
+                      << std::endl;
+        }
+    }
+}
 
-    // Actually write all pending log data
-    // Logs are buffered for performance, this forces them to be written
-    nfr::logger.Flush();
+void Robot::UpdateNTBudget()
+{
+    if (m_ntBudgeted || !isCompetition())
+    {
+        return;
+    }
+    nfr::logger.SetNTBandwidthBudget(competitionNTBudget());
+    m_ntBudgeted = true;
+    std::cout << "Running in competition mode. NT logging is limited to "
+              << nfr::LoggingConstants::kNTBytesPerSecond
+              << " bytes per second." << std::endl;
 }
 
 void Robot::DisabledInit()
@@ -160,8 +316,16 @@ void Robot::TestExit()
 // This is the main entry point for our robot program
 // The RUNNING_FRC_TESTS check excludes this when running unit tests
 #ifndef RUNNING_FRC_TESTS
-int main()
+int main(int argc, char** argv)
 {
+    // `--replay <log>` feeds a recorded match back through the simulated
+    // robot instead of waiting for a driver station (see LogReplay.h)
+    if (nfr::IsReplayRequested(argc, argv))
+    {
+        auto options = nfr::ParseReplayOptions(argc, argv);
+        return options ? nfr::RunLogReplay(*options) : 1;
+    }
+
     // Start the robot with our Robot class
     // This hands control over to WPILib, which will create a Robot instance
     // and call its methods based on driver station input
@@ -5,15 +5,25 @@
 #include "RobotContainer.h"
 
 #include <frc/DriverStation.h>
+#include <frc/Filesystem.h>
+#include <frc/RobotBase.h>
+#include <frc/Timer.h>
+#include <frc/apriltag/AprilTagFieldLayout.h>
+#include <frc/apriltag/AprilTagFields.h>
 #include <frc2/command/Commands.h>
 #include <frc2/command/button/CommandXboxController.h>
 
+#include <exception>
+#include <iostream>
+
 #include "constants/Constants.h"
 #include "frc/MathUtil.h"
 #include "frc/Preferences.h"
 #include "frc/geometry/Pose3d.h"
 #include "frc/smartdashboard/SmartDashboard.h"
 #include "generated/TunerConstants.h"
+#include "pathfinding/NavGrid.h"
+#include "trajectory/TrajectoryImport.h"
 #include "units/base.h"
 
 using namespace std;
@@ -70,7 +80,7 @@ RobotContainer::RobotContainer()
     drive = std::make_unique<SwerveDrive>(
         TunerConstants::DrivetrainConstants, DriveConstants::kUpdateRate,
         DriveConstants::kOdometryStandardDeviation,
-        DriveConstants::kVisionStandardDeviation,
+        DriveConstants::kVisionStandardDeviation, VisionConstants::kFusion,
         DriveConstants::kTranslationPID, DriveConstants::kRotationPID,
         DriveConstants::kMaxTranslationSpeed, DriveConstants::kMaxRotationSpeed,
         TunerConstants::FrontLeft, TunerConstants::FrontRight,
@@ -79,8 +89,61 @@ RobotContainer::RobotContainer()
     // Load saved swerve module offsets from previous calibration
     drive->SetModuleOffsets(getModuleOffsets());
 
+    // Obstacles for driving to a pose; loaded before the bindings that use
+    // them
+    try
+    {
+        navGrid = nfr::NavGrid::Load(frc::filesystem::GetDeployDirectory() +
+                                     "/pathplanner/navgrid.json")
+                      .Inflated(PathfindingConstants::kClearance);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
     // Set up controller bindings and default commands
     ConfigureBindings();
+
+    if (frc::RobotBase::IsSimulation())
+    {
+        StartVisionSim();
+    }
+}
+
+void RobotContainer::StartVisionSim()
+{
+    // Every tag on this year's field, flattened onto the floor
+    auto layout =
+        frc::AprilTagFieldLayout::LoadField(frc::AprilTagField::kDefaultField);
+    std::vector<frc::Pose2d> tags;
+    for (const auto& tag : layout.GetTags())
+    {
+        tags.push_back(tag.pose.ToPose2d());
+    }
+    for (const auto& config : VisionConstants::kSimCameras)
+    {
+        simCameras.emplace_back(config, tags, config.id + 1);
+    }
+
+    // Frames reach the drivetrain from this thread and are fused on the
+    // robot thread at the next cycle
+    visionSimNotifier = std::make_unique<frc::Notifier>(
+        [this]
+        {
+            auto now = frc::Timer::GetFPGATimestamp();
+            // From where the robot really is, not the estimate vision is
+            // correcting, or the cameras would only confirm it
+            auto pose = drive->GetSimulatedPose();
+            for (auto& camera : simCameras)
+            {
+                if (auto observation = camera.Update(now, pose))
+                {
+                    drive->AddVisionObservation(*observation);
+                }
+            }
+        });
+    visionSimNotifier->StartPeriodic(VisionConstants::kSimCameraPeriod);
 }
 
 /**
@@ -140,6 +203,14 @@ void RobotContainer::ConfigureBindings()
     driverController.Back().OnTrue(
         drive->RunOnce([&]() { drive->SeedFieldCentric(); }));
 
+    // A button (held): drive to a set pose, finding a way around obstacles
+    if (navGrid)
+    {
+        driverController.A().WhileTrue(
+            drive->DriveToPose(*navGrid, PathfindingConstants::kTargetPose,
+                               PathfindingConstants::kConstraints));
+    }
+
     // Create a command to reset swerve module offsets and put it on
     // SmartDashboard This allows drivers/programmers to recalibrate swerve
     // modules from the dashboard
@@ -159,14 +230,18 @@ void RobotContainer::ConfigureBindings()
 
 frc2::CommandPtr RobotContainer::GetAutonomousCommand()
 {
-    // TODO: Replace this with an actual autonomous command
-    // For now, just print a message and do nothing
-    // Real autonomous commands might:
-    // - Drive to a specific position
-    // - Score game pieces
-    // - Follow a pre-planned path
-    // - Use vision to align with targets
-    return frc2::cmd::Print("No autonomous command configured");
+    // Loaded when autonomous first starts, rather than at boot; with its
+    // saved form deployed this only maps a file
+    if (!autoTrajectory)
+    {
+        autoTrajectory = LoadTrajectory(AutoConstants::kTrajectory);
+    }
+    if (!autoTrajectory || autoTrajectory->Empty())
+    {
+        return frc2::cmd::Print("No autonomous trajectory could be loaded");
+    }
+    // Planned from the blue side and starting where the trajectory does
+    return drive->FollowCachedTrajectory(*autoTrajectory, true);
 }
 
 void RobotContainer::Log(const nfr::LogContext& log) const
@@ -181,13 +256,21 @@ void RobotContainer::Log(const nfr::LogContext& log) const
 
     // AdvantageScope 3D robot visualization
     // Based on config.json components in advantageScopeAssets/Robot_Ralph/
-    LogRobotState(log["Robot3d"]);
+    // Debug only: when debug logging is off these poses aren't computed
+    NFR_LOG_DEBUG(log["Robot3d"]) << [this](const nfr::LogContext& robot3d)
+    { LogRobotState(robot3d); };
+}
+
+void RobotContainer::ResetPose(const frc::Pose2d& pose)
+{
+    drive->ResetPose(pose);
 }
 
 void RobotContainer::LogRobotState(const nfr::LogContext& log) const
 {
     // Get current robot pose for the base robot component
-    frc::Pose3d robotPose = frc::Pose3d(drive->GetState().Pose);
+    const auto& snapshot = drive->GetSnapshot();
+    frc::Pose3d robotPose = frc::Pose3d(snapshot.pose);
 
     // Main robot pose for AdvantageScope 3D visualization
     log["Robot"] << robotPose;
@@ -196,36 +279,44 @@ void RobotContainer::LogRobotState(const nfr::LogContext& log) const
     // This represents the main chassis/drivetrain
     log["component_0"] << robotPose;
 
+    // The rest is computed lazily: only when a sink will actually write it
+    // this cycle (not while WPILog is decimating it away, for example)
+
     // Component 1: Manipulator/Arm - positioned at front of robot
     // This would normally get actual position from manipulator subsystem
     // Using dummy values as manipulator subsystem doesn't exist yet
     // Position based on config.json zeroedPosition for component 1
-    frc::Pose3d manipulatorPose =
-        robotPose + frc::Transform3d(frc::Translation3d(0.27_m, 0.05_m, 0.53_m),
-                                     frc::Rotation3d(0_deg, 0_deg, 270_deg));
-    log["component_1"] << manipulatorPose;
+    log["component_1"] << [&]
+    {
+        return robotPose +
+               frc::Transform3d(frc::Translation3d(0.27_m, 0.05_m, 0.53_m),
+                                frc::Rotation3d(0_deg, 0_deg, 270_deg));
+    };
 
     // Component 2: Robot base frame - secondary base component
     // Position based on config.json zeroedPosition for component 2
-    frc::Pose3d basePose =
-        robotPose +
-        frc::Transform3d(frc::Translation3d(-1.52_m, -0.4_m, -0.02_m),
-                         frc::Rotation3d(0_deg, 0_deg, 90_deg));
-    log["component_2"] << basePose;
+    log["component_2"] << [&]
+    {
+        return robotPose +
+               frc::Transform3d(frc::Translation3d(-1.52_m, -0.4_m, -0.02_m),
+                                frc::Rotation3d(0_deg, 0_deg, 90_deg));
+    };
 
     // Component 3: Elevator - positioned above robot center
     // Using dummy values as elevator is not implemented yet
     // Position based on config.json zeroedPosition for component 3
-    double elevatorHeight = 0.30;  // Dummy elevator height in meters
-    frc::Pose3d elevatorPose =
-        robotPose +
-        frc::Transform3d(
-            frc::Translation3d(0.31_m, -0.07_m, units::meter_t(elevatorHeight)),
-            frc::Rotation3d(0_deg, 285_deg, 270_deg));
-    log["component_3"] << elevatorPose;
+    log["component_3"] << [&]
+    {
+        double elevatorHeight = 0.30;  // Dummy elevator height in meters
+        return robotPose +
+               frc::Transform3d(frc::Translation3d(
+                                    0.31_m, -0.07_m,
+                                    units::meter_t(elevatorHeight)),
+                                frc::Rotation3d(0_deg, 285_deg, 270_deg));
+    };
 
     // Additional robot state information for debugging
-    log["chassis_speeds"] << drive->GetState().Speeds;
-    log["field_relative_heading"]
-        << drive->GetState().Pose.Rotation().Degrees();
+    log["chassis_speeds"] << [&] { return snapshot.speeds; };
+    log["field_relative_heading"] << [&]
+    { return snapshot.pose.Rotation().Degrees(); };
 }
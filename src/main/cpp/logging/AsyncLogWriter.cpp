@@ -0,0 +1,78 @@
+#include <logging/AsyncLogWriter.h>
+
+#include <chrono>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /** @brief Longest the writer sleeps before draining on its own */
+    constexpr auto kDrainPeriod = chrono::milliseconds{10};
+}  // namespace
+
+AsyncLogWriter::AsyncLogWriter(size_t capacity, void* target,
+                               LogStaging* staging)
+    : ring(capacity),
+      target(target),
+      staging(staging),
+      thread([this] { Run(); })
+{
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    running.store(false, memory_order_release);
+    Wake();
+    thread.join();
+}
+
+void AsyncLogWriter::Wake()
+{
+    if (!wakeRequested.exchange(true, memory_order_acq_rel))
+    {
+        wakeup.notify_one();
+    }
+}
+
+AsyncLogStats AsyncLogWriter::GetStats() const
+{
+    AsyncLogStats stats;
+    stats.queued = queued.load(memory_order_relaxed);
+    stats.dropped = dropped.load(memory_order_relaxed);
+    stats.written = written.load(memory_order_relaxed);
+    stats.peakUsage = peakUsage.load(memory_order_relaxed);
+    stats.capacity = ring.Capacity();
+    return stats;
+}
+
+void AsyncLogWriter::Run()
+{
+    while (running.load(memory_order_acquire))
+    {
+        {
+            unique_lock lock{mutex};
+            wakeup.wait_for(lock, kDrainPeriod,
+                            [this]
+                            {
+                                return wakeRequested.load(
+                                    memory_order_acquire);
+                            });
+        }
+        wakeRequested.store(false, memory_order_release);
+        Drain();
+    }
+
+    // Final drain so nothing queued before shutdown is lost
+    Drain();
+}
+
+void AsyncLogWriter::Drain()
+{
+    written.fetch_add(ring.Drain(target), memory_order_relaxed);
+    if (staging)
+    {
+        // Counted by the staging area itself
+        staging->Drain(target);
+    }
+}
@@ -0,0 +1,342 @@
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <frc/DataLogManager.h>
+#include <logging/FlightRecorder.h>
+#include <logging/LogBuffers.h>
+#include <wpi/DataLogWriter.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /**
+     * @brief How long a dump waits after its trigger before copying the
+     *        arena, so values still queued by the async writer make it in
+     */
+    constexpr auto kSettleTime = chrono::milliseconds{100};
+
+    /** @brief Keeps a reason usable as part of a file name */
+    string FileSafe(string_view reason)
+    {
+        string result;
+        for (char c : reason.substr(0, 32))
+        {
+            bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                        (c >= '0' && c <= '9') || c == '-' || c == '_';
+            result += safe ? c : '_';
+        }
+        return result;
+    }
+
+    string_view Trim(string_view text)
+    {
+        constexpr string_view kSpace = " \t\r\n/";
+        auto first = text.find_first_not_of(kSpace);
+        if (first == string_view::npos)
+        {
+            return {};
+        }
+        auto last = text.find_last_not_of(kSpace);
+        return text.substr(first, last - first + 1);
+    }
+
+    /** @brief Whether a key path is a prefix or under it (whole segments) */
+    bool Covers(string_view prefix, string_view path)
+    {
+        return path.starts_with(prefix) &&
+               (path.size() == prefix.size() || path[prefix.size()] == '/');
+    }
+}  // namespace
+
+FlightRecorder::FlightRecorder(const LogKeyRegistry& keys,
+                               chrono::milliseconds window, size_t capacity,
+                               string_view excludedPrefixList,
+                               string directory)
+    : keys(keys),
+      window(window),
+      directory(directory.empty() ? frc::DataLogManager::GetLogDir()
+                                  : std::move(directory)),
+      matches(make_unique<atomic<Match>[]>(LogKeyRegistry::Capacity()))
+{
+    while (!excludedPrefixList.empty())
+    {
+        auto comma = excludedPrefixList.find(',');
+        string_view prefix = Trim(excludedPrefixList.substr(0, comma));
+        excludedPrefixList = comma == string_view::npos
+                                 ? string_view{}
+                                 : excludedPrefixList.substr(comma + 1);
+        if (!prefix.empty())
+        {
+            excludedPrefixes.emplace_back(prefix);
+        }
+    }
+
+    capacity = bit_ceil(max(capacity, size_t{64 * 1024}));
+    mask = capacity - 1;
+    // Allocated (and zeroed) up front so recording never allocates
+    arena = make_unique<Header[]>(capacity / sizeof(Header));
+    snapshot = make_unique<Header[]>(capacity / sizeof(Header));
+    thread = std::thread{[this] { Run(); }};
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    {
+        scoped_lock lock{triggerMutex};
+        running = false;
+    }
+    triggered.notify_one();
+    thread.join();
+}
+
+bool FlightRecorder::Trigger(string_view reason)
+{
+    {
+        scoped_lock lock{triggerMutex};
+        if (!pendingReason.empty() || !running)
+        {
+            return false;
+        }
+        pendingReason = reason.empty() ? "manual" : reason;
+    }
+    triggered.notify_one();
+    return true;
+}
+
+void FlightRecorder::Wait()
+{
+    unique_lock lock{triggerMutex};
+    finished.wait(lock, [this] { return pendingReason.empty(); });
+}
+
+bool FlightRecorder::Excluded(LogKey key) const
+{
+    if (excludedPrefixes.empty())
+    {
+        return false;
+    }
+    auto& match = matches[key];
+    Match known = match.load(memory_order_relaxed);
+    if (known == kUnknown)
+    {
+        // Racing threads all come to the same answer, so storing it twice
+        // is harmless
+        string_view path = keys.Path(key);
+        known = kRecorded;
+        for (const auto& prefix : excludedPrefixes)
+        {
+            if (Covers(prefix, path))
+            {
+                known = kExcluded;
+                break;
+            }
+        }
+        match.store(known, memory_order_relaxed);
+    }
+    return known == kExcluded;
+}
+
+void FlightRecorder::ThrowMismatch(LogKey key, string_view expected,
+                                   string_view actual) const
+{
+    throw runtime_error("Log entry type mismatch for key: " +
+                        string(keys.Path(key)) + ". Expected " +
+                        string(expected) + ", got " + string(actual) + ".");
+}
+
+span<byte> FlightRecorder::Reserve(LogKey key, int64_t timestamp,
+                                   size_t payloadSize)
+{
+    const size_t capacity = mask + 1;
+    const size_t recordSize = RecordSize(payloadSize);
+    if (recordSize > capacity / 4)
+    {
+        return {};
+    }
+
+    // Records never wrap: pad out the end of the arena if needed
+    const size_t untilEnd = capacity - (head & mask);
+    const size_t padding = untilEnd < recordSize ? untilEnd : 0;
+    while (head + padding + recordSize - tail > capacity)
+    {
+        tail += RecordSize(HeaderAt(tail)->size);  // Overwrite the oldest
+    }
+
+    if (padding > 0)
+    {
+        *HeaderAt(head) = {kPadding, 0,
+                           static_cast<uint32_t>(padding - sizeof(Header))};
+        head += padding;
+    }
+    Header* header = HeaderAt(head);
+    *header = {timestamp, key, static_cast<uint32_t>(payloadSize)};
+    head += recordSize;
+    return {reinterpret_cast<byte*>(header + 1), payloadSize};
+}
+
+void FlightRecorder::Run()
+{
+    unique_lock lock{triggerMutex};
+    while (true)
+    {
+        triggered.wait(lock,
+                       [this] { return !pendingReason.empty() || !running; });
+        if (pendingReason.empty())
+        {
+            return;  // Shutting down
+        }
+
+        string reason = pendingReason;
+        lock.unlock();
+        this_thread::sleep_for(kSettleTime);
+        WriteDump(reason);
+        lock.lock();
+
+        pendingReason.clear();
+        finished.notify_all();
+    }
+}
+
+void FlightRecorder::WriteDump(const string& reason)
+{
+    // Copy the arena out so recording only waits for a memcpy
+    size_t used;
+    {
+        scoped_lock lock{arenaMutex};
+        const size_t capacity = mask + 1;
+        const size_t start = tail & mask;
+        used = head - tail;
+        const size_t first = min(used, capacity - start);
+        auto* arenaBytes = reinterpret_cast<const byte*>(arena.get());
+        auto* snapshotBytes = reinterpret_cast<byte*>(snapshot.get());
+        memcpy(snapshotBytes, arenaBytes + start, first);
+        memcpy(snapshotBytes + first, arenaBytes, used - first);
+        snapshotChannels = channels;
+    }
+
+    auto* begin = reinterpret_cast<byte*>(snapshot.get());
+    auto* end = begin + used;
+    auto next = [](byte* record)
+    { return record + RecordSize(reinterpret_cast<Header*>(record)->size); };
+
+    // Only the last `window` before the newest value is written
+    int64_t newest = 0;
+    for (byte* record = begin; record < end; record = next(record))
+    {
+        newest = max(newest, reinterpret_cast<Header*>(record)->timestamp);
+    }
+    const int64_t cutoff =
+        newest - chrono::duration_cast<chrono::microseconds>(window).count();
+
+    ++dumpCount;
+    string path = fmt::format(
+        "{}/flight_{:%Y%m%d_%H%M%S}_{}_{}.wpilog", directory,
+        chrono::floor<chrono::seconds>(chrono::system_clock::now()),
+        dumpCount, FileSafe(reason));
+    error_code ec;
+    wpi::log::DataLogWriter log{path, ec, "flight recorder: " + reason};
+    if (ec)
+    {
+        cerr << "Flight recorder could not write " << path << ": "
+             << ec.message() << endl;
+        return;
+    }
+
+    int reasonEntry = log.Start("flightRecorder/reason", "string", {}, newest);
+    log.AppendString(reasonEntry, reason, newest);
+
+    // WPILog entry IDs start at 1, so 0 marks keys not started yet
+    vector<int> entries(snapshotChannels.size(), 0);
+    for (byte* record = begin; record < end; record = next(record))
+    {
+        auto* header = reinterpret_cast<Header*>(record);
+        if (header->timestamp == kPadding || header->timestamp < cutoff)
+        {
+            continue;
+        }
+
+        const Channel& channel = snapshotChannels[header->key];
+        int& entry = entries[header->key];
+        if (entry == 0)
+        {
+            if (channel.addSchema)
+            {
+                channel.addSchema(log);
+            }
+            entry = log.Start(keys.Path(header->key), channel.type, {},
+                              header->timestamp);
+        }
+        channel.dump(log, entry,
+                     {record + sizeof(Header), header->size},
+                     header->timestamp);
+    }
+    log.Flush();
+    cout << "Flight recorder wrote " << path << endl;
+}
+
+void FlightRecorder::DumpRaw(wpi::log::DataLog& log, int entry,
+                             span<byte> payload, int64_t timestamp)
+{
+    log.AppendRaw(entry,
+                  {reinterpret_cast<const uint8_t*>(payload.data()),
+                   payload.size()},
+                  timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry, double value,
+                            int64_t timestamp)
+{
+    log.AppendDouble(entry, value, timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry, long value,
+                            int64_t timestamp)
+{
+    log.AppendInteger(entry, value, timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry, bool value,
+                            int64_t timestamp)
+{
+    log.AppendBoolean(entry, value, timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry,
+                            string_view value, int64_t timestamp)
+{
+    log.AppendString(entry, value, timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry,
+                            span<double> values, int64_t timestamp)
+{
+    log.AppendDoubleArray(entry, values, timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry,
+                            span<long> values, int64_t timestamp)
+{
+    // Dump thread only
+    thread_local vector<int64_t> buffer;
+    log.AppendIntegerArray(entry, AsInt64(buffer, values), timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry,
+                            span<bool> values, int64_t timestamp)
+{
+    log.AppendBooleanArray(entry, values, timestamp);
+}
+
+void FlightRecorder::Append(wpi::log::DataLog& log, int entry,
+                            span<string_view> values, int64_t timestamp)
+{
+    log.AppendStringArray(entry, values, timestamp);
+}
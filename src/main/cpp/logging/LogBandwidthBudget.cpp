@@ -0,0 +1,235 @@
+#include "logging/LogBandwidthBudget.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    string_view Trim(string_view text)
+    {
+        constexpr string_view kSpace = " \t\r\n";
+        auto first = text.find_first_not_of(kSpace);
+        if (first == string_view::npos)
+        {
+            return {};
+        }
+        auto last = text.find_last_not_of(kSpace);
+        return text.substr(first, last - first + 1);
+    }
+
+    /** @brief Parses `rate` or `rate@priority` */
+    optional<LogRate> ParseLogRate(string_view text)
+    {
+        LogRate rate;
+        auto at = text.find('@');
+        if (at != string_view::npos)
+        {
+            string_view priority = Trim(text.substr(at + 1));
+            unsigned value = 0;
+            auto [end, error] = from_chars(
+                priority.data(), priority.data() + priority.size(), value);
+            if (error != errc{} || end != priority.data() + priority.size() ||
+                value >= LogRate::kPriorities)
+            {
+                return nullopt;
+            }
+            rate.priority = static_cast<uint8_t>(value);
+            text = text.substr(0, at);
+        }
+
+        text = Trim(text);
+        if (text == "once")
+        {
+            rate.once = true;
+            return rate;
+        }
+        if (text == "max")
+        {
+            return rate;
+        }
+        auto [end, error] =
+            from_chars(text.data(), text.data() + text.size(), rate.hz);
+        if (text.empty() || error != errc{} ||
+            end != text.data() + text.size() || !(rate.hz > 0) ||
+            !isfinite(rate.hz))
+        {
+            return nullopt;
+        }
+        return rate;
+    }
+}  // namespace
+
+optional<LogRateRules> LogRateRules::Parse(string_view spec)
+{
+    LogRateRules parsed;
+    while (!spec.empty())
+    {
+        auto comma = spec.find(',');
+        string_view rule = Trim(spec.substr(0, comma));
+        spec = comma == string_view::npos ? string_view{}
+                                          : spec.substr(comma + 1);
+        if (rule.empty())
+        {
+            continue;
+        }
+
+        auto equals = rule.find('=');
+        if (equals == string_view::npos)
+        {
+            return nullopt;
+        }
+        string_view prefix = Trim(rule.substr(0, equals));
+        // Keys never start or end with a separator
+        while (prefix.starts_with('/'))
+        {
+            prefix.remove_prefix(1);
+        }
+        while (prefix.ends_with('/'))
+        {
+            prefix.remove_suffix(1);
+        }
+        auto rate = ParseLogRate(rule.substr(equals + 1));
+        if (prefix.empty() || !rate)
+        {
+            return nullopt;
+        }
+        parsed.rules.emplace_back(string{prefix}, *rate);
+    }
+
+    stable_sort(parsed.rules.begin(), parsed.rules.end(),
+                [](const auto& a, const auto& b)
+                { return a.first.size() > b.first.size(); });
+    return parsed;
+}
+
+optional<LogRate> LogRateRules::Find(string_view path) const
+{
+    for (const auto& [prefix, rate] : rules)
+    {
+        // Whole segments only, as with LogLevelRules
+        if (path.starts_with(prefix) &&
+            (path.size() == prefix.size() || path[prefix.size()] == '/'))
+        {
+            return rate;
+        }
+    }
+    return nullopt;
+}
+
+LogBandwidthLimiter::LogBandwidthLimiter(const LogKeyRegistry& keys,
+                                         LogBandwidthBudget budget)
+    : keys(keys),
+      earliest(make_unique<atomic<int64_t>[]>(LogKeyRegistry::Capacity()))
+{
+    SetBudget(std::move(budget));
+}
+
+void LogBandwidthLimiter::SetBudget(LogBandwidthBudget newBudget)
+{
+    if (newBudget.bytesPerSecond < 0)
+    {
+        throw invalid_argument("NT bandwidth budget can't be negative");
+    }
+    budget = std::move(newBudget);
+    capacity = budget.bytesPerSecond * kBurst;
+    tokens = capacity;
+    for (LogKey key = 0; key < states.size(); ++key)
+    {
+        states[key].resolved = false;
+        earliest[key].store(0, memory_order_relaxed);
+    }
+}
+
+LogBandwidthLimiter::KeyState& LogBandwidthLimiter::GetState(LogKey key)
+{
+    if (key >= states.size())
+    {
+        states.resize(key + 1);
+    }
+    auto& state = states[key];
+    if (!state.resolved)
+    {
+        state.rate =
+            budget.rates.Find(keys.Path(key)).value_or(budget.defaultRate);
+        state.resolved = true;
+    }
+    return state;
+}
+
+bool LogBandwidthLimiter::Admit(LogKey key, size_t bytes, int64_t timestamp)
+{
+    auto& state = GetState(key);
+    const LogRate& rate = state.rate;
+
+    if (rate.once && state.sent)
+    {
+        rateLimited.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    int64_t period = 0;
+    if (rate.hz > 0)
+    {
+        period = static_cast<int64_t>(1e6 / rate.hz);
+        // Half a period of slack absorbs loop jitter; `next` still moves a
+        // whole period per update, so the average rate holds
+        if (state.sent && timestamp < state.next - period / 2)
+        {
+            rateLimited.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+    }
+
+    if (budget.bytesPerSecond > 0)
+    {
+        if (timestamp > refilled)
+        {
+            tokens = min(capacity,
+                         tokens + static_cast<double>(timestamp - refilled) *
+                                      1e-6 * budget.bytesPerSecond);
+            refilled = timestamp;
+        }
+        double reserve = capacity * rate.priority / LogRate::kPriorities;
+        // Values bigger than the whole bucket wait for it to fill and then
+        // go into debt, so they can still get out eventually
+        double cost = min(static_cast<double>(bytes), capacity - reserve);
+        // Priority 0 is never held back, since events and one-shot values
+        // may not be logged again. It can put the bucket into debt, which
+        // the other priorities then wait out.
+        if (rate.priority > 0 && tokens - reserve < cost)
+        {
+            deferred.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        tokens -= static_cast<double>(bytes);
+    }
+
+    if (rate.once)
+    {
+        earliest[key].store(numeric_limits<int64_t>::max(),
+                            memory_order_relaxed);
+    }
+    else if (period > 0)
+    {
+        // Don't bank updates for a key that has been quiet for a while
+        state.next = max(state.next + period, timestamp + period);
+        earliest[key].store(state.next - period / 2, memory_order_relaxed);
+    }
+    state.sent = true;
+    sent.fetch_add(1, memory_order_relaxed);
+    sentBytes.fetch_add(bytes, memory_order_relaxed);
+    return true;
+}
+
+LogBandwidthStats LogBandwidthLimiter::GetStats() const
+{
+    return {sent.load(memory_order_relaxed),
+            sentBytes.load(memory_order_relaxed),
+            deferred.load(memory_order_relaxed),
+            rateLimited.load(memory_order_relaxed)};
+}
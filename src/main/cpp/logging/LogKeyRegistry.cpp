@@ -0,0 +1,144 @@
+#include <logging/LogKeyRegistry.h>
+
+#include <stdexcept>
+#include <utility>
+
+using namespace nfr;
+using namespace std;
+
+LogKeyRegistry::LogKeyRegistry()
+{
+    // Handle 0 is the root: an empty path with no name
+    chunks[0] = make_unique<Node[]>(kChunkSize);
+    size.store(1, memory_order_release);
+}
+
+LogKey LogKeyRegistry::Child(LogKey parent, string_view name)
+{
+    LogKey key = parent;
+    while (!name.empty())
+    {
+        size_t separator = name.find('/');
+        string_view segment = name.substr(0, separator);
+        if (!segment.empty())
+        {
+            key = ChildSegment(key, segment);
+        }
+        if (separator == string_view::npos)
+        {
+            break;
+        }
+        name.remove_prefix(separator + 1);
+    }
+    return key;
+}
+
+span<const LogKey> LogKeyRegistry::Children(
+    LogKey parent, span<const string_view> names)
+{
+    auto find = [&]() -> const ChildTable*
+    {
+        for (const ChildTable* table =
+                 childTables.load(memory_order_acquire);
+             table; table = table->next)
+        {
+            if (table->parent == parent && table->names == names.data())
+            {
+                return table;
+            }
+        }
+        return nullptr;
+    };
+    if (const ChildTable* table = find())
+    {
+        return table->keys;
+    }
+
+    // Resolved outside the lock, since Child() takes it for new keys
+    vector<LogKey> keys;
+    keys.reserve(names.size());
+    for (string_view name : names)
+    {
+        keys.push_back(Child(parent, name));
+    }
+
+    scoped_lock lock{mutex};
+    // Another thread may have added the same table while this one resolved
+    if (const ChildTable* table = find())
+    {
+        return table->keys;
+    }
+    const ChildTable& table = childTableStorage.emplace_back(
+        ChildTable{parent, names.data(), std::move(keys),
+                   childTables.load(memory_order_relaxed)});
+    childTables.store(&table, memory_order_release);
+    return table.keys;
+}
+
+LogKey LogKeyRegistry::ChildSegment(LogKey parent, string_view name)
+{
+    if (LogKey child = FindChild(parent, name); child != kRootLogKey)
+    {
+        return child;
+    }
+
+    scoped_lock lock{mutex};
+    // Another thread may have created it while this one waited for the lock
+    if (LogKey child = FindChild(parent, name); child != kRootLogKey)
+    {
+        return child;
+    }
+    return Create(parent, name);
+}
+
+LogKey LogKeyRegistry::FindChild(LogKey parent, string_view name) const
+{
+    // Linear scan: nodes have only a handful of children, and comparing short
+    // names is cheaper than hashing them
+    for (LogKey child = Get(parent).firstChild.load(memory_order_acquire);
+         child != kRootLogKey; child = Get(child).nextSibling)
+    {
+        if (Get(child).Name() == name)
+        {
+            return child;
+        }
+    }
+    return kRootLogKey;
+}
+
+LogKey LogKeyRegistry::Create(LogKey parent, string_view name)
+{
+    const size_t count = size.load(memory_order_relaxed);
+    if (count >= kChunkSize * kMaxChunks)
+    {
+        throw runtime_error("Too many log keys, could not intern: " +
+                            string(name));
+    }
+
+    LogKey key = static_cast<LogKey>(count);
+    auto& chunk = chunks[key >> kChunkBits];
+    if (!chunk)
+    {
+        chunk = make_unique<Node[]>(kChunkSize);
+    }
+
+    Node& node = chunk[key & (kChunkSize - 1)];
+    string_view parentPath = Get(parent).path;
+    if (parentPath.empty())
+    {
+        node.path = name;
+    }
+    else
+    {
+        node.path.reserve(parentPath.size() + 1 + name.size());
+        node.path.append(parentPath).append("/").append(name);
+    }
+    node.nameOffset = node.path.size() - name.size();
+
+    // Publishing the node last lets other threads read it without the lock
+    Node& parentNode = Get(parent);
+    node.nextSibling = parentNode.firstChild.load(memory_order_relaxed);
+    parentNode.firstChild.store(key, memory_order_release);
+    size.store(count + 1, memory_order_release);
+    return key;
+}
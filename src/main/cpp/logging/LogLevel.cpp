@@ -0,0 +1,101 @@
+#include "logging/LogLevel.h"
+
+#include <algorithm>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    string_view Trim(string_view text)
+    {
+        constexpr string_view kSpace = " \t\r\n";
+        auto first = text.find_first_not_of(kSpace);
+        if (first == string_view::npos)
+        {
+            return {};
+        }
+        auto last = text.find_last_not_of(kSpace);
+        return text.substr(first, last - first + 1);
+    }
+}  // namespace
+
+optional<LogLevel> nfr::ParseLogLevel(string_view name)
+{
+    name = Trim(name);
+    if (name == "debug")
+    {
+        return LogLevel::kDebug;
+    }
+    if (name == "info")
+    {
+        return LogLevel::kInfo;
+    }
+    if (name == "critical")
+    {
+        return LogLevel::kCritical;
+    }
+    if (name == "off")
+    {
+        return LogLevel::kOff;
+    }
+    return nullopt;
+}
+
+optional<LogLevelRules> LogLevelRules::Parse(string_view spec)
+{
+    LogLevelRules parsed;
+    while (!spec.empty())
+    {
+        auto comma = spec.find(',');
+        string_view rule = Trim(spec.substr(0, comma));
+        spec = comma == string_view::npos ? string_view{}
+                                          : spec.substr(comma + 1);
+        if (rule.empty())
+        {
+            continue;
+        }
+
+        auto equals = rule.find('=');
+        if (equals == string_view::npos)
+        {
+            return nullopt;
+        }
+        string_view prefix = Trim(rule.substr(0, equals));
+        // Keys never start or end with a separator
+        while (prefix.starts_with('/'))
+        {
+            prefix.remove_prefix(1);
+        }
+        while (prefix.ends_with('/'))
+        {
+            prefix.remove_suffix(1);
+        }
+        auto level = ParseLogLevel(rule.substr(equals + 1));
+        if (prefix.empty() || !level)
+        {
+            return nullopt;
+        }
+        parsed.rules.emplace_back(string{prefix}, *level);
+    }
+
+    stable_sort(parsed.rules.begin(), parsed.rules.end(),
+                [](const auto& a, const auto& b)
+                { return a.first.size() > b.first.size(); });
+    return parsed;
+}
+
+optional<LogLevel> LogLevelRules::Find(string_view path) const
+{
+    for (const auto& [prefix, level] : rules)
+    {
+        // Whole segments only: "robot/drive" covers "robot/drive/pose" but
+        // not "robot/drivetrain"
+        if (path.starts_with(prefix) &&
+            (path.size() == prefix.size() || path[prefix.size()] == '/'))
+        {
+            return level;
+        }
+    }
+    return nullopt;
+}
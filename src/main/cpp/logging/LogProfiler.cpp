@@ -0,0 +1,61 @@
+#include <logging/LogProfiler.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace nfr;
+using namespace std;
+
+LogProfiler::LogProfiler(vector<string_view> sinkNames, size_t topCount,
+                         chrono::nanoseconds period)
+    : sinkNames(std::move(sinkNames)),
+      topCount(topCount),
+      period(period),
+      periodStart(chrono::steady_clock::now())
+{
+}
+
+void LogProfiler::Record(LogKey key, size_t sink, size_t bytes,
+                         chrono::nanoseconds elapsed)
+{
+    size_t index = key * sinkNames.size() + sink;
+    scoped_lock lock{mutex};
+    if (index >= costs.size())
+    {
+        costs.resize(index + 1);
+    }
+    Cost& cost = costs[index];
+    cost.calls++;
+    cost.bytes += bytes;
+    cost.nanoseconds += elapsed.count();
+}
+
+bool LogProfiler::TakeReport(vector<Row>& rows, chrono::nanoseconds& elapsed)
+{
+    auto now = chrono::steady_clock::now();
+    scoped_lock lock{mutex};
+    if (now - periodStart < period)
+    {
+        return false;
+    }
+    elapsed = now - periodStart;
+    periodStart = now;
+
+    rows.clear();
+    for (size_t index = 0; index < costs.size(); ++index)
+    {
+        if (costs[index].calls > 0)
+        {
+            rows.push_back(Row{static_cast<LogKey>(index / sinkNames.size()),
+                               index % sinkNames.size(), costs[index]});
+        }
+    }
+    fill(costs.begin(), costs.end(), Cost{});
+
+    size_t count = min(topCount, rows.size());
+    partial_sort(rows.begin(), rows.begin() + count, rows.end(),
+                 [](const Row& a, const Row& b)
+                 { return a.cost.nanoseconds > b.cost.nanoseconds; });
+    rows.resize(count);
+    return true;
+}
@@ -0,0 +1,88 @@
+#include <logging/LogRingBuffer.h>
+
+#include <bit>
+#include <new>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    constexpr size_t AlignRecord(size_t size)
+    {
+        return (size + kLogRecordAlignment - 1) & ~(kLogRecordAlignment - 1);
+    }
+}  // namespace
+
+LogRingBuffer::LogRingBuffer(size_t capacity)
+{
+    capacity = bit_ceil(max(capacity, size_t{4096}));
+    buffer = make_unique<Block[]>(capacity / sizeof(Block));
+    mask = capacity - 1;
+}
+
+span<byte> LogRingBuffer::TryReserve(LogKey key, LogReplayFn replay,
+                                     size_t payloadSize)
+{
+    const size_t recordSize =
+        AlignRecord(sizeof(LogRecordHeader) + payloadSize);
+    const size_t capacity = Capacity();
+    if (recordSize > capacity / 2)
+    {
+        return {};  // Would never fit alongside anything else
+    }
+
+    // Records never wrap: pad out the end of the buffer if needed. Every
+    // record is a multiple of the header alignment, so the remaining space
+    // always has room for a padding header.
+    const size_t untilEnd = capacity - (reserveHead & mask);
+    const size_t padding = untilEnd < recordSize ? untilEnd : 0;
+    const uint64_t needed = padding + recordSize;
+
+    if (reserveHead + needed - cachedTail > capacity)
+    {
+        cachedTail = tail.load(memory_order_acquire);
+        if (reserveHead + needed - cachedTail > capacity)
+        {
+            return {};
+        }
+    }
+
+    if (padding > 0)
+    {
+        auto paddingSize =
+            static_cast<uint32_t>(padding - sizeof(LogRecordHeader));
+        new (At(reserveHead)) LogRecordHeader{paddingSize, 0, nullptr};
+        reserveHead += padding;
+    }
+
+    byte* record = At(reserveHead);
+    new (record)
+        LogRecordHeader{static_cast<uint32_t>(payloadSize), key, replay};
+    reserveHead += recordSize;
+    return {record + sizeof(LogRecordHeader), payloadSize};
+}
+
+size_t LogRingBuffer::Drain(void* target)
+{
+    const uint64_t end = head.load(memory_order_acquire);
+    uint64_t position = tail.load(memory_order_relaxed);
+    size_t count = 0;
+
+    while (position < end)
+    {
+        byte* record = At(position);
+        auto* header = reinterpret_cast<LogRecordHeader*>(record);
+        if (header->replay)
+        {
+            header->replay(target, header->key,
+                           {record + sizeof(LogRecordHeader), header->size});
+            ++count;
+        }
+        // The payload is padded so the next header stays aligned
+        position += AlignRecord(sizeof(LogRecordHeader) + header->size);
+        // Hand the space back right away so the producer can reuse it
+        tail.store(position, memory_order_release);
+    }
+    return count;
+}
@@ -0,0 +1,57 @@
+#include <logging/LogStaging.h>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    atomic<uint64_t> nextStagingId{1};
+}  // namespace
+
+LogStaging::LogStaging(size_t capacityPerThread)
+    : capacityPerThread(capacityPerThread),
+      id(nextStagingId.fetch_add(1, memory_order_relaxed))
+{
+}
+
+size_t LogStaging::Drain(void* target)
+{
+    size_t count = 0;
+    for (Producer* producer = producers.load(memory_order_acquire); producer;
+         producer = producer->next)
+    {
+        count += producer->ring.Drain(target);
+    }
+    return count;
+}
+
+LogStagingStats LogStaging::GetStats() const
+{
+    LogStagingStats stats;
+    for (Producer* producer = producers.load(memory_order_acquire); producer;
+         producer = producer->next)
+    {
+        ++stats.threads;
+        stats.queued += producer->queued.load(memory_order_relaxed);
+        stats.dropped += producer->dropped.load(memory_order_relaxed);
+    }
+    return stats;
+}
+
+LogStaging::Producer& LogStaging::Register()
+{
+    scoped_lock lock{mutex};
+    const auto thread = this_thread::get_id();
+    for (Producer& producer : storage)
+    {
+        if (producer.thread == thread)
+        {
+            return producer;
+        }
+    }
+
+    Producer& producer = storage.emplace_back(capacityPerThread, thread);
+    producer.next = producers.load(memory_order_relaxed);
+    producers.store(&producer, memory_order_release);
+    return producer;
+}
@@ -0,0 +1,167 @@
+#include "logging/LogStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    string_view Trim(string_view text)
+    {
+        constexpr string_view kSpace = " \t\r\n/";
+        auto first = text.find_first_not_of(kSpace);
+        if (first == string_view::npos)
+        {
+            return {};
+        }
+        auto last = text.find_last_not_of(kSpace);
+        return text.substr(first, last - first + 1);
+    }
+
+    /** @brief Whether a key path is a prefix or under it (whole segments) */
+    bool Covers(string_view prefix, string_view path)
+    {
+        return path.starts_with(prefix) &&
+               (path.size() == prefix.size() || path[prefix.size()] == '/');
+    }
+
+    /** @brief Nearest-rank percentile of sorted values */
+    double Percentile(span<const double> sorted, double fraction)
+    {
+        auto rank = static_cast<size_t>(
+            ceil(fraction * static_cast<double>(sorted.size())));
+        return sorted[clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+}  // namespace
+
+LogStatistics::LogStatistics(const LogKeyRegistry& keys,
+                             string_view prefixList,
+                             chrono::milliseconds window, size_t maxSamples)
+    : keys(keys),
+      window(chrono::duration_cast<chrono::microseconds>(window).count()),
+      maxSamples(maxSamples),
+      matches(make_unique<atomic<Match>[]>(LogKeyRegistry::Capacity()))
+{
+    if (this->window <= 0 || maxSamples == 0)
+    {
+        throw invalid_argument(
+            "Statistics window and sample count must be positive");
+    }
+    while (!prefixList.empty())
+    {
+        auto comma = prefixList.find(',');
+        string_view prefix = Trim(prefixList.substr(0, comma));
+        prefixList = comma == string_view::npos ? string_view{}
+                                                : prefixList.substr(comma + 1);
+        if (!prefix.empty())
+        {
+            prefixes.emplace_back(prefix);
+        }
+    }
+}
+
+bool LogStatistics::Tracked(LogKey key) const
+{
+    auto& match = matches[key];
+    Match known = match.load(memory_order_relaxed);
+    if (known == kUnknown)
+    {
+        // Racing threads all come to the same answer, so storing it twice
+        // is harmless
+        string_view path = keys.Path(key);
+        known = kIgnored;
+        if (!Covers(kOutputPrefix, path))
+        {
+            for (const auto& prefix : prefixes)
+            {
+                if (Covers(prefix, path))
+                {
+                    known = kTracked;
+                    break;
+                }
+            }
+        }
+        match.store(known, memory_order_relaxed);
+    }
+    return known == kTracked;
+}
+
+void LogStatistics::Add(LogKey key, double value)
+{
+    if (!Tracked(key) || !isfinite(value))
+    {
+        return;
+    }
+
+    scoped_lock lock{mutex};
+    if (key >= accumulators.size())
+    {
+        accumulators.resize(key + 1);
+    }
+    auto& acc = accumulators[key];
+    if (acc.count == 0)
+    {
+        active.push_back(key);
+        acc.min = acc.max = value;
+        acc.samples.reserve(maxSamples);
+    }
+    ++acc.count;
+    acc.min = min(acc.min, value);
+    acc.max = max(acc.max, value);
+    double delta = value - acc.mean;
+    acc.mean += delta / static_cast<double>(acc.count);
+    acc.m2 += delta * (value - acc.mean);
+
+    if (acc.samples.size() < maxSamples)
+    {
+        acc.samples.push_back(value);
+        return;
+    }
+    // Reservoir sampling: every value so far is equally likely to be kept
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    auto slot = random % acc.count;
+    if (slot < maxSamples)
+    {
+        acc.samples[slot] = value;
+    }
+}
+
+bool LogStatistics::Collect(int64_t now, vector<LogSummary>& out)
+{
+    out.clear();
+    scoped_lock lock{mutex};
+    if (windowStart == 0)
+    {
+        windowStart = now;
+    }
+    if (now - windowStart < window)
+    {
+        return false;
+    }
+
+    for (LogKey key : active)
+    {
+        auto& acc = accumulators[key];
+        sort(acc.samples.begin(), acc.samples.end());
+        double variance =
+            acc.count > 1 ? acc.m2 / static_cast<double>(acc.count - 1) : 0;
+        out.push_back({key, acc.count, acc.min, acc.max, acc.mean,
+                       sqrt(variance), Percentile(acc.samples, 0.5),
+                       Percentile(acc.samples, 0.9),
+                       Percentile(acc.samples, 0.99)});
+
+        // clear() keeps the sample buffer's capacity for the next window
+        acc.count = 0;
+        acc.mean = 0;
+        acc.m2 = 0;
+        acc.samples.clear();
+    }
+    active.clear();
+    windowStart = now;
+    return true;
+}
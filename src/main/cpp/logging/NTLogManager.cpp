@@ -1,3 +1,4 @@
+#include <logging/LogBuffers.h>
 #include <logging/NTLogManager.h>
 #include <networktables/NetworkTable.h>
 #include <networktables/NetworkTableInstance.h>
@@ -5,14 +6,20 @@
 #include <networktables/StructTopic.h>
 
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 
 using namespace nfr;
 using namespace std;
 using namespace nt;
 
-NTLogManager::NTLogManager(const string_view& tableName)
-    : table(NetworkTableInstance::GetDefault().GetTable(tableName))
+NTLogManager::NTLogManager(const LogKeyRegistry& keys,
+                           const string_view& tableName, LogChangeFilter filter,
+                           LogBandwidthBudget budget)
+    : keys(keys),
+      table(NetworkTableInstance::GetDefault().GetTable(tableName)),
+      filter(std::move(filter)),
+      limiter(keys, std::move(budget)),
+      structEntries(keys)
 {
     if (!table)
     {
@@ -20,215 +27,327 @@ NTLogManager::NTLogManager(const string_view& tableName)
     }
 }
 
-void NTLogManager::Log(const string_view& key, double value)
+void NTLogManager::Log(LogKey key, double value, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetDoubleTopic(key).Publish();
+        topic = MakeSlot<DoubleSlot>(
+            key, table->GetDoubleTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, DoublePublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, DoubleSlot>)
             {
-                pub.Set(value);
+                if (filter.enabled && slot.published &&
+                    NearlyEqual(slot.last, value, slot.epsilon))
+                {
+                    return;
+                }
+                if (!Admit(key, sizeof(double), timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(value, timestamp);
+                slot.last = value;
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected double, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key, long value)
+void NTLogManager::Log(LogKey key, long value, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetIntegerTopic(key).Publish();
+        topic = MakeSlot<IntegerSlot>(
+            key, table->GetIntegerTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, IntegerPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, IntegerSlot>)
             {
-                pub.Set(value);
+                if (filter.enabled && slot.published && slot.last == value)
+                {
+                    return;
+                }
+                if (!Admit(key, sizeof(value), timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(value, timestamp);
+                slot.last = value;
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected integer, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key, bool value)
+void NTLogManager::Log(LogKey key, bool value, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetBooleanTopic(key).Publish();
+        topic = MakeSlot<BooleanSlot>(
+            key, table->GetBooleanTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, BooleanPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, BooleanSlot>)
             {
-                pub.Set(value);
+                if (filter.enabled && slot.published && slot.last == value)
+                {
+                    return;
+                }
+                if (!Admit(key, sizeof(value), timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(value, timestamp);
+                slot.last = value;
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected boolean, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key, const string_view& value)
+void NTLogManager::Log(LogKey key, const string_view& value, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetStringTopic(key).Publish();
+        topic = MakeSlot<StringSlot>(
+            key, table->GetStringTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, StringPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, StringSlot>)
             {
-                pub.Set(value);
+                if (filter.enabled && slot.published && slot.last == value)
+                {
+                    return;
+                }
+                if (!Admit(key, value.size(), timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(value, timestamp);
+                slot.last.assign(value);
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected string, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key, std::span<double> values)
+void NTLogManager::Log(LogKey key, std::span<double> values, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetDoubleArrayTopic(key).Publish();
+        topic = MakeSlot<DoubleArraySlot>(
+            key, table->GetDoubleArrayTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, DoubleArrayPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, DoubleArraySlot>)
             {
-                pub.Set(values);
+                const size_t bytes = values.size_bytes();
+                if (!filter.enabled)
+                {
+                    if (Admit(key, bytes, timestamp))
+                    {
+                        slot.publisher.Set(values, timestamp);
+                    }
+                    return;
+                }
+                if (slot.published &&
+                    NearlyEqual(slot.last, values, slot.epsilon))
+                {
+                    return;
+                }
+                if (!Admit(key, bytes, timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(values, timestamp);
+                slot.last.assign(values.begin(), values.end());
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected double array, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key, std::span<long> values)
+void NTLogManager::Log(LogKey key, std::span<long> values, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetIntegerArrayTopic(key).Publish();
+        topic = MakeSlot<IntegerArraySlot>(
+            key, table->GetIntegerArrayTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, IntegerArrayPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, IntegerArraySlot>)
             {
-                // Convert std::span<long> to std::span<int64_t>
-                std::vector<int64_t> intValues(values.begin(), values.end());
-                pub.Set(intValues);
+                const size_t bytes = values.size() * sizeof(int64_t);
+                if (!filter.enabled)
+                {
+                    if (Admit(key, bytes, timestamp))
+                    {
+                        slot.publisher.Set(AsInt64(slot.last, values),
+                                           timestamp);
+                    }
+                    return;
+                }
+                if (slot.published && ArrayEqual(std::span{slot.last}, values))
+                {
+                    return;
+                }
+                if (!Admit(key, bytes, timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(ConvertInto(slot.last, values), timestamp);
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected integer array, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key, std::span<bool> values)
+void NTLogManager::Log(LogKey key, std::span<bool> values, int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetBooleanArrayTopic(key).Publish();
+        topic = MakeSlot<BooleanArraySlot>(
+            key, table->GetBooleanArrayTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, BooleanArrayPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, BooleanArraySlot>)
             {
-                // Convert std::span<bool> to std::vector<int>
-                std::vector<int> boolValues(values.begin(), values.end());
-                pub.Set(boolValues);
+                if (filter.enabled && slot.published &&
+                    ArrayEqual(std::span{slot.last}, values))
+                {
+                    return;
+                }
+                if (!Admit(key, values.size(), timestamp))
+                {
+                    return;
+                }
+                // NT stores booleans as ints
+                slot.publisher.Set(ConvertInto(slot.last, values), timestamp);
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected boolean array, got different type.");
             }
         },
         topic);
 }
 
-void NTLogManager::Log(const string_view& key,
-                       std::span<std::string_view> values)
+void NTLogManager::Log(LogKey key, std::span<std::string_view> values,
+                       int64_t timestamp)
 {
-    if (!topics.contains(string(key)))
+    auto& topic = GetTopic(key);
+    if (holds_alternative<monostate>(topic))
     {
-        topics[string(key)] = table->GetStringArrayTopic(key).Publish();
+        topic = MakeSlot<StringArraySlot>(
+            key, table->GetStringArrayTopic(keys.Path(key)).Publish());
     }
-    auto& topic = topics[string(key)];
     std::visit(
-        [&](auto& pub)
+        [&](auto& slot)
         {
-            using T = std::decay_t<decltype(pub)>;
-            if constexpr (std::is_same_v<T, StringArrayPublisher>)
+            using T = std::decay_t<decltype(slot)>;
+            if constexpr (std::is_same_v<T, StringArraySlot>)
             {
-                // Convert std::span<std::string_view> to
-                // std::vector<std::string>
-                std::vector<std::string> stringValues;
-                stringValues.reserve(values.size());
-                for (const auto& val : values)
+                if (filter.enabled && slot.published &&
+                    ArrayEqual(std::span{slot.last}.first(slot.size), values))
                 {
-                    stringValues.emplace_back(val);
+                    return;
                 }
-                pub.Set(stringValues);
+                size_t bytes = 0;
+                for (auto value : values)
+                {
+                    // Each string carries a length prefix
+                    bytes += value.size() + 1;
+                }
+                if (!Admit(key, bytes, timestamp))
+                {
+                    return;
+                }
+                slot.publisher.Set(ConvertInto(slot.last, values), timestamp);
+                slot.size = values.size();
+                slot.published = true;
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected string array, got different type.");
             }
         },
         topic);
-}
\ No newline at end of file
+}
@@ -0,0 +1,63 @@
+#include <logging/StructSlots.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace nfr;
+using namespace std;
+
+StructSlots::StructSlots(const LogKeyRegistry& keys) : keys(keys)
+{
+}
+
+StructSlots::~StructSlots()
+{
+    for (auto& slot : slots)
+    {
+        if (slot.entry)
+        {
+            slot.destroy(slot.entry);
+        }
+    }
+}
+
+void* StructSlots::Allocate(size_t size, size_t alignment)
+{
+    // Entries larger than a block get a block of their own
+    if (size + alignment > kBlockSize)
+    {
+        blocks.push_back(make_unique<byte[]>(size + alignment));
+        blockUsed = kBlockSize;  // The next entry starts a fresh block
+        void* memory = blocks.back().get();
+        size_t space = size + alignment;
+        return align(alignment, size, memory, space);
+    }
+
+    void* memory = nullptr;
+    if (blockUsed < kBlockSize)
+    {
+        memory = blocks.back().get() + blockUsed;
+        size_t space = kBlockSize - blockUsed;
+        memory = align(alignment, size, memory, space);
+    }
+    if (memory == nullptr)
+    {
+        blocks.push_back(make_unique<byte[]>(kBlockSize));
+        memory = blocks.back().get();
+        size_t space = kBlockSize;
+        memory = align(alignment, size, memory, space);
+    }
+    blockUsed = static_cast<size_t>(static_cast<byte*>(memory) -
+                                    blocks.back().get()) +
+                size;
+    return memory;
+}
+
+void StructSlots::ThrowMismatch(LogKey key, string_view existing,
+                                string_view requested) const
+{
+    throw runtime_error("Log entry type mismatch for key: " +
+                        string(keys.Path(key)) + ". Expected " +
+                        string(existing) + ", got " + string(requested) +
+                        ".");
+}
@@ -0,0 +1,144 @@
+#include <logging/TeeStreamBuf.h>
+#include <wpi/timestamp.h>
+
+#include <charconv>
+#include <cstring>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    constexpr string_view kDroppedSuffix = " bytes of console output dropped";
+    constexpr size_t kNoteLength = 24 + kDroppedSuffix.size();
+}  // namespace
+
+TeeStreamBuf::TeeStreamBuf(streambuf* primaryBuf, size_t capacity)
+    : primary_buf_(primaryBuf), capacity_(capacity)
+{
+    // Reserve up front (with room for the dropped-bytes note) so capturing
+    // never allocates afterwards
+    pending_.reserve(capacity_ + kNoteLength);
+    taken_.reserve(capacity_ + kNoteLength);
+}
+
+string_view TeeStreamBuf::TakeLines()
+{
+    scoped_lock lock{mutex_};
+    taken_.clear();
+    taken_.swap(pending_);
+
+    if (dropped_bytes_ > 0)
+    {
+        char count[24];
+        auto result = to_chars(count, count + sizeof(count), dropped_bytes_);
+        if (!taken_.empty())
+        {
+            taken_ += '\n';
+        }
+        taken_.append(count, result.ptr);
+        taken_ += kDroppedSuffix;
+        dropped_bytes_ = 0;
+    }
+    return taken_;
+}
+
+TeeStreamBuf::int_type TeeStreamBuf::overflow(int_type c)
+{
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        return traits_type::not_eof(c);
+    }
+
+    // Write to the primary buffer (original destination)
+    if (traits_type::eq_int_type(primary_buf_->sputc(c), traits_type::eof()))
+    {
+        return traits_type::eof();
+    }
+
+    char ch = traits_type::to_char_type(c);
+    scoped_lock lock{mutex_};
+    Capture(&ch, 1);
+    return c;
+}
+
+streamsize TeeStreamBuf::xsputn(const char* s, streamsize n)
+{
+    streamsize written = primary_buf_->sputn(s, n);
+
+    scoped_lock lock{mutex_};
+    Capture(s, static_cast<size_t>(n));
+    return written;
+}
+
+int TeeStreamBuf::sync()
+{
+    return primary_buf_->pubsync();
+}
+
+void TeeStreamBuf::Capture(const char* s, size_t n)
+{
+    while (n > 0)
+    {
+        const char* newline = static_cast<const char*>(memchr(s, '\n', n));
+        size_t length = newline ? static_cast<size_t>(newline - s) : n;
+
+        // Copy as much of this line as fits, splitting overlong lines
+        while (length > 0)
+        {
+            size_t chunk = min(length, kMaxLineLength - line_length_);
+            memcpy(line_.data() + line_length_, s, chunk);
+            line_length_ += chunk;
+            s += chunk;
+            n -= chunk;
+            length -= chunk;
+            if (line_length_ == kMaxLineLength)
+            {
+                EndLine();
+            }
+        }
+
+        if (newline)
+        {
+            EndLine();
+            ++s;
+            --n;
+        }
+    }
+}
+
+void TeeStreamBuf::EndLine()
+{
+    if (line_length_ == 0)
+    {
+        return;
+    }
+
+    // "[seconds] text", formatted without allocating
+    char stamp[32];
+    stamp[0] = '[';
+    double seconds = static_cast<double>(wpi::Now()) * 1e-6;
+    auto result =
+        to_chars(stamp + 1, stamp + sizeof(stamp) - 2, seconds,
+                 chars_format::fixed, 6);
+    *result.ptr++ = ']';
+    *result.ptr++ = ' ';
+    size_t stampLength = static_cast<size_t>(result.ptr - stamp);
+
+    size_t separator = pending_.empty() ? 0 : 1;
+    size_t needed = separator + stampLength + line_length_;
+    if (pending_.size() + needed > capacity_)
+    {
+        dropped_bytes_ += line_length_;
+    }
+    else
+    {
+        if (separator)
+        {
+            pending_ += '\n';
+        }
+        pending_.append(stamp, stampLength);
+        pending_.append(line_.data(), line_length_);
+    }
+    line_length_ = 0;
+}
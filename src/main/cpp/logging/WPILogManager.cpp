@@ -1,25 +1,46 @@
 #include <frc/DataLogManager.h>
 #include <frc/DriverStation.h>
+#include <logging/LogBuffers.h>
 #include <logging/WPILogManager.h>
 
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
 #include <string_view>
-#include <unordered_map>
 
 using namespace nfr;
 using namespace wpi::log;
 using namespace std;
 using namespace frc;
 
-WPILogManager::WPILogManager() : logRef(frc::DataLogManager::GetLog())
+WPILogManager::WPILogManager(const LogKeyRegistry& keys, unsigned decimation)
+    : keys(keys),
+      logRef(frc::DataLogManager::GetLog()),
+      structEntries(keys),
+      decimation(decimation)
 {
+    if (decimation > UINT8_MAX)
+    {
+        throw invalid_argument("WPILog decimation must be at most 255");
+    }
+    if (decimation > 1)
+    {
+        decimationCounts = make_unique<atomic<uint8_t>[]>(
+            LogKeyRegistry::Capacity());
+    }
     DriverStation::StartDataLog(logRef);
 }
 
-void WPILogManager::Log(const string_view& key, double value)
+void WPILogManager::Log(LogKey key, double value, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
     {
-        entries[string(key)] = DoubleLogEntry(logRef, key);
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
+    {
+        logEntry = DoubleLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -27,23 +48,29 @@ void WPILogManager::Log(const string_view& key, double value)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, DoubleLogEntry>)
             {
-                entry.Append(value);
+                entry.Append(value, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected double, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key, long value)
+void WPILogManager::Log(LogKey key, long value, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
+    {
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
     {
-        entries[string(key)] = IntegerLogEntry(logRef, key);
+        logEntry = IntegerLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -51,23 +78,29 @@ void WPILogManager::Log(const string_view& key, long value)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, IntegerLogEntry>)
             {
-                entry.Append(value);
+                entry.Append(value, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected integer, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key, bool value)
+void WPILogManager::Log(LogKey key, bool value, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
+    {
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
     {
-        entries[string(key)] = BooleanLogEntry(logRef, key);
+        logEntry = BooleanLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -75,23 +108,25 @@ void WPILogManager::Log(const string_view& key, bool value)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, BooleanLogEntry>)
             {
-                entry.Append(value);
+                entry.Append(value, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected boolean, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key, const string_view& value)
+void WPILogManager::Log(LogKey key, const string_view& value, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
     {
-        entries[string(key)] = StringLogEntry(logRef, key);
+        logEntry = StringLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -99,23 +134,29 @@ void WPILogManager::Log(const string_view& key, const string_view& value)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, StringLogEntry>)
             {
-                entry.Append(value);
+                entry.Append(value, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected string, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key, std::span<double> values)
+void WPILogManager::Log(LogKey key, std::span<double> values, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
+    {
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
     {
-        entries[string(key)] = DoubleArrayLogEntry(logRef, key);
+        logEntry = DoubleArrayLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -123,23 +164,29 @@ void WPILogManager::Log(const string_view& key, std::span<double> values)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, DoubleArrayLogEntry>)
             {
-                entry.Append(values);
+                entry.Append(values, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected double array, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key, std::span<long> values)
+void WPILogManager::Log(LogKey key, std::span<long> values, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
+    {
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
     {
-        entries[string(key)] = IntegerArrayLogEntry(logRef, key);
+        logEntry = IntegerArrayLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -147,24 +194,29 @@ void WPILogManager::Log(const string_view& key, std::span<long> values)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, IntegerArrayLogEntry>)
             {
-                std::vector<int64_t> valuesVec(values.begin(), values.end());
-                entry.Append(valuesVec);
+                entry.Append(AsInt64(int64Buffer, values), timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected integer array, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key, std::span<bool> values)
+void WPILogManager::Log(LogKey key, std::span<bool> values, int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
     {
-        entries[string(key)] = BooleanArrayLogEntry(logRef, key);
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
+    {
+        logEntry = BooleanArrayLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -172,24 +224,30 @@ void WPILogManager::Log(const string_view& key, std::span<bool> values)
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, BooleanArrayLogEntry>)
             {
-                entry.Append(values);
+                entry.Append(values, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected boolean array, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
 
-void WPILogManager::Log(const string_view& key,
-                        std::span<std::string_view> values)
+void WPILogManager::Log(LogKey key, std::span<std::string_view> values,
+                        int64_t timestamp)
 {
-    if (!entries.contains(string(key)))
+    if (Decimated(key))
+    {
+        return;
+    }
+    auto& logEntry = GetEntry(key);
+    if (holds_alternative<monostate>(logEntry))
     {
-        entries[string(key)] = StringArrayLogEntry(logRef, key);
+        logEntry = StringArrayLogEntry(logRef, keys.Path(key));
     }
     std::visit(
         [&](auto& entry)
@@ -197,14 +255,15 @@ void WPILogManager::Log(const string_view& key,
             using T = std::decay_t<decltype(entry)>;
             if constexpr (std::is_same_v<T, StringArrayLogEntry>)
             {
-                entry.Append(values);
+                entry.Append(values, timestamp);
             }
             else
             {
                 throw runtime_error(
-                    "Log entry type mismatch for key: " + string(key) +
+                    "Log entry type mismatch for key: " +
+                    string(keys.Path(key)) +
                     ". Expected string array, got different type.");
             }
         },
-        entries[string(key)]);
+        logEntry);
 }
\ No newline at end of file
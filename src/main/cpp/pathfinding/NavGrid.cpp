@@ -0,0 +1,276 @@
+#include "pathfinding/NavGrid.h"
+
+#include <wpi/json.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /** @brief ORs `in` shifted by `shift` cells (either way) into `out` */
+    void OrShifted(const uint64_t* in, uint64_t* out, int words, int shift)
+    {
+        const int wordShift = abs(shift) / 64;
+        const int bitShift = abs(shift) % 64;
+        for (int i = 0; i < words; ++i)
+        {
+            // Toward higher cells, word i takes bits from words below it
+            int from = shift > 0 ? i - wordShift : i + wordShift;
+            if (from < 0 || from >= words)
+            {
+                continue;
+            }
+            if (shift > 0)
+            {
+                out[i] |= in[from] << bitShift;
+                if (bitShift != 0 && from > 0)
+                {
+                    out[i] |= in[from - 1] >> (64 - bitShift);
+                }
+            }
+            else
+            {
+                out[i] |= in[from] >> bitShift;
+                if (bitShift != 0 && from + 1 < words)
+                {
+                    out[i] |= in[from + 1] << (64 - bitShift);
+                }
+            }
+        }
+    }
+}  // namespace
+
+NavGrid::NavGrid(int width, int height, units::meter_t nodeSize)
+    : width(width),
+      height(height),
+      wordsPerRow((width + 63) / 64),
+      nodeSize(nodeSize),
+      words(static_cast<size_t>(wordsPerRow) * max(height, 0))
+{
+    if (width <= 0 || height <= 0 || nodeSize <= 0_m)
+    {
+        throw invalid_argument("Navgrid size must be positive");
+    }
+}
+
+NavGrid NavGrid::Load(const string& path)
+{
+    ifstream file{path};
+    if (!file)
+    {
+        throw runtime_error("Could not open navgrid: " + path);
+    }
+    stringstream contents;
+    contents << file.rdbuf();
+
+    try
+    {
+        auto json = wpi::json::parse(contents.str());
+        const auto& rows = json.at("grid");
+        if (rows.empty())
+        {
+            throw runtime_error("Empty navgrid: " + path);
+        }
+        NavGrid grid{static_cast<int>(rows.at(0).size()),
+                     static_cast<int>(rows.size()),
+                     units::meter_t{json.at("nodeSizeMeters").get<double>()}};
+        for (int y = 0; y < grid.height; ++y)
+        {
+            const auto& row = rows.at(y);
+            if (static_cast<int>(row.size()) != grid.width)
+            {
+                throw runtime_error("Navgrid rows differ in length: " + path);
+            }
+            for (int x = 0; x < grid.width; ++x)
+            {
+                grid.SetBlocked({x, y}, row.at(x).get<bool>());
+            }
+        }
+        return grid;
+    }
+    catch (const wpi::json::exception& e)
+    {
+        throw runtime_error("Not a navgrid: " + path + " (" + e.what() + ")");
+    }
+}
+
+void NavGrid::SetBlocked(GridCell cell, bool blocked)
+{
+    if (!Contains(cell))
+    {
+        throw out_of_range("Cell is outside the navgrid");
+    }
+    uint64_t bit = uint64_t{1} << (cell.x % 64);
+    auto& word = Row(cell.y)[cell.x / 64];
+    word = blocked ? word | bit : word & ~bit;
+}
+
+int NavGrid::BlockedCount() const
+{
+    int count = 0;
+    for (auto word : words)
+    {
+        count += popcount(word);
+    }
+    return count;
+}
+
+NavGrid NavGrid::Inflated(units::meter_t clearance) const
+{
+    NavGrid inflated = *this;
+    const double radius = clearance.value() / nodeSize.value();
+    const int reach = static_cast<int>(floor(radius));
+    if (reach <= 0)
+    {
+        return inflated;
+    }
+
+    // Rows within `reach` of an obstacle's row get it spread sideways by
+    // however far the circle around it reaches at that row
+    vector<uint64_t> spread(wordsPerRow);
+    for (int dy = -reach; dy <= reach; ++dy)
+    {
+        const int halfWidth =
+            static_cast<int>(floor(sqrt(radius * radius - dy * dy)));
+        for (int y = 0; y < height; ++y)
+        {
+            const int from = y + dy;
+            if (from < 0 || from >= height)
+            {
+                continue;
+            }
+            const uint64_t* source = Row(from);
+            copy(source, source + wordsPerRow, spread.begin());
+            for (int shift = 1; shift <= halfWidth; ++shift)
+            {
+                OrShifted(source, spread.data(), wordsPerRow, shift);
+                OrShifted(source, spread.data(), wordsPerRow, -shift);
+            }
+            uint64_t* target = inflated.Row(y);
+            for (int i = 0; i < wordsPerRow; ++i)
+            {
+                target[i] |= spread[i];
+            }
+        }
+    }
+
+    // Shifting can carry bits past the last cell
+    if (width % 64 != 0)
+    {
+        const uint64_t mask = (uint64_t{1} << (width % 64)) - 1;
+        for (int y = 0; y < height; ++y)
+        {
+            inflated.Row(y)[wordsPerRow - 1] &= mask;
+        }
+    }
+    return inflated;
+}
+
+bool NavGrid::HasLineOfSight(GridCell from, GridCell to) const
+{
+    // Walks every cell the line crosses, in order, stepping across
+    // whichever cell edge the line reaches first
+    const int nx = abs(to.x - from.x);
+    const int ny = abs(to.y - from.y);
+    const int stepX = to.x > from.x ? 1 : -1;
+    const int stepY = to.y > from.y ? 1 : -1;
+    GridCell cell = from;
+    if (IsBlocked(cell))
+    {
+        return false;
+    }
+    for (int ix = 0, iy = 0; ix < nx || iy < ny;)
+    {
+        // Compares where the next vertical and horizontal edges are crossed
+        const long decision = static_cast<long>(1 + 2 * ix) * ny -
+                              static_cast<long>(1 + 2 * iy) * nx;
+        if (decision == 0)
+        {
+            // Exactly through a corner
+            if (IsBlocked({cell.x + stepX, cell.y}) ||
+                IsBlocked({cell.x, cell.y + stepY}))
+            {
+                return false;
+            }
+            cell.x += stepX;
+            cell.y += stepY;
+            ++ix;
+            ++iy;
+        }
+        else if (decision < 0)
+        {
+            cell.x += stepX;
+            ++ix;
+        }
+        else
+        {
+            cell.y += stepY;
+            ++iy;
+        }
+        if (IsBlocked(cell))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+GridCell NavGrid::CellAt(const frc::Translation2d& position) const
+{
+    auto index = [&](units::meter_t coordinate, int size)
+    {
+        int i = static_cast<int>(floor(coordinate.value() / nodeSize.value()));
+        return clamp(i, 0, size - 1);
+    };
+    return {index(position.X(), width), index(position.Y(), height)};
+}
+
+frc::Translation2d NavGrid::CenterOf(GridCell cell) const
+{
+    return {nodeSize * (cell.x + 0.5), nodeSize * (cell.y + 0.5)};
+}
+
+optional<GridCell> NavGrid::NearestFree(GridCell cell, int maxDistance) const
+{
+    if (!IsBlocked(cell))
+    {
+        return cell;
+    }
+    // Rings of growing size around the cell; the closest free cell on the
+    // first ring that has one
+    for (int distance = 1; distance <= maxDistance; ++distance)
+    {
+        optional<GridCell> best;
+        int bestSquared = 0;
+        for (int dy = -distance; dy <= distance; ++dy)
+        {
+            for (int dx = -distance; dx <= distance; ++dx)
+            {
+                if (max(abs(dx), abs(dy)) != distance)
+                {
+                    continue;
+                }
+                GridCell candidate{cell.x + dx, cell.y + dy};
+                int squared = dx * dx + dy * dy;
+                if (!IsBlocked(candidate) && (!best || squared < bestSquared))
+                {
+                    best = candidate;
+                    bestSquared = squared;
+                }
+            }
+        }
+        if (best)
+        {
+            return best;
+        }
+    }
+    return nullopt;
+}
@@ -0,0 +1,343 @@
+#include "pathfinding/Pathfinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /** @brief How far an end in a blocked cell may be moved, in cells */
+    constexpr int kMaxSnapDistance = 5;
+
+    /** @brief Orders the open heap so the lowest estimate is on top */
+    bool Later(const pair<float, int>& a, const pair<float, int>& b)
+    {
+        return a.first > b.first;
+    }
+
+    double Cross(const frc::Translation2d& a, const frc::Translation2d& b)
+    {
+        return a.X().value() * b.Y().value() - a.Y().value() * b.X().value();
+    }
+
+    /** @brief Whether moving from point to point only crosses free cells */
+    bool IsClear(const NavGrid& grid, span<const frc::Translation2d> points)
+    {
+        for (size_t i = 1; i < points.size(); ++i)
+        {
+            if (!grid.HasLineOfSight(grid.CellAt(points[i - 1]),
+                                     grid.CellAt(points[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}  // namespace
+
+Pathfinder::Pathfinder(const NavGrid& grid)
+    : grid(&grid)
+{
+    const size_t cells = static_cast<size_t>(grid.Width()) * grid.Height();
+    reached.resize(cells);
+    closed.resize(cells);
+    cost.resize(cells);
+    parent.resize(cells);
+    // A cell is pushed at most once per neighbor that improves it
+    open.reserve(cells * 8 + 1);
+}
+
+float Pathfinder::Distance(GridCell a, GridCell b)
+{
+    return static_cast<float>(hypot(a.x - b.x, a.y - b.y));
+}
+
+void Pathfinder::Relax(int cell, int via, GridCell goal)
+{
+    GridCell position = CellOf(cell);
+    float candidate = cost[via] + Distance(CellOf(via), position);
+    if (reached[cell] == search && candidate >= cost[cell])
+    {
+        return;
+    }
+    reached[cell] = search;
+    cost[cell] = candidate;
+    parent[cell] = via;
+    open.emplace_back(candidate + Distance(position, goal), cell);
+    push_heap(open.begin(), open.end(), Later);
+}
+
+bool Pathfinder::FindPath(const frc::Translation2d& start,
+                          const frc::Translation2d& goal,
+                          vector<frc::Translation2d>& waypoints)
+{
+    waypoints.clear();
+    expanded = 0;
+    auto startCell = grid->NearestFree(grid->CellAt(start), kMaxSnapDistance);
+    auto goalCell = grid->NearestFree(grid->CellAt(goal), kMaxSnapDistance);
+    if (!startCell || !goalCell)
+    {
+        return false;
+    }
+
+    ++search;
+    open.clear();
+    const int first = Index(*startCell);
+    const int last = Index(*goalCell);
+    reached[first] = search;
+    cost[first] = 0;
+    parent[first] = first;
+    open.emplace_back(Distance(*startCell, *goalCell), first);
+
+    bool found = false;
+    while (!open.empty())
+    {
+        pop_heap(open.begin(), open.end(), Later);
+        const int current = open.back().second;
+        open.pop_back();
+        if (closed[current] == search)
+        {
+            continue;  // Stale: reached more cheaply since it was pushed
+        }
+        closed[current] = search;
+        ++expanded;
+        if (current == last)
+        {
+            found = true;
+            break;
+        }
+
+        const GridCell cell = CellOf(current);
+        const int ancestor = parent[current];
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                GridCell next{cell.x + dx, cell.y + dy};
+                if ((dx == 0 && dy == 0) || grid->IsBlocked(next))
+                {
+                    continue;
+                }
+                // No cutting diagonally past an obstacle's corner
+                if (dx != 0 && dy != 0 &&
+                    (grid->IsBlocked({cell.x + dx, cell.y}) ||
+                     grid->IsBlocked({cell.x, cell.y + dy})))
+                {
+                    continue;
+                }
+                const int neighbor = Index(next);
+                if (closed[neighbor] == search)
+                {
+                    continue;
+                }
+                // The Theta* step: skip this cell entirely if its parent can
+                // see the neighbor
+                if (ancestor != current &&
+                    grid->HasLineOfSight(CellOf(ancestor), next))
+                {
+                    Relax(neighbor, ancestor, *goalCell);
+                }
+                else
+                {
+                    Relax(neighbor, current, *goalCell);
+                }
+            }
+        }
+    }
+    if (!found)
+    {
+        return false;
+    }
+
+    // Walk back from the goal; the exact ends replace their cells' centers
+    // unless they were moved out of a blocked cell
+    waypoints.push_back(goal);
+    if (*goalCell != grid->CellAt(goal))
+    {
+        waypoints.push_back(grid->CenterOf(*goalCell));
+    }
+    for (int cell = parent[last]; cell != first; cell = parent[cell])
+    {
+        waypoints.push_back(grid->CenterOf(CellOf(cell)));
+    }
+    if (*startCell != grid->CellAt(start))
+    {
+        waypoints.push_back(grid->CenterOf(*startCell));
+    }
+    waypoints.push_back(start);
+    reverse(waypoints.begin(), waypoints.end());
+    return true;
+}
+
+CachedTrajectory nfr::ToTrajectory(const NavGrid& grid,
+                                   span<const frc::Translation2d> waypoints,
+                                   frc::Rotation2d startHeading,
+                                   frc::Rotation2d endHeading,
+                                   const PathConstraints& constraints)
+{
+    if (waypoints.empty())
+    {
+        return {};
+    }
+
+    // Points along the path, every sampleSpacing or so, with the corners
+    // rounded off by quadratic Bézier curves
+    const double spacing = constraints.sampleSpacing.value();
+    vector<frc::Translation2d> points{waypoints.front()};
+    auto addLine = [&](const frc::Translation2d& to)
+    {
+        const auto from = points.back();
+        const double length = to.Distance(from).value();
+        const int steps = static_cast<int>(ceil(length / spacing));
+        for (int i = 1; i <= steps; ++i)
+        {
+            points.push_back(from + (to - from) * (static_cast<double>(i) /
+                                                   steps));
+        }
+    };
+    auto addCurve = [&](const frc::Translation2d& corner,
+                        const frc::Translation2d& to)
+    {
+        const auto from = points.back();
+        const double length =
+            (corner.Distance(from) + to.Distance(corner)).value();
+        const int steps = max(1, static_cast<int>(ceil(length / spacing)));
+        for (int i = 1; i <= steps; ++i)
+        {
+            const double t = static_cast<double>(i) / steps;
+            points.push_back(from * ((1 - t) * (1 - t)) +
+                             corner * (2 * (1 - t) * t) + to * (t * t));
+        }
+    };
+    for (size_t i = 1; i + 1 < waypoints.size(); ++i)
+    {
+        const auto& corner = waypoints[i];
+        const auto& previous = waypoints[i - 1];
+        const auto& next = waypoints[i + 1];
+        const double in = corner.Distance(previous).value();
+        const double out = next.Distance(corner).value();
+        if (in == 0 || out == 0)
+        {
+            continue;  // A repeated waypoint isn't a corner
+        }
+        // Half of each side at most, so neighboring curves don't overlap
+        double radius =
+            min({constraints.cornerRadius.value(), in / 2, out / 2});
+        const size_t mark = points.size();
+        while (radius >= spacing)
+        {
+            addLine(corner + (previous - corner) * (radius / in));
+            const size_t curve = points.size() - 1;
+            addCurve(corner, corner + (next - corner) * (radius / out));
+            // The curve cuts inside the corner, which the search never
+            // checked; where that clips an obstacle, round it more tightly
+            if (IsClear(grid, span{points}.subspan(curve)))
+            {
+                break;
+            }
+            points.resize(mark);
+            radius /= 2;
+        }
+        if (radius < spacing)
+        {
+            // Nothing fits: turn right at the corner, which is on the path
+            addLine(corner);
+        }
+    }
+    addLine(waypoints.back());
+
+    // Fastest speed at each point: no faster than maxVelocity, slow enough
+    // on curves that sideways acceleration stays within maxAcceleration,
+    // and reachable accelerating from the start and braking for the goal
+    const size_t count = points.size();
+    const double maxVelocity = constraints.maxVelocity.value();
+    const double maxAcceleration = constraints.maxAcceleration.value();
+    vector<double> distance(count, 0);
+    vector<double> velocity(count, maxVelocity);
+    for (size_t i = 1; i < count; ++i)
+    {
+        distance[i] = points[i].Distance(points[i - 1]).value();
+    }
+    for (size_t i = 1; i + 1 < count; ++i)
+    {
+        // Curvature of the circle through this point and its neighbors
+        const double sides = distance[i] * distance[i + 1] *
+                             points[i + 1].Distance(points[i - 1]).value();
+        const double curvature =
+            sides > 0 ? 2 *
+                            abs(Cross(points[i] - points[i - 1],
+                                      points[i + 1] - points[i])) /
+                            sides
+                      : 0;
+        if (curvature > 0)
+        {
+            velocity[i] = min(velocity[i], sqrt(maxAcceleration / curvature));
+        }
+    }
+    velocity.front() = 0;
+    velocity.back() = 0;
+    for (size_t i = 1; i < count; ++i)
+    {
+        velocity[i] = min(velocity[i], sqrt(velocity[i - 1] * velocity[i - 1] +
+                                            2 * maxAcceleration * distance[i]));
+    }
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        velocity[i - 1] =
+            min(velocity[i - 1], sqrt(velocity[i] * velocity[i] +
+                                      2 * maxAcceleration * distance[i]));
+    }
+
+    // Times from the average speed between points
+    vector<double> time(count, 0);
+    for (size_t i = 1; i < count; ++i)
+    {
+        const double speed = velocity[i - 1] + velocity[i];
+        // Both ends at rest: speed up over half, slow down over the rest
+        time[i] = time[i - 1] +
+                  (speed > 0 ? 2 * distance[i] / speed
+                             : 2 * sqrt(distance[i] / maxAcceleration));
+    }
+
+    const double totalTime = time.back();
+    const double turn = remainder(
+        (endHeading.Radians() - startHeading.Radians()).value(),
+        2 * numbers::pi);
+    vector<TrajectorySample> samples(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& sample = samples[i];
+        sample.timestamp = units::second_t{time[i]};
+        sample.x = points[i].X();
+        sample.y = points[i].Y();
+        const double progress = totalTime > 0 ? time[i] / totalTime : 1;
+        sample.heading = startHeading.Radians() +
+                         units::radian_t{turn * progress};
+        sample.omega = units::radians_per_second_t{
+            totalTime > 0 ? turn / totalTime : 0};
+
+        // Along the path, toward the next point (from the last one at the
+        // end)
+        frc::Translation2d direction;
+        if (i + 1 < count)
+        {
+            direction = points[i + 1] - points[i];
+        }
+        else if (i > 0)
+        {
+            direction = points[i] - points[i - 1];
+        }
+        const double length = direction.Norm().value();
+        if (length > 0)
+        {
+            sample.vx = units::meters_per_second_t{
+                velocity[i] * direction.X().value() / length};
+            sample.vy = units::meters_per_second_t{
+                velocity[i] * direction.Y().value() / length};
+        }
+    }
+    return CachedTrajectory{samples};
+}
@@ -0,0 +1,83 @@
+#include <logging/LogSchema.h>
+#include <perf/LoopTimer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <tuple>
+
+using namespace nfr;
+using namespace std;
+
+template <>
+struct nfr::LogSchema<PhaseTimer::Summary>
+{
+    static constexpr std::tuple kFields{
+        LogField{"last_us", &PhaseTimer::Summary::last},
+        LogField{"p50_us", &PhaseTimer::Summary::p50},
+        LogField{"p99_us", &PhaseTimer::Summary::p99},
+        LogField{"max_us", &PhaseTimer::Summary::max},
+    };
+};
+
+namespace
+{
+    constexpr double kNanosecondsPerMicrosecond = 1000.0;
+
+    /** @brief Nearest-rank percentile of a window, reordering it in place */
+    int64_t Percentile(span<int64_t> window, double fraction)
+    {
+        auto rank = static_cast<size_t>(
+            ceil(fraction * static_cast<double>(window.size())));
+        auto nth = window.begin() + (max<size_t>(rank, 1) - 1);
+        nth_element(window.begin(), nth, window.end());
+        return *nth;
+    }
+}  // namespace
+
+PhaseTimer::Summary PhaseTimer::Summarize() const
+{
+    Summary summary;
+    if (count_ == 0)
+    {
+        return summary;
+    }
+
+    // Percentiles reorder the samples, so work on a copy
+    array<int64_t, kWindowSize> sorted;
+    copy_n(samples_.begin(), count_, sorted.begin());
+    span<int64_t> window{sorted.data(), count_};
+
+    summary.last = last_ / kNanosecondsPerMicrosecond;
+    summary.p50 = Percentile(window, 0.50) / kNanosecondsPerMicrosecond;
+    summary.p99 = Percentile(window, 0.99) / kNanosecondsPerMicrosecond;
+    summary.max = *max_element(window.begin(), window.end()) /
+                  kNanosecondsPerMicrosecond;
+    return summary;
+}
+
+void PhaseTimer::Log(const LogContext& log) const
+{
+    log << Summarize();
+}
+
+PhaseTimer& LoopTimer::AddPhase(string_view name)
+{
+    for (auto& [phaseName, timer] : phases_)
+    {
+        if (phaseName == name)
+        {
+            return *timer;
+        }
+    }
+    phases_.emplace_back(string(name), make_unique<PhaseTimer>());
+    return *phases_.back().second;
+}
+
+void LoopTimer::Log(const LogContext& log) const
+{
+    for (const auto& [name, timer] : phases_)
+    {
+        log[name] << *timer;
+    }
+}
@@ -0,0 +1,197 @@
+#include "replay/LogReplay.h"
+
+#include <frc/DataLogManager.h>
+#include <frc/RobotBase.h>
+#include <frc/simulation/SimHooks.h>
+#include <hal/HAL.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string_view>
+
+#include "Robot.h"
+#include "logging/Logger.h"
+#include "replay/ReplayInputs.h"
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    constexpr string_view kUsage =
+        "Usage: frcUserProgram --replay <log.wpilog> [--out <log.wpilog>]\n"
+        "                      [--from <seconds>] [--to <seconds>]\n"
+        "                      [--no-follow-pose]\n";
+
+    /** @brief Robot whose loop the replay steps by hand */
+    class ReplayRobot : public Robot
+    {
+    public:
+        // One pass of TimedRobot's loop: refresh the DS, run the mode
+        // functions and RobotPeriodic
+        using Robot::LoopFunc;
+
+        void ResetPose(const frc::Pose2d& pose)
+        {
+            GetContainer().ResetPose(pose);
+        }
+    };
+
+    int64_t ToMicroseconds(units::second_t time)
+    {
+        return static_cast<int64_t>(time.value() * 1e6);
+    }
+
+    filesystem::path OutputPath(const ReplayOptions& options)
+    {
+        if (!options.output.empty())
+        {
+            return filesystem::absolute(options.output);
+        }
+        filesystem::path input = filesystem::absolute(options.input);
+        return input.parent_path() /
+               (input.stem().string() + "_replay.wpilog");
+    }
+}  // namespace
+
+bool nfr::IsReplayRequested(int argc, char** argv)
+{
+    return argc > 1 && string_view{argv[1]} == "--replay";
+}
+
+optional<ReplayOptions> nfr::ParseReplayOptions(int argc, char** argv)
+{
+    ReplayOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--no-follow-pose")
+        {
+            options.followPose = false;
+        }
+        else if (arg == "--replay" && hasValue)
+        {
+            options.input = argv[++i];
+        }
+        else if (arg == "--out" && hasValue)
+        {
+            options.output = argv[++i];
+        }
+        else if ((arg == "--from" || arg == "--to") && hasValue)
+        {
+            char* end = nullptr;
+            units::second_t seconds{strtod(argv[++i], &end)};
+            if (*end != '\0')
+            {
+                cerr << "Not a number of seconds: " << argv[i] << "\n"
+                     << kUsage;
+                return nullopt;
+            }
+            if (arg == "--from")
+            {
+                options.from = seconds;
+            }
+            else
+            {
+                options.to = seconds;
+            }
+        }
+        else
+        {
+            cerr << "Unexpected argument: " << arg << "\n" << kUsage;
+            return nullopt;
+        }
+    }
+
+    if (options.input.empty())
+    {
+        cerr << kUsage;
+        return nullopt;
+    }
+    return options;
+}
+
+int nfr::RunLogReplay(const ReplayOptions& options)
+{
+    if (frc::RobotBase::IsReal())
+    {
+        cerr << "Log replay only runs in simulation" << endl;
+        return 1;
+    }
+    if (!HAL_Initialize(500, 0))
+    {
+        cerr << "FATAL: HAL could not be initialized" << endl;
+        return 1;
+    }
+
+    optional<ReplayInputs> inputs;
+    try
+    {
+        inputs.emplace(options.input);
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    const int64_t logStart = inputs->GetStartTime();
+    const int64_t start = logStart + ToMicroseconds(options.from);
+    const int64_t end = options.to ? logStart + ToMicroseconds(*options.to)
+                                   : inputs->GetEndTime();
+
+    // Robot time only moves when the loop below steps it, so nothing waits
+    // on the wall clock and every run sees the same timestamps
+    frc::sim::PauseTiming();
+
+    // Must be open before the robot's WPILog sink asks for the log
+    filesystem::path output = OutputPath(options);
+    frc::DataLogManager::Start(output.parent_path().string(),
+                               output.filename().string());
+
+    ReplayRobot robot;
+    const units::second_t period = robot.GetPeriod();
+    auto replayLog = nfr::logger["replay"];
+
+    auto wallStart = chrono::steady_clock::now();
+    long cycles = 0;
+    for (int64_t time = start; time <= end; time += ToMicroseconds(period))
+    {
+        inputs->ApplyDriverStation(time);
+        if (auto pose = inputs->GetPose(time))
+        {
+            if (options.followPose || cycles == 0)
+            {
+                robot.ResetPose(*pose);
+            }
+            replayLog["recorded/pose"] << *pose;
+        }
+        if (auto speeds = inputs->GetSpeeds(time))
+        {
+            replayLog["recorded/speeds"] << *speeds;
+        }
+        // Lines the new log up with the recorded one
+        replayLog["log_time"] << units::second_t{time * 1e-6};
+
+        robot.LoopFunc();
+        frc::sim::StepTiming(period);
+        ++cycles;
+    }
+
+    // Write out everything still queued before the log is closed
+    nfr::logger.DisableAsyncLogging();
+    frc::DataLogManager::Stop();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - wallStart;
+    double matchSeconds = cycles * period.value();
+    cout << "Replayed " << cycles << " cycles (" << matchSeconds
+         << " s) in " << elapsed.count() << " s ("
+         << matchSeconds / elapsed.count() << "x real time)\n"
+         << "Wrote " << output.string() << endl;
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include "replay/ReplayInputs.h"
+
+#include <frc/simulation/DriverStationSim.h>
+#include <hal/DriverStationTypes.h>
+#include <wpi/DataLogReader.h>
+#include <wpi/MemoryBuffer.h>
+#include <wpi/struct/Struct.h>
+
+#include <charconv>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+using namespace nfr;
+using namespace std;
+using frc::sim::DriverStationSim;
+using wpi::log::DataLogRecord;
+
+namespace
+{
+    using Decoder = function<void(const DataLogRecord&)>;
+
+    /** @brief Adds a value, keeping the series in timestamp order */
+    template <typename T>
+    void Append(ReplaySeries<T>& series, int64_t timestamp, T value)
+    {
+        auto it = upper_bound(series.timestamps.begin(),
+                              series.timestamps.end(), timestamp);
+        auto index = it - series.timestamps.begin();
+        series.timestamps.insert(it, timestamp);
+        series.values.insert(series.values.begin() + index, std::move(value));
+    }
+
+    Decoder BooleanDecoder(ReplaySeries<int>& series)
+    {
+        return [&series](const DataLogRecord& record)
+        {
+            bool value;
+            if (record.GetBoolean(&value))
+            {
+                Append(series, record.GetTimestamp(), int{value});
+            }
+        };
+    }
+
+    template <typename T>
+    Decoder StructDecoder(ReplaySeries<T>& series)
+    {
+        return [&series](const DataLogRecord& record)
+        {
+            if (record.GetSize() == wpi::GetStructSize<T>())
+            {
+                Append(series, record.GetTimestamp(),
+                       wpi::UnpackStruct<T>(record.GetRaw()));
+            }
+        };
+    }
+
+    /**
+     * @brief Parses "DS:joystick<N>/<field>" into the stick number and field
+     *
+     * @return -1 if the name isn't a joystick entry
+     */
+    int ParseJoystick(string_view name, string_view& field)
+    {
+        constexpr string_view kPrefix = "DS:joystick";
+        if (!name.starts_with(kPrefix))
+        {
+            return -1;
+        }
+        name.remove_prefix(kPrefix.size());
+        int stick = -1;
+        auto [end, error] =
+            from_chars(name.data(), name.data() + name.size(), stick);
+        if (error != errc{} || end == name.data() + name.size() || *end != '/')
+        {
+            return -1;
+        }
+        field = string_view{end + 1, name.data() + name.size()};
+        return stick;
+    }
+}  // namespace
+
+ReplayInputs::ReplayInputs(const string& path,
+                           const ReplayDriveKeys& driveKeys)
+{
+    auto buffer = wpi::MemoryBuffer::GetFile(path);
+    if (!buffer)
+    {
+        throw runtime_error("Could not open replay log " + path + ": " +
+                            buffer.error().message());
+    }
+    wpi::log::DataLogReader reader{std::move(*buffer)};
+    if (!reader.IsValid())
+    {
+        throw runtime_error("Not a WPILog file: " + path);
+    }
+
+    // Picks where an entry's values go from its name and type; entries this
+    // replay doesn't use get no decoder and are skipped
+    auto decoderFor = [&](string_view name, string_view type) -> Decoder
+    {
+        if (type == "boolean")
+        {
+            if (name == "DS:enabled")
+            {
+                return BooleanDecoder(enabled);
+            }
+            if (name == "DS:autonomous")
+            {
+                return BooleanDecoder(autonomous);
+            }
+            if (name == "DS:test")
+            {
+                return BooleanDecoder(test);
+            }
+            if (name == "DS:estop")
+            {
+                return BooleanDecoder(estop);
+            }
+            if (name == "NT:/FMSInfo/IsRedAlliance")
+            {
+                return BooleanDecoder(redAlliance);
+            }
+            return nullptr;
+        }
+        if (name == driveKeys.pose && type == "struct:Pose2d")
+        {
+            return StructDecoder(pose);
+        }
+        if (name == driveKeys.speeds && type == "struct:ChassisSpeeds")
+        {
+            return StructDecoder(speeds);
+        }
+
+        string_view field;
+        int stick = ParseJoystick(name, field);
+        if (stick < 0 || stick >= kJoystickCount)
+        {
+            return nullptr;
+        }
+        ReplayJoystick& joystick = joysticks[stick];
+        if (field == "axes" && type == "float[]")
+        {
+            return [&joystick](const DataLogRecord& record)
+            {
+                vector<float> axes;
+                if (record.GetFloatArray(&axes))
+                {
+                    Append(joystick.axes, record.GetTimestamp(),
+                           std::move(axes));
+                }
+            };
+        }
+        if (field == "buttons" && type == "boolean[]")
+        {
+            return [&joystick](const DataLogRecord& record)
+            {
+                vector<int> buttons;
+                if (record.GetBooleanArray(&buttons))
+                {
+                    Append(joystick.buttons, record.GetTimestamp(),
+                           std::move(buttons));
+                }
+            };
+        }
+        if (field == "povs" && type == "int64[]")
+        {
+            return [&joystick](const DataLogRecord& record)
+            {
+                vector<int64_t> povs;
+                if (record.GetIntegerArray(&povs))
+                {
+                    Append(joystick.povs, record.GetTimestamp(),
+                           std::move(povs));
+                }
+            };
+        }
+        return nullptr;
+    };
+
+    // Entry ids are only unique while an entry is open, so decoders are
+    // looked up by the id the most recent start record gave them
+    unordered_map<int, Decoder> decoders;
+    for (const DataLogRecord& record : reader)
+    {
+        if (record.IsStart())
+        {
+            wpi::log::StartRecordData start;
+            if (record.GetStartData(&start))
+            {
+                decoders.erase(start.entry);
+                if (auto decoder = decoderFor(start.name, start.type))
+                {
+                    decoders.emplace(start.entry, std::move(decoder));
+                }
+            }
+            continue;
+        }
+        if (record.IsFinish())
+        {
+            int entry;
+            if (record.GetFinishEntry(&entry))
+            {
+                decoders.erase(entry);
+            }
+            continue;
+        }
+        if (record.IsControl())
+        {
+            continue;
+        }
+
+        endTime = max(endTime, record.GetTimestamp());
+        if (auto it = decoders.find(record.GetEntry()); it != decoders.end())
+        {
+            it->second(record);
+        }
+    }
+
+    if (enabled.Empty())
+    {
+        throw runtime_error("No driver station data in " + path +
+                            " (was DriverStation::StartDataLog called?)");
+    }
+    startTime = enabled.timestamps.front();
+}
+
+void ReplayInputs::ApplyDriverStation(int64_t timestamp) const
+{
+    auto flag = [timestamp](const ReplaySeries<int>& series)
+    {
+        const int* value = series.At(timestamp);
+        return value && *value;
+    };
+
+    DriverStationSim::SetDsAttached(true);
+    DriverStationSim::SetEnabled(flag(enabled));
+    DriverStationSim::SetAutonomous(flag(autonomous));
+    DriverStationSim::SetTest(flag(test));
+    DriverStationSim::SetEStop(flag(estop));
+    if (const int* red = redAlliance.At(timestamp))
+    {
+        DriverStationSim::SetAllianceStationId(
+            *red ? HAL_AllianceStationID_kRed1 : HAL_AllianceStationID_kBlue1);
+    }
+
+    for (int stick = 0; stick < kJoystickCount; ++stick)
+    {
+        const ReplayJoystick& joystick = joysticks[stick];
+        if (const auto* axes = joystick.axes.At(timestamp))
+        {
+            int count = static_cast<int>(axes->size());
+            DriverStationSim::SetJoystickAxisCount(stick, count);
+            for (int axis = 0; axis < count; ++axis)
+            {
+                DriverStationSim::SetJoystickAxis(stick, axis, (*axes)[axis]);
+            }
+        }
+        if (const auto* buttons = joystick.buttons.At(timestamp))
+        {
+            // Button n is bit n-1; the DS supports at most 32 buttons
+            int count = min(static_cast<int>(buttons->size()), 32);
+            uint32_t bits = 0;
+            for (int button = 0; button < count; ++button)
+            {
+                if ((*buttons)[button])
+                {
+                    bits |= 1u << button;
+                }
+            }
+            DriverStationSim::SetJoystickButtonCount(stick, count);
+            DriverStationSim::SetJoystickButtons(stick, bits);
+        }
+        if (const auto* povs = joystick.povs.At(timestamp))
+        {
+            int count = static_cast<int>(povs->size());
+            DriverStationSim::SetJoystickPOVCount(stick, count);
+            for (int pov = 0; pov < count; ++pov)
+            {
+                DriverStationSim::SetJoystickPOV(
+                    stick, pov, static_cast<int>((*povs)[pov]));
+            }
+        }
+    }
+
+    DriverStationSim::NotifyNewData();
+}
+
+optional<frc::Pose2d> ReplayInputs::GetPose(int64_t timestamp) const
+{
+    auto next = upper_bound(pose.timestamps.begin(), pose.timestamps.end(),
+                            timestamp);
+    if (next == pose.timestamps.begin())
+    {
+        return nullopt;
+    }
+    auto index = next - pose.timestamps.begin() - 1;
+    const frc::Pose2d& before = pose.values[index];
+    if (next == pose.timestamps.end())
+    {
+        return before;
+    }
+
+    // Follow the constant-curvature path between the two samples
+    double fraction = static_cast<double>(timestamp - *(next - 1)) /
+                      static_cast<double>(*next - *(next - 1));
+    return before.Exp(before.Log(pose.values[index + 1]) * fraction);
+}
+
+optional<frc::ChassisSpeeds> ReplayInputs::GetSpeeds(int64_t timestamp) const
+{
+    if (const auto* value = speeds.At(timestamp))
+    {
+        return *value;
+    }
+    return nullopt;
+}
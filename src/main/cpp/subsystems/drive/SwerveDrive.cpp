@@ -3,6 +3,16 @@
 #include <frc/DriverStation.h>
 #include <frc/MathUtil.h>
 #include <frc/RobotController.h>
+#include <frc/Timer.h>
+#include <pathplanner/lib/util/FlippingUtil.h>
+#include <wpi/timestamp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <optional>
 
 using namespace nfr;
 using namespace ctre::phoenix6;
@@ -16,10 +26,63 @@ using namespace std;
 using namespace pathplanner;
 using namespace choreo;
 
+namespace
+{
+    /** @brief Whether paths planned on the blue side should be flipped */
+    bool IsRedAlliance()
+    {
+        auto const alliance = DriverStation::GetAlliance().value_or(
+            DriverStation::Alliance::kBlue);
+        return alliance == DriverStation::Alliance::kRed;
+    }
+
+    /** @brief Moves a sample planned on the blue side to the red side */
+    TrajectorySample FlippedToRed(TrajectorySample sample)
+    {
+        // Same field size and symmetry PathPlanner flips its paths with
+        auto const pose = FlippingUtil::flipFieldPose(
+            Pose2d{sample.x, sample.y, Rotation2d{sample.heading}});
+        auto const speeds = FlippingUtil::flipFieldSpeeds(
+            ChassisSpeeds{sample.vx, sample.vy, sample.omega});
+        sample.x = pose.X();
+        sample.y = pose.Y();
+        sample.heading = pose.Rotation().Radians();
+        sample.vx = speeds.vx;
+        sample.vy = speeds.vy;
+        sample.omega = speeds.omega;
+
+        // Module forces are field-relative too
+        auto &forcesX = sample.moduleForcesX;
+        auto &forcesY = sample.moduleForcesY;
+        if (FlippingUtil::symmetryType == FlippingUtil::kMirrored)
+        {
+            // A mirrored robot's left modules are the original's right ones
+            std::swap(forcesX[0], forcesX[1]);
+            std::swap(forcesX[2], forcesX[3]);
+            std::swap(forcesY[0], forcesY[1]);
+            std::swap(forcesY[2], forcesY[3]);
+            for (auto &force : forcesX)
+            {
+                force = -force;
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < forcesX.size(); ++i)
+            {
+                forcesX[i] = -forcesX[i];
+                forcesY[i] = -forcesY[i];
+            }
+        }
+        return sample;
+    }
+}  // namespace
+
 SwerveDrive::SwerveDrive(const SwerveDrivetrainConstants &driveConstants,
                          hertz_t updateRate,
                          std::array<double, 3> const &odometryStandardDeviation,
                          std::array<double, 3> const &visionStandardDeviation,
+                         VisionFusionConfig const &visionFusionConfig,
                          PIDConstants translationPID, PIDConstants rotationPID,
                          units::meters_per_second_t maxTranslationSpeed,
                          units::radians_per_second_t maxRotationSpeed,
@@ -31,11 +94,24 @@ SwerveDrive::SwerveDrive(const SwerveDrivetrainConstants &driveConstants,
                        visionStandardDeviation, frontLeftConstants,
                        frontRightConstants, rearLeftConstants,
                        rearRightConstants),
+      vision(visionFusionConfig),
+      simKinematics(Translation2d{frontLeftConstants.LocationX,
+                                  frontLeftConstants.LocationY},
+                    Translation2d{frontRightConstants.LocationX,
+                                  frontRightConstants.LocationY},
+                    Translation2d{rearLeftConstants.LocationX,
+                                  rearLeftConstants.LocationY},
+                    Translation2d{rearRightConstants.LocationX,
+                                  rearRightConstants.LocationY}),
       maxTranslationSpeed(maxTranslationSpeed),
       maxRotationSpeed(maxRotationSpeed)
 {
+    cycleSamples.reserve(odometrySamples.Capacity());
     ConfigurePathplanner(translationPID, rotationPID);
     ConfigureChoreo(translationPID, rotationPID);
+    StartOdometryCapture();
+    // Until Periodic() reads the first update from the odometry thread
+    snapshot = CaptureSample(GetState());
     if (utils::IsSimulation())
     {
         StartSimThread();
@@ -47,8 +123,8 @@ void SwerveDrive::ConfigurePathplanner(PIDConstants translationPID,
 {
     auto config = RobotConfig::fromGUISettings();
     AutoBuilder::configure(
-        [this]() { return GetState().Pose; }, [this](const Pose2d &pose)
-        { ResetPose(pose); }, [this]() { return GetState().Speeds; },
+        [this]() { return snapshot.pose; }, [this](const Pose2d &pose)
+        { ResetPose(pose); }, [this]() { return snapshot.speeds; },
         [this](const ChassisSpeeds &speeds,
                const DriveFeedforwards &feedforwards)
         {
@@ -59,32 +135,94 @@ void SwerveDrive::ConfigurePathplanner(PIDConstants translationPID,
                                feedforwards.robotRelativeForcesY));
         },
         make_shared<PPHolonomicDriveController>(translationPID, rotationPID),
-        std::move(config),
-        []
+        std::move(config), IsRedAlliance, this);
+}
+
+void SwerveDrive::StartOdometryCapture()
+{
+    // Runs on CTRE's odometry thread with the drivetrain state locked, so it
+    // only copies the state out: no locks, no allocation
+    RegisterTelemetry(
+        [this](SwerveDriveState const &state)
         {
-            auto const alliance = DriverStation::GetAlliance().value_or(
-                DriverStation::Alliance::kBlue);
-            return alliance == DriverStation::Alliance::kRed;
-        },
-        this);
+            auto const sample = CaptureSample(state);
+            odometrySamples.TryPush(sample);
+            latestOdometry.Store(sample);
+        });
+}
+
+SwerveDrive::OdometrySample SwerveDrive::CaptureSample(
+    SwerveDriveState const &state)
+{
+    OdometrySample sample;
+    // CTRE stamps states with its own clock; the sample's age carries over
+    // to WPILib's
+    auto const age = utils::GetCurrentTime() - state.Timestamp;
+    sample.timestamp = static_cast<int64_t>(wpi::Now()) -
+                       static_cast<int64_t>(age.value() * 1e6);
+    sample.pose = state.Pose;
+    sample.speeds = state.Speeds;
+    std::copy_n(
+        state.ModuleStates.begin(),
+        std::min(state.ModuleStates.size(), sample.moduleStates.size()),
+        sample.moduleStates.begin());
+    std::copy_n(
+        state.ModulePositions.begin(),
+        std::min(state.ModulePositions.size(), sample.modulePositions.size()),
+        sample.modulePositions.begin());
+    sample.odometryPeriod = state.OdometryPeriod;
+    return sample;
 }
 
 void SwerveDrive::StartSimThread()
 {
-    lastSimTime = utils::GetCurrentTime();
+    // WPILib's clock rather than CTRE's, so the physics follows simulated
+    // time when it is paused and stepped (log replay)
+    lastSimTime = Timer::GetFPGATimestamp();
     simNotifier = make_unique<frc::Notifier>(
         [this]
         {
-            units::second_t const currentTime = utils::GetCurrentTime();
+            units::second_t const currentTime = Timer::GetFPGATimestamp();
             auto const deltaTime = currentTime - lastSimTime;
             lastSimTime = currentTime;
 
             /* use the measured time delta, get battery voltage from WPILib */
             UpdateSimState(deltaTime, RobotController::GetBatteryVoltage());
+            UpdateSimPose();
+
+            // Safe from this thread: it is staged and written at the next
+            // flush, stamped with this thread's time
+            nfr::logger["drive/sim/period"] << deltaTime;
         });
     simNotifier->StartPeriodic(kSimLoopPeriod);
 }
 
+void SwerveDrive::UpdateSimPose()
+{
+    auto const state = GetState();
+    wpi::array<frc::SwerveModulePosition, 4> positions{wpi::empty_array};
+    std::copy_n(state.ModulePositions.begin(),
+                std::min(state.ModulePositions.size(), positions.size()),
+                positions.begin());
+
+    scoped_lock lock{simPoseMutex};
+    if (simOdometry)
+    {
+        simOdometry->Update(state.RawHeading, positions);
+    }
+    else
+    {
+        simOdometry.emplace(simKinematics, state.RawHeading, positions,
+                            simStartPose);
+    }
+}
+
+Pose2d SwerveDrive::GetSimulatedPose() const
+{
+    scoped_lock lock{simPoseMutex};
+    return simOdometry ? simOdometry->GetPose() : simStartPose;
+}
+
 void SwerveDrive::ConfigureChoreo(PIDConstants translationPID,
                                   PIDConstants rotationPID)
 {
@@ -98,9 +236,16 @@ void SwerveDrive::ConfigureChoreo(PIDConstants translationPID,
 }
 
 void SwerveDrive::FollowTrajectory(const SwerveSample &sample)
+{
+    FollowTrajectory(TrajectorySample{
+        sample.timestamp, sample.x, sample.y, sample.heading, sample.vx,
+        sample.vy, sample.omega, sample.moduleForcesX, sample.moduleForcesY});
+}
+
+void SwerveDrive::FollowTrajectory(const TrajectorySample &sample)
 {
     // Get current robot position from odometry
-    const auto &pose = GetState().Pose;
+    const auto &pose = snapshot.pose;
 
     // Calculate correction velocities using PID controllers
     // PID controllers automatically correct errors between where we are vs
@@ -130,6 +275,133 @@ void SwerveDrive::FollowTrajectory(const SwerveSample &sample)
                       headingFeedback + sample.omega}));
 }
 
+CommandPtr SwerveDrive::FollowCachedTrajectory(
+    const CachedTrajectory &trajectory, bool fromAllianceStart)
+{
+    // Shared by the lambdas below, so they stay copyable
+    struct Progress
+    {
+        TrajectoryCursor cursor;
+        Timer timer;
+        bool flip = false;
+    };
+    auto progress =
+        make_shared<Progress>(Progress{TrajectoryCursor{trajectory}, Timer{}});
+    auto follow = [this, progress]
+    {
+        auto const sample = progress->cursor.Sample(progress->timer.Get());
+        FollowTrajectory(progress->flip ? FlippedToRed(sample) : sample);
+    };
+    auto start = [this, progress, &trajectory, fromAllianceStart]
+    {
+        progress->cursor.Reset();
+        if (fromAllianceStart && !trajectory.Empty())
+        {
+            // The alliance is only known for sure once autonomous starts
+            progress->flip = IsRedAlliance();
+            auto first = trajectory[0];
+            if (progress->flip)
+            {
+                first = FlippedToRed(first);
+            }
+            ResetPose(Pose2d{first.x, first.y, Rotation2d{first.heading}});
+        }
+        progress->timer.Restart();
+    };
+    auto finished = [progress, &trajectory]
+    { return progress->timer.HasElapsed(trajectory.TotalTime()); };
+    return Run(follow)
+        .BeforeStarting(start)
+        .Until(finished)
+        .WithName("FollowCachedTrajectory");
+}
+
+CommandPtr SwerveDrive::DriveToPose(const NavGrid &grid, Pose2d goal,
+                                    PathConstraints constraints)
+{
+    // Shared by the lambdas below; the search fills it in on its own thread
+    struct Plan
+    {
+        explicit Plan(const NavGrid &grid) : pathfinder(grid) {}
+
+        Pathfinder pathfinder;
+        vector<Translation2d> waypoints;
+        optional<CachedTrajectory> trajectory;
+        optional<TrajectoryCursor> cursor;
+        Timer timer;
+        bool failed = false;
+        // Last, so destroying the plan waits for a search still using it
+        future<optional<CachedTrajectory>> search;
+    };
+    auto plan = make_shared<Plan>(grid);
+
+    auto start = [this, plan, grid = &grid, goal, constraints]
+    {
+        // Interrupted and restarted mid-search: one search at a time
+        if (plan->search.valid())
+        {
+            plan->search.wait();
+        }
+        plan->trajectory.reset();
+        plan->cursor.reset();
+        plan->failed = false;
+        Pose2d pose = snapshot.pose;
+        // Searching and smoothing take well under a millisecond, but still
+        // stay off the robot loop
+        plan->search = async(
+            launch::async,
+            [plan = plan.get(), grid, pose, goal,
+             constraints]() -> optional<CachedTrajectory>
+            {
+                if (!plan->pathfinder.FindPath(pose.Translation(),
+                                               goal.Translation(),
+                                               plan->waypoints))
+                {
+                    return nullopt;
+                }
+                return ToTrajectory(*grid, plan->waypoints,
+                                    pose.Rotation(), goal.Rotation(),
+                                    constraints);
+            });
+    };
+    auto follow = [this, plan]
+    {
+        if (!plan->trajectory && !plan->failed)
+        {
+            if (plan->search.wait_for(chrono::seconds::zero()) !=
+                future_status::ready)
+            {
+                // Hold still until there is a path
+                SetControl(choreo.follower.WithSpeeds(ChassisSpeeds{}));
+                return;
+            }
+            plan->trajectory = plan->search.get();
+            if (!plan->trajectory)
+            {
+                cerr << "DriveToPose: no path to the goal" << endl;
+                plan->failed = true;
+                return;
+            }
+            plan->cursor.emplace(*plan->trajectory);
+            plan->timer.Restart();
+        }
+        if (plan->cursor)
+        {
+            FollowTrajectory(plan->cursor->Sample(plan->timer.Get()));
+        }
+    };
+    auto finished = [plan]
+    {
+        return plan->failed ||
+               (plan->trajectory &&
+                plan->timer.HasElapsed(plan->trajectory->TotalTime()));
+    };
+    return Run(follow)
+        .BeforeStarting(start)
+        .Until(finished)
+        .WithName("DriveToPose");
+}
+
 CommandPtr SwerveDrive::GetSysIdRoutine()
 {
     // System Identification (SysId) is a process that automatically
@@ -169,6 +441,34 @@ void SwerveDrive::Periodic()
 {
     // This method runs every 20ms automatically
 
+    // Take this cycle's snapshot; until the odometry thread has published
+    // an update, keep the one from construction
+    if (auto latest = latestOdometry.Load(); latest.timestamp != 0)
+    {
+        snapshot = latest;
+    }
+
+    // Every odometry update since last cycle: logged by Log(), and the
+    // history vision observations are checked against
+    cycleSamples.clear();
+    odometrySamples.Drain(
+        [this](const OdometrySample &sample)
+        {
+            cycleSamples.push_back(sample);
+            vision.AddOdometry(
+                microsecond_t{static_cast<double>(sample.timestamp)},
+                sample.pose);
+        });
+
+    // Fuse this cycle's camera frames in the order they were captured
+    for (const auto &measurement :
+         vision.Process(Timer::GetFPGATimestamp()))
+    {
+        SwerveDrivetrain::AddVisionMeasurement(
+            measurement.pose, utils::FPGAToCurrentTime(measurement.timestamp),
+            measurement.standardDeviations);
+    }
+
     // When robot is disabled, set the field orientation based on alliance color
     // This ensures "forward" points toward the correct goal
     if (DriverStation::IsDisabled())
@@ -193,6 +493,26 @@ void SwerveDrive::AddVisionMeasurement(Pose2d pose, second_t timestamp)
                                            utils::FPGAToCurrentTime(timestamp));
 }
 
+void SwerveDrive::ResetPose(Pose2d const &pose)
+{
+    SwerveDrivetrain::ResetPose(pose);
+    vision.Reset();
+    {
+        // In simulation, resetting the pose moves the robot too
+        scoped_lock lock{simPoseMutex};
+        simOdometry.reset();
+        simStartPose = pose;
+    }
+
+    // Anything reading the pose before the odometry thread's next update
+    // (later this cycle, or the next few stepped cycles in replay) gets the
+    // new one
+    snapshot.pose = pose;
+    auto latest = latestOdometry.Load();
+    latest.pose = pose;
+    latestOdometry.Store(latest);
+}
+
 void SwerveDrive::SetModuleOffsets(const std::array<Rotation2d, 4> &offsets)
 {
     // Apply calibration offsets to each swerve module
@@ -312,16 +632,50 @@ CommandPtr SwerveDrive::DriveByJoystick(function<double()> xAxis,
 void SwerveDrive::Log(const nfr::LogContext &log) const
 {
     // Log robot position and orientation on the field
-    log["pose"] << GetState().Pose;
+    log["pose"] << snapshot.pose;
 
     // Log current robot velocity (how fast it's moving in each direction)
-    log["speeds"] << GetState().Speeds;
+    log["speeds"] << snapshot.speeds;
 
     // Calculate and log overall speed magnitude
     // This gives a single number for "how fast is the robot moving overall?"
-    auto vx = GetState().Speeds.vx;  // Velocity in X direction
-    auto vy = GetState().Speeds.vy;  // Velocity in Y direction
+    auto vx = snapshot.speeds.vx;  // Velocity in X direction
+    auto vy = snapshot.speeds.vy;  // Velocity in Y direction
     auto speed =
         math::sqrt(vx * vx + vy * vy);  // Pythagorean theorem: total speed
     log["speed"] << speed;
+
+    log["vision"] << vision;
+
+    // Every odometry update this cycle, at the time it happened
+    auto odometry = log["odometry"];
+    if (!odometry)
+    {
+        return;
+    }
+    auto *logger = odometry.GetLogger();
+    auto pose = odometry["pose"];
+    auto speeds = odometry["speeds"];
+    auto moduleStates = odometry["module_states"];
+    auto modulePositions = odometry["module_positions"];
+    auto period = odometry["period"];
+    // Each update is only logged once, so WPILog's decimation would throw
+    // most of them away
+    for (auto key : std::array{pose.GetKey(), speeds.GetKey(),
+                               moduleStates.GetKey(),
+                               modulePositions.GetKey(), period.GetKey()})
+    {
+        logger->KeepEvery(key);
+    }
+    for (const auto &sample : cycleSamples)
+    {
+        logger->BeginSample(sample.timestamp);
+        pose << sample.pose;
+        speeds << sample.speeds;
+        moduleStates << sample.moduleStates;
+        modulePositions << sample.modulePositions;
+        period << sample.odometryPeriod;
+        logger->EndSample();
+    }
+    odometry["dropped"] << static_cast<long>(odometrySamples.Dropped());
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "trajectory/CachedTrajectory.h"
+
+#include <wpi/fs.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+using namespace nfr;
+using namespace std;
+
+// Saved trajectories are built on a desktop and mapped on the roboRIO;
+// both are little-endian, so the doubles are stored as they are in memory
+static_assert(endian::native == endian::little);
+
+namespace
+{
+    constexpr char kMagic[8] = {'N', 'F', 'R', 'T', 'R', 'A', 'J', 0};
+    constexpr uint32_t kVersion = 1;
+
+    /** @brief What a saved trajectory starts with */
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t columns;
+        uint64_t samples;
+    };
+    static_assert(sizeof(Header) == 24);
+    // The columns start right after the header, so must stay aligned
+    static_assert(sizeof(Header) % alignof(double) == 0);
+
+    double Lerp(double a, double b, double fraction)
+    {
+        return a + (b - a) * fraction;
+    }
+
+    /** @brief How far a time is from sample `index` to the next one */
+    double Fraction(span<const double> times, size_t index, double t)
+    {
+        double gap = times[index + 1] - times[index];
+        return gap > 0 ? (t - times[index]) / gap : 0;
+    }
+
+    /** @brief Interpolates an angle the short way around */
+    double LerpAngle(double a, double b, double fraction)
+    {
+        return a + remainder(b - a, 2 * numbers::pi) * fraction;
+    }
+}  // namespace
+
+CachedTrajectory::CachedTrajectory(span<const TrajectorySample> samples)
+    : size(samples.size()), owned(kColumnCount * samples.size())
+{
+    data = owned.data();
+    auto column = [&](size_t c) { return owned.data() + c * size; };
+    for (size_t i = 0; i < size; ++i)
+    {
+        const auto& sample = samples[i];
+        if (i > 0 && sample.timestamp < samples[i - 1].timestamp)
+        {
+            throw invalid_argument("Trajectory timestamps must not decrease");
+        }
+        column(kTime)[i] = sample.timestamp.value();
+        column(kX)[i] = sample.x.value();
+        column(kY)[i] = sample.y.value();
+        column(kHeading)[i] = sample.heading.value();
+        column(kVx)[i] = sample.vx.value();
+        column(kVy)[i] = sample.vy.value();
+        column(kOmega)[i] = sample.omega.value();
+        for (size_t module = 0; module < 4; ++module)
+        {
+            column(kModuleForceX + module)[i] =
+                sample.moduleForcesX[module].value();
+            column(kModuleForceY + module)[i] =
+                sample.moduleForcesY[module].value();
+        }
+    }
+}
+
+CachedTrajectory::CachedTrajectory(CachedTrajectory&& other) noexcept
+    : data(exchange(other.data, nullptr)),
+      size(exchange(other.size, 0)),
+      owned(std::move(other.owned)),
+      region(std::move(other.region))
+{
+}
+
+CachedTrajectory& CachedTrajectory::operator=(CachedTrajectory&& other) noexcept
+{
+    data = exchange(other.data, nullptr);
+    size = exchange(other.size, 0);
+    owned = std::move(other.owned);
+    region = std::move(other.region);
+    return *this;
+}
+
+CachedTrajectory CachedTrajectory::Map(const string& path)
+{
+    error_code ec;
+    uint64_t fileSize = fs::file_size(path, ec);
+    if (ec)
+    {
+        throw runtime_error("Could not open trajectory: " + path + " (" +
+                            ec.message() + ")");
+    }
+    if (fileSize < sizeof(Header))
+    {
+        throw runtime_error("Not a saved trajectory: " + path);
+    }
+
+    fs::file_t file = fs::OpenFileForRead(path, ec);
+    if (ec)
+    {
+        throw runtime_error("Could not open trajectory: " + path + " (" +
+                            ec.message() + ")");
+    }
+    CachedTrajectory trajectory;
+    trajectory.region = wpi::MappedFileRegion{
+        file, fileSize, 0, wpi::MappedFileRegion::kReadOnly, ec};
+    // The mapping stays valid after the file is closed
+    fs::CloseFile(file);
+    if (ec)
+    {
+        throw runtime_error("Could not map trajectory: " + path + " (" +
+                            ec.message() + ")");
+    }
+
+    Header header;
+    memcpy(&header, trajectory.region.const_data(), sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.columns != kColumnCount)
+    {
+        throw runtime_error(
+            "Not a saved trajectory (or unsupported version): " + path);
+    }
+    if (fileSize !=
+        sizeof(Header) + header.samples * kColumnCount * sizeof(double))
+    {
+        throw runtime_error("Truncated trajectory: " + path);
+    }
+    trajectory.size = header.samples;
+    trajectory.data = reinterpret_cast<const double*>(
+        trajectory.region.const_data() + sizeof(Header));
+    return trajectory;
+}
+
+void CachedTrajectory::Save(const string& path) const
+{
+    Header header{};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.columns = kColumnCount;
+    header.samples = size;
+
+    ofstream out{path, ios::binary | ios::trunc};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(data),
+              static_cast<streamsize>(size * kColumnCount * sizeof(double)));
+    out.close();
+    if (!out)
+    {
+        throw runtime_error("Could not write trajectory: " + path);
+    }
+}
+
+TrajectorySample CachedTrajectory::operator[](size_t index) const
+{
+    return Interpolate(index, 0);
+}
+
+TrajectorySample CachedTrajectory::Interpolate(size_t index,
+                                               double fraction) const
+{
+    size_t next = min(index + 1, size - 1);
+    auto value = [&](size_t column)
+    {
+        auto values = Values(column);
+        return Lerp(values[index], values[next], fraction);
+    };
+    auto headings = Values(kHeading);
+
+    TrajectorySample sample;
+    sample.timestamp = units::second_t{value(kTime)};
+    sample.x = units::meter_t{value(kX)};
+    sample.y = units::meter_t{value(kY)};
+    sample.heading = units::radian_t{
+        LerpAngle(headings[index], headings[next], fraction)};
+    sample.vx = units::meters_per_second_t{value(kVx)};
+    sample.vy = units::meters_per_second_t{value(kVy)};
+    sample.omega = units::radians_per_second_t{value(kOmega)};
+    for (size_t module = 0; module < 4; ++module)
+    {
+        sample.moduleForcesX[module] =
+            units::newton_t{value(kModuleForceX + module)};
+        sample.moduleForcesY[module] =
+            units::newton_t{value(kModuleForceY + module)};
+    }
+    return sample;
+}
+
+TrajectorySample CachedTrajectory::Sample(units::second_t time) const
+{
+    if (Empty())
+    {
+        return {};
+    }
+    auto times = Values(kTime);
+    const double t = time.value();
+    auto after = static_cast<size_t>(
+        upper_bound(times.begin(), times.end(), t) - times.begin());
+    if (after == 0 || after == size)
+    {
+        return (*this)[after == 0 ? 0 : size - 1];
+    }
+    return Interpolate(after - 1, Fraction(times, after - 1, t));
+}
+
+TrajectorySample TrajectoryCursor::Sample(units::second_t time)
+{
+    if (trajectory->Empty())
+    {
+        return {};
+    }
+    auto times = trajectory->Values(CachedTrajectory::kTime);
+    const double t = time.value();
+    if (t < times[index])
+    {
+        // Went back in time: search for where to walk on from
+        auto after = upper_bound(times.begin(), times.end(), t);
+        if (after == times.begin())
+        {
+            index = 0;
+            return (*trajectory)[0];
+        }
+        index = static_cast<size_t>(after - times.begin()) - 1;
+    }
+    if (t >= times.back())
+    {
+        index = times.size() - 1;
+        return (*trajectory)[index];
+    }
+    // Usually zero or one step at 50 Hz
+    while (times[index + 1] <= t)
+    {
+        ++index;
+    }
+    return trajectory->Interpolate(index, Fraction(times, index, t));
+}
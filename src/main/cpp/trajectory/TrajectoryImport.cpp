@@ -0,0 +1,133 @@
+#include "trajectory/TrajectoryImport.h"
+
+#include <choreo/Choreo.h>
+#include <frc/Filesystem.h>
+#include <pathplanner/lib/config/RobotConfig.h>
+#include <pathplanner/lib/path/PathPlannerPath.h>
+#include <wpi/fs.h>
+
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /** @brief <deploy>/<directory>/<name><extension> */
+    string DeployPath(string_view directory, string_view name,
+                      string_view extension)
+    {
+        return (fs::path{frc::filesystem::GetDeployDirectory()} / directory /
+                (string{name} + string{extension}))
+            .string();
+    }
+}  // namespace
+
+CachedTrajectory nfr::FromChoreo(
+    const choreo::Trajectory<choreo::SwerveSample>& trajectory)
+{
+    vector<TrajectorySample> samples;
+    samples.reserve(trajectory.samples.size());
+    for (const auto& sample : trajectory.samples)
+    {
+        samples.push_back({sample.timestamp, sample.x, sample.y,
+                           sample.heading, sample.vx, sample.vy, sample.omega,
+                           sample.moduleForcesX, sample.moduleForcesY});
+    }
+    return CachedTrajectory{samples};
+}
+
+CachedTrajectory nfr::FromPathPlanner(
+    pathplanner::PathPlannerTrajectory trajectory)
+{
+    const auto& states = trajectory.getStates();
+    vector<TrajectorySample> samples;
+    samples.reserve(states.size());
+    for (const auto& state : states)
+    {
+        TrajectorySample sample;
+        sample.timestamp = state.time;
+        sample.x = state.pose.X();
+        sample.y = state.pose.Y();
+        sample.heading = state.pose.Rotation().Radians();
+        sample.vx = state.fieldSpeeds.vx;
+        sample.vy = state.fieldSpeeds.vy;
+        sample.omega = state.fieldSpeeds.omega;
+
+        const auto& forcesX = state.feedforwards.robotRelativeForcesX;
+        const auto& forcesY = state.feedforwards.robotRelativeForcesY;
+        const auto& rotation = state.pose.Rotation();
+        for (size_t module = 0;
+             module < 4 && module < forcesX.size() && module < forcesY.size();
+             ++module)
+        {
+            sample.moduleForcesX[module] =
+                forcesX[module] * rotation.Cos() -
+                forcesY[module] * rotation.Sin();
+            sample.moduleForcesY[module] =
+                forcesX[module] * rotation.Sin() +
+                forcesY[module] * rotation.Cos();
+        }
+        samples.push_back(sample);
+    }
+    return CachedTrajectory{samples};
+}
+
+optional<CachedTrajectory> nfr::ConvertTrajectory(string_view name)
+{
+    // Checked first, as Choreo reports a missing file as an error and
+    // PathPlanner throws
+    if (fs::exists(DeployPath("choreo", name, ".traj")))
+    {
+        if (auto trajectory =
+                choreo::Choreo::LoadTrajectory<choreo::SwerveSample>(name))
+        {
+            return FromChoreo(*trajectory);
+        }
+        return nullopt;
+    }
+    if (!fs::exists(DeployPath("pathplanner/paths", name, ".path")))
+    {
+        cerr << "No trajectory named " << name << endl;
+        return nullopt;
+    }
+    try
+    {
+        auto path = pathplanner::PathPlannerPath::fromPathFile(string{name});
+        auto trajectory = path->getIdealTrajectory(
+            pathplanner::RobotConfig::fromGUISettings());
+        if (!trajectory)
+        {
+            cerr << "PathPlanner could not generate " << name << endl;
+            return nullopt;
+        }
+        return FromPathPlanner(std::move(*trajectory));
+    }
+    catch (const exception& e)
+    {
+        cerr << "Could not load path " << name << ": " << e.what() << endl;
+        return nullopt;
+    }
+}
+
+optional<CachedTrajectory> nfr::LoadTrajectory(string_view name)
+{
+    auto path = DeployPath(kTrajectoryCacheDirectory, name,
+                           CachedTrajectory::kExtension);
+    if (fs::exists(path))
+    {
+        try
+        {
+            return CachedTrajectory::Map(path);
+        }
+        catch (const exception& e)
+        {
+            // Probably saved by an older build; the source is still there
+            cerr << e.what() << endl;
+        }
+    }
+    return ConvertTrajectory(name);
+}
@@ -0,0 +1,86 @@
+#include "vision/SimulatedCamera.h"
+
+#include <units/math.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+using namespace nfr;
+using namespace std;
+using namespace units;
+
+SimulatedCamera::SimulatedCamera(const SimulatedCameraConfig& config,
+                                 vector<frc::Pose2d> tags, uint64_t seed)
+    : config(config), tags(std::move(tags)), random(seed)
+{
+}
+
+optional<VisionObservation> SimulatedCamera::Update(
+    second_t now, const frc::Pose2d& truePose)
+{
+    if (auto frame = Capture(now, truePose))
+    {
+        inFlight.push_back(*frame);
+    }
+    if (inFlight.empty() || inFlight.front().timestamp + config.latency > now)
+    {
+        return nullopt;
+    }
+    auto frame = inFlight.front();
+    inFlight.pop_front();
+    return frame;
+}
+
+optional<VisionObservation> SimulatedCamera::Capture(
+    second_t now, const frc::Pose2d& truePose)
+{
+    auto camera = truePose.TransformBy(config.robotToCamera);
+    int tagCount = 0;
+    meter_t totalDistance = 0_m;
+    for (const auto& tag : tags)
+    {
+        auto toTag = tag.Translation() - camera.Translation();
+        auto distance = toTag.Norm();
+        auto bearing = (toTag.Angle() - camera.Rotation()).Radians();
+        // Tags only face one way: the camera has to be in front of it
+        auto facing = (toTag.Angle() - tag.Rotation()).Radians();
+        if (distance > config.maxRange ||
+            math::abs(bearing) > config.fieldOfView / 2 ||
+            math::abs(facing) < radian_t{numbers::pi / 2})
+        {
+            continue;
+        }
+        ++tagCount;
+        totalDistance += distance;
+    }
+    if (tagCount == 0)
+    {
+        return nullopt;
+    }
+
+    VisionObservation observation;
+    observation.timestamp = now;
+    observation.tagCount = tagCount;
+    observation.averageTagDistance = totalDistance / tagCount;
+    observation.camera = config.id;
+
+    double distance = max(observation.averageTagDistance.value(), 1.0);
+    double scale = distance * distance / tagCount;
+    meter_t dx = config.translationNoise * scale * noise(random);
+    meter_t dy = config.translationNoise * scale * noise(random);
+    radian_t dtheta = config.rotationNoise * scale * noise(random);
+    if (uniform(random) < config.outlierRate)
+    {
+        // Somewhere else on the field entirely
+        double direction = uniform(random) * 2 * numbers::pi;
+        meter_t offset{2 + uniform(random) * 2};
+        dx += offset * std::cos(direction);
+        dy += offset * std::sin(direction);
+        dtheta += radian_t{uniform(random) * numbers::pi};
+    }
+    observation.pose = frc::Pose2d{truePose.X() + dx, truePose.Y() + dy,
+                                   truePose.Rotation().Radians() + dtheta};
+    return observation;
+}
@@ -0,0 +1,203 @@
+#include "vision/VisionFusion.h"
+
+#include <units/math.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "logging/Logger.h"
+
+using namespace nfr;
+using namespace std;
+using namespace units;
+
+namespace
+{
+    constexpr array<string_view, VisionFusion::kRejectionCount>
+        kRejectionNames = {"no_tags", "too_far", "stale", "disagrees",
+                           "unaligned"};
+}  // namespace
+
+VisionFusion::VisionFusion(const VisionFusionConfig& config)
+    : config(config), history(config.historyLength)
+{
+    if (config.queueSize == 0 || config.historyLength <= 0_s ||
+        config.realignAfter <= 0)
+    {
+        throw invalid_argument(
+            "Vision queue size, history length and realign count must be "
+            "positive");
+    }
+    pending.reserve(config.queueSize);
+    batch.reserve(config.queueSize);
+    accepted.reserve(config.queueSize);
+}
+
+bool VisionFusion::Submit(const VisionObservation& observation)
+{
+    scoped_lock lock{mutex};
+    if (pending.size() >= config.queueSize)
+    {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    pending.push_back(observation);
+    return true;
+}
+
+void VisionFusion::AddOdometry(second_t timestamp, const frc::Pose2d& pose)
+{
+    history.AddSample(timestamp, pose);
+}
+
+span<const VisionMeasurement> VisionFusion::Process(second_t now)
+{
+    // Hand the cameras the (empty) buffer from last cycle and take theirs
+    batch.clear();
+    {
+        scoped_lock lock{mutex};
+        swap(pending, batch);
+    }
+    // Each camera has its own latency, so frames arrive out of order
+    sort(batch.begin(), batch.end(),
+         [](const VisionObservation& a, const VisionObservation& b)
+         { return a.timestamp < b.timestamp; });
+
+    accepted.clear();
+    for (const auto& observation : batch)
+    {
+        if (auto rejection = Check(observation, now))
+        {
+            ++stats.rejected[*rejection];
+            lastRejected = observation.pose;
+            continue;
+        }
+        ++stats.accepted;
+        lastAccepted = observation.pose;
+        accepted.push_back({observation.timestamp, observation.pose,
+                            StandardDeviations(observation)});
+    }
+    return accepted;
+}
+
+void VisionFusion::Reset()
+{
+    history.Clear();
+    aligned = false;
+    disagreements = 0;
+}
+
+optional<VisionFusion::Rejection> VisionFusion::Check(
+    const VisionObservation& observation, second_t now)
+{
+    if (observation.tagCount <= 0)
+    {
+        return kNoTags;
+    }
+    if (observation.averageTagDistance > config.maxTagDistance)
+    {
+        return kTooFar;
+    }
+    const auto& odometry = history.GetInternalBuffer();
+    if (odometry.empty() || observation.timestamp < odometry.front().first ||
+        observation.timestamp > now)
+    {
+        return kStale;
+    }
+    if (!aligned && observation.tagCount <= 1)
+    {
+        // Odometry can't be trusted to check against yet, so only trust a
+        // pose solved from several tags, which can't be a mirror-image
+        // misread
+        return kUnaligned;
+    }
+
+    // Where odometry had the robot when the frame was captured
+    auto expected = history.Sample(observation.timestamp);
+    if (!expected)
+    {
+        return kStale;
+    }
+    auto translationError =
+        observation.pose.Translation().Distance(expected->Translation());
+    auto rotationError =
+        math::abs((observation.pose.Rotation() - expected->Rotation())
+                      .Radians());
+    if (translationError > config.maxTranslationError ||
+        rotationError > config.maxRotationError)
+    {
+        // The estimator only moves part of the way toward each measurement,
+        // so odometry that started far off takes a few frames to catch up;
+        // until one agrees with it, keep letting multi-tag frames through
+        if (aligned && !LostOdometry(observation, *expected))
+        {
+            return kDisagrees;
+        }
+        return nullopt;
+    }
+    aligned = true;
+    disagreements = 0;
+    return nullopt;
+}
+
+bool VisionFusion::LostOdometry(const VisionObservation& observation,
+                                const frc::Pose2d& expected)
+{
+    if (observation.tagCount <= 1)
+    {
+        return false;
+    }
+    // Misreads land anywhere; odometry knocked off by a collision is off
+    // by the same amount every frame
+    auto offset = observation.pose.Translation() - expected.Translation();
+    bool consistent = disagreements > 0 &&
+                      offset.Distance(disagreementOffset) <=
+                          config.maxTranslationError;
+    disagreements = consistent ? disagreements + 1 : 1;
+    disagreementOffset = offset;
+    if (disagreements < config.realignAfter)
+    {
+        return false;
+    }
+    aligned = false;
+    disagreements = 0;
+    ++stats.realigned;
+    return true;
+}
+
+array<double, 3> VisionFusion::StandardDeviations(
+    const VisionObservation& observation) const
+{
+    const auto& base = observation.tagCount > 1
+                           ? config.multiTagStandardDeviation
+                           : config.singleTagStandardDeviation;
+    // Error grows with the square of the distance and shrinks with more
+    // tags; closer than 1 m isn't trusted any more than 1 m
+    double distance = max(observation.averageTagDistance.value(), 1.0);
+    double scale = distance * distance / observation.tagCount;
+    return {base[0] * scale, base[1] * scale, base[2] * scale};
+}
+
+VisionFusion::Stats VisionFusion::GetStats() const
+{
+    Stats current = stats;
+    current.dropped = dropped.load(memory_order_relaxed);
+    return current;
+}
+
+void VisionFusion::Log(const LogContext& log) const
+{
+    auto current = GetStats();
+    log["accepted"] << static_cast<long>(current.accepted);
+    auto rejected = log["rejected"];
+    for (size_t i = 0; i < kRejectionNames.size(); ++i)
+    {
+        rejected[kRejectionNames[i]] << static_cast<long>(current.rejected[i]);
+    }
+    log["dropped"] << static_cast<long>(current.dropped);
+    log["realigned"] << static_cast<long>(current.realigned);
+    log["accepted_pose"] << lastAccepted;
+    log["rejected_pose"] << lastRejected;
+}
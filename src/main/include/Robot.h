@@ -5,11 +5,14 @@
 #pragma once
 
 #include <frc/TimedRobot.h>
+#include <frc/Timer.h>
 #include <frc2/command/CommandPtr.h>
 
 #include <optional>
+#include <string>
 
 #include "RobotContainer.h"
+#include "perf/LoopTimer.h"
 
 /**
  * @brief Main robot class that manages all robot operations
@@ -106,7 +109,38 @@ public:
     /** @brief Runs once when test mode ends */
     void TestExit() override;
 
+protected:
+    /** @brief Subsystems and bindings, for tools that drive the robot */
+    RobotContainer& GetContainer()
+    {
+        return m_container;
+    }
+
 private:
+    /**
+     * @brief Starts a flight recorder dump on a low battery or when the
+     *        dashboard button is pressed
+     */
+    void CheckFlightRecorderTriggers();
+
+    /**
+     * @brief Applies the log level preferences when they change
+     *
+     * Lets the pits turn debug keys on or off from the dashboard without
+     * redeploying. Checked every LoggingConstants::kLogSettingsPeriod, not
+     * every cycle.
+     */
+    void UpdateLogVerbosity();
+
+    /**
+     * @brief Puts the competition bandwidth budget on NT logging once the
+     *        FMS is attached
+     *
+     * It stays on for the rest of the run, so dashboards don't jump back
+     * to full rate between matches on the field network.
+     */
+    void UpdateNTBudget();
+
     /**
      * @brief Stores the autonomous command while it's running
      *
@@ -124,4 +158,29 @@ private:
      * Think of it as the "brain" that connects everything together.
      */
     RobotContainer m_container;
+
+    /**
+     * @brief Timing of each phase of RobotPeriodic (logged under "perf")
+     *
+     * The phases are registered once here so timing them in the loop is
+     * just two clock reads.
+     */
+    nfr::LoopTimer m_loopTimer;
+    nfr::PhaseTimer& m_loopPhase = m_loopTimer.AddPhase("loop");
+    nfr::PhaseTimer& m_schedulerPhase = m_loopTimer.AddPhase("scheduler");
+    nfr::PhaseTimer& m_logPhase = m_loopTimer.AddPhase("log");
+    nfr::PhaseTimer& m_flushPhase = m_loopTimer.AddPhase("flush");
+
+    /** @brief Whether the battery was low last cycle (to dump only once) */
+    bool m_lowBattery = false;
+
+    /** @brief Whether NT logging has the competition budget yet */
+    bool m_ntBudgeted = false;
+
+    /** @brief Time since the log settings were last checked */
+    frc::Timer m_logSettingsTimer;
+
+    /** @brief Log level preferences as last seen (empty before the first) */
+    std::optional<std::string> m_logLevel;
+    std::optional<std::string> m_logRules;
 };
@@ -4,11 +4,19 @@
 
 #pragma once
 
+#include <frc/Notifier.h>
 #include <frc2/command/CommandPtr.h>
 #include <frc2/command/button/CommandXboxController.h>
 #include <logging/Logger.h>
 
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "pathfinding/NavGrid.h"
 #include "subsystems/drive/SwerveDrive.h"
+#include "trajectory/CachedTrajectory.h"
+#include "vision/SimulatedCamera.h"
 
 /**
  * @brief Container class that organizes all robot subsystems and controller
@@ -39,9 +47,9 @@ public:
      * @brief Gets the command to run during autonomous period
      *
      * This returns the autonomous command that should run during the 15-second
-     * autonomous period at the start of each match. Currently returns a simple
-     * "do nothing" command, but would normally return a complex autonomous
-     * routine.
+     * autonomous period at the start of each match: following
+     * AutoConstants::kTrajectory, or printing a message if it can't be
+     * loaded.
      *
      * @return CommandPtr to run during autonomous
      */
@@ -58,6 +66,15 @@ public:
      */
     void Log(const nfr::LogContext &log) const;
 
+    /**
+     * @brief Moves the drivetrain's odometry to a known pose
+     *
+     * Used by log replay to put the robot where the recorded one was.
+     *
+     * @param pose Field-relative pose to reset to
+     */
+    void ResetPose(const frc::Pose2d &pose);
+
 private:
     void LogRobotState(const nfr::LogContext &log) const;
     /**
@@ -70,6 +87,15 @@ private:
      */
     void ConfigureBindings();
 
+    /**
+     * @brief Starts simulated cameras feeding the drivetrain's vision fusion
+     *
+     * They see the AprilTags on the field from where the simulated robot
+     * actually is (odometry without vision) and run on their own thread,
+     * like real cameras would.
+     */
+    void StartVisionSim();
+
     /**
      * @brief Our robot's swerve drivetrain subsystem
      *
@@ -82,6 +108,32 @@ private:
      */
     std::unique_ptr<nfr::SwerveDrive> drive{nullptr};
 
+    /** @brief Cameras used in simulation (see StartVisionSim()) */
+    std::vector<nfr::SimulatedCamera> simCameras;
+
+    /**
+     * @brief Runs the simulated cameras
+     *
+     * Declared after them, so it is stopped before they are destroyed.
+     */
+    std::unique_ptr<frc::Notifier> visionSimNotifier;
+
+    /**
+     * @brief Obstacles on the field, inflated for driving to a pose
+     *
+     * Empty if the navgrid couldn't be loaded. Declared before the commands
+     * that use it.
+     */
+    std::optional<nfr::NavGrid> navGrid;
+
+    /**
+     * @brief Trajectory the autonomous command follows
+     *
+     * Kept here because the command samples it in place; loaded by the first
+     * GetAutonomousCommand().
+     */
+    std::optional<nfr::CachedTrajectory> autoTrajectory;
+
     /**
      * @brief Command to reset swerve module positions
      *
@@ -1,7 +1,21 @@
 #pragma once
 
+#include <frc/geometry/Pose2d.h>
+#include <frc/geometry/Transform2d.h>
 #include <pathplanner/lib/controllers/PPHolonomicDriveController.h>
 #include <units/frequency.h>
+#include <units/time.h>
+#include <units/voltage.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+#include "logging/LogBandwidthBudget.h"
+#include "pathfinding/Pathfinder.h"
+#include "vision/SimulatedCamera.h"
+#include "vision/VisionFusion.h"
 
 namespace nfr
 {
@@ -102,4 +116,206 @@ namespace nfr
         static constexpr pathplanner::PIDConstants kRotationPID =
             pathplanner::PIDConstants(0.1, 0.0, 0.0);
     };
+
+    /**
+     * @brief Configuration constants for fusing camera poses into odometry
+     *
+     * Cameras report where they think the robot is from the AprilTags they
+     * see. These values decide which of those reports are believed, and how
+     * much, before they correct the wheel-based position.
+     */
+    class VisionConstants
+    {
+    public:
+        /**
+         * @brief How camera observations are checked and weighted
+         *
+         * Standard deviations are for one tag 1 m away and grow with
+         * distance² / tag count. A single tag can't give a trustworthy
+         * heading, so its rotation is ignored (like
+         * DriveConstants::kVisionStandardDeviation). Observations more than
+         * 1 m or about 30° from where odometry had the robot are dropped,
+         * unless 5 multi-tag frames in a row agree on where it really is.
+         */
+        static constexpr VisionFusionConfig kFusion{
+            .singleTagStandardDeviation = {0.05, 0.05, 9999999},
+            .multiTagStandardDeviation = {0.02, 0.02, 0.05},
+            .maxTagDistance = 5_m,
+            .maxTranslationError = 1_m,
+            .maxRotationError = 0.5_rad,
+            .realignAfter = 5,
+            .historyLength = 1_s,
+            .queueSize = 32,
+        };
+
+        /** @brief How often simulated cameras take a frame (30 fps) */
+        static constexpr units::second_t kSimCameraPeriod = 33_ms;
+
+        /**
+         * @brief Cameras used in simulation: one facing forward, one back
+         *
+         * The back camera's frames are occasionally wrong, so the outlier
+         * rejection has something to reject.
+         */
+        static constexpr std::array<SimulatedCameraConfig, 2> kSimCameras{{
+            {.id = 0,
+             .robotToCamera = {frc::Translation2d{0.3_m, 0_m}, 0_deg},
+             .latency = 35_ms},
+            {.id = 1,
+             .robotToCamera = {frc::Translation2d{-0.3_m, 0_m}, 180_deg},
+             .latency = 50_ms,
+             .outlierRate = 0.05},
+        }};
+    };
+
+    /** @brief Configuration constants for the autonomous period */
+    class AutoConstants
+    {
+    public:
+        /**
+         * @brief Trajectory followed in autonomous (see LoadTrajectory())
+         *
+         * A Choreo trajectory or PathPlanner path from the deploy directory,
+         * by name. Its saved form is mapped when autonomous starts.
+         */
+        static constexpr std::string_view kTrajectory = "Example Path";
+    };
+
+    /**
+     * @brief Configuration constants for driving to a pose around obstacles
+     *
+     * Paths are searched on PathPlanner's navgrid (deploy/pathplanner/
+     * navgrid.json), whose obstacles are already drawn big enough for the
+     * robot's center to stay outside of them.
+     */
+    class PathfindingConstants
+    {
+    public:
+        /**
+         * @brief Extra room kept from the navgrid's obstacles
+         *
+         * Trajectories round their corners off, cutting a little inside
+         * them; this keeps that off the obstacles.
+         */
+        static constexpr units::meter_t kClearance = 0.3_m;
+
+        /** @brief Limits for driving to a pose */
+        static constexpr PathConstraints kConstraints{
+            .maxVelocity = DriveConstants::kMaxTranslationSpeed,
+            .maxAcceleration = 3_mps_sq,
+            .cornerRadius = 0.5_m,
+            .sampleSpacing = 0.05_m,
+        };
+
+        /** @brief Where the driver's A button drives to */
+        static constexpr frc::Pose2d kTargetPose{2.5_m, 4.0_m, 0_deg};
+    };
+
+    /**
+     * @brief Configuration constants for logging and the flight recorder
+     *
+     * The flight recorder keeps the last few seconds of every logged value
+     * in memory at full loop rate, and writes them to their own log file
+     * when something goes wrong. That lets the regular log file be written
+     * at a lower rate.
+     */
+    class LoggingConstants
+    {
+    public:
+        /**
+         * @brief Only every Nth value of each key goes to the regular log file
+         *
+         * 5 means 10 values per second at the 50 Hz loop rate. The flight
+         * recorder still has every value around faults.
+         */
+        static constexpr unsigned kWPILogDecimation = 5;
+
+        /** @brief How much history each flight recorder dump contains */
+        static constexpr std::chrono::seconds kFlightRecorderWindow{10};
+
+        /** @brief Bytes of history the flight recorder keeps in memory */
+        static constexpr std::size_t kFlightRecorderCapacity = 4 << 20;
+
+        /**
+         * @brief Keys the flight recorder leaves out (comma-separated
+         *        prefixes)
+         *
+         * The 3D component poses are only for watching the robot in
+         * AdvantageScope; they tell nothing about a fault and would
+         * otherwise be computed every cycle just for the recorder.
+         */
+        static constexpr std::string_view kFlightRecorderExcludedKeys =
+            "robot/Robot3d";
+
+        /**
+         * @brief Battery voltage that triggers a flight recorder dump
+         *
+         * The roboRIO browns out at 6.8 V, so this fires just before motors
+         * start getting cut off.
+         */
+        static constexpr units::volt_t kLowBatteryVoltage = 7.0_V;
+
+        /** @brief SmartDashboard button that triggers a dump by hand */
+        static constexpr std::string_view kFlightRecorderButton =
+            "FlightRecorder/Dump";
+
+        /**
+         * @brief Preference overriding the log level ("debug", "info",
+         *        "critical" or "off")
+         *
+         * Empty means info at competitions and debug everywhere else.
+         */
+        static constexpr std::string_view kLogLevelPreference = "Logging/Level";
+
+        /**
+         * @brief Preference with per-prefix log levels, e.g.
+         *        `robot/Robot3d=off,perf=critical`
+         */
+        static constexpr std::string_view kLogRulesPreference = "Logging/Rules";
+
+        /**
+         * @brief How often the log level preferences (and whether the FMS is
+         *        attached) are checked
+         *
+         * Reading preferences goes through NT and copies strings, which is
+         * too much to do every cycle for a setting changed by hand.
+         */
+        static constexpr units::second_t kLogSettingsPeriod = 1_s;
+
+        /**
+         * @brief NetworkTables bandwidth at competitions, in bytes per second
+         *
+         * The field caps each robot at 4 Mbit/s, shared with cameras and the
+         * driver station; this is about 8% of it.
+         */
+        static constexpr double kNTBytesPerSecond = 40'000;
+
+        /**
+         * @brief Per-prefix NT rates at competitions (see LogRateRules)
+         *
+         * The pose keeps its full rate and top priority for the dashboard
+         * field view; git metadata only needs publishing once. Console
+         * lines are events that are never logged again, so they are
+         * priority 0 too, which is never held back.
+         */
+        static constexpr std::string_view kNTRates =
+            "robot/drive/pose=50@0,robot/drive=10@1,robot/match_time=1@1,"
+            "robot/Robot3d=10@2,git=once@0,cerr=max@0,cout=max@0,perf=2@3,"
+            "logger=1@3";
+
+        /** @brief NT rate for keys kNTRates doesn't cover */
+        static constexpr LogRate kNTDefaultRate{.hz = 10, .priority = 2};
+
+        /**
+         * @brief Numeric keys summarized under "stats" (see LogStatistics)
+         *
+         * Comma-separated prefixes; each gets min/max/mean/stddev and
+         * percentiles once per kStatisticsWindow.
+         */
+        static constexpr std::string_view kStatisticsKeys =
+            "robot/drive/speed,drive/sim/period";
+
+        /** @brief How long each statistics summary covers */
+        static constexpr std::chrono::seconds kStatisticsWindow{1};
+    };
 }  // namespace nfr
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "logging/LogRingBuffer.h"
+#include "logging/LogStaging.h"
+
+namespace nfr
+{
+    /** @brief Counters that describe how well the writer thread keeps up */
+    struct AsyncLogStats
+    {
+        std::uint64_t queued = 0;   ///< Records accepted into the buffer
+        std::uint64_t dropped = 0;  ///< Records rejected because it was full
+        std::uint64_t written = 0;  ///< Records replayed into the sinks
+        std::size_t peakUsage = 0;  ///< Most bytes ever waiting at once
+        std::size_t capacity = 0;   ///< Size of the buffer in bytes
+    };
+
+    /**
+     * @brief Moves log records off the robot thread
+     *
+     * The robot thread encodes each value into a preallocated ring buffer and
+     * returns immediately. A dedicated writer thread wakes up periodically (or
+     * as soon as the buffer passes half full) and replays the records into
+     * the real sinks.
+     *
+     * ## Backpressure:
+     * The robot thread never waits. If the writer falls behind and the buffer
+     * fills up, new records are dropped and counted instead, so logging can
+     * never stall the control loop.
+     *
+     * ## Batches:
+     * Between BeginBatch() and EndBatch(), pushed records are held back and
+     * handed to the writer thread all at once, so it never sees half of a
+     * robot cycle.
+     *
+     * ## Other threads:
+     * Push() is for the robot thread only. Values logged from other threads
+     * go through a LogStaging, which the writer thread drains along with the
+     * ring buffer.
+     */
+    class AsyncLogWriter
+    {
+    public:
+        /**
+         * @param capacity Size of the ring buffer in bytes
+         * @param target Object passed to every record's replay function
+         * @param staging Other threads' buffers, also drained by the writer
+         */
+        AsyncLogWriter(std::size_t capacity, void* target,
+                       LogStaging* staging = nullptr);
+        AsyncLogWriter(const AsyncLogWriter&) = delete;
+        AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+        /** @brief Stops the writer thread after draining what is queued */
+        ~AsyncLogWriter();
+
+        /**
+         * @brief Queues one value for the writer thread (robot thread only)
+         *
+         * @return false if the record was dropped because the buffer is full
+         */
+        template <typename T>
+        bool Push(LogKey key, LogReplayFn replay, const T& value)
+        {
+            using Codec = LogRecordCodec<T>;
+            auto payload = ring.TryReserve(key, replay, Codec::Size(value));
+            if (payload.data() == nullptr)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                if (batching)
+                {
+                    // Let the writer make room instead of waiting for the
+                    // end of the batch
+                    Publish();
+                }
+                return false;
+            }
+            Codec::Encode(value, payload);
+            queued.fetch_add(1, std::memory_order_relaxed);
+            if (!batching)
+            {
+                Publish();
+            }
+            return true;
+        }
+
+        /** @brief Holds back pushed records until EndBatch() (robot thread) */
+        void BeginBatch()
+        {
+            batching = true;
+        }
+
+        /** @brief Hands the batch to the writer thread (robot thread) */
+        void EndBatch()
+        {
+            batching = false;
+            Publish();
+            Wake();
+        }
+
+        /** @brief Asks the writer thread to drain now instead of waiting */
+        void Wake();
+
+        /** @brief Snapshot of the queue counters */
+        AsyncLogStats GetStats() const;
+
+    private:
+        /** @brief Commits reserved records and wakes the writer if needed */
+        void Publish()
+        {
+            ring.Commit();
+            std::size_t used = ring.Used();
+            if (used > peakUsage.load(std::memory_order_relaxed))
+            {
+                peakUsage.store(used, std::memory_order_relaxed);
+            }
+            if (used > ring.Capacity() / 2)
+            {
+                Wake();
+            }
+        }
+
+        void Run();
+        /** @brief Replays everything queued so far (writer thread) */
+        void Drain();
+
+        LogRingBuffer ring;
+        void* target;
+        LogStaging* staging;
+        bool batching = false;  // Robot thread only
+
+        std::atomic<std::uint64_t> queued{0};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> written{0};
+        std::atomic<std::size_t> peakUsage{0};
+
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::atomic<bool> wakeRequested{false};
+        std::atomic<bool> running{true};
+        std::thread thread;
+    };
+}  // namespace nfr
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <wpi/DataLog.h>
+#include <wpi/timestamp.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "logging/LogKeyRegistry.h"
+#include "logging/LogRecord.h"
+#include "wpi/struct/Struct.h"
+
+namespace nfr
+{
+    /**
+     * @brief Log sink that remembers the last few seconds of every key and
+     *        writes them to a file when something goes wrong
+     *
+     * Every value is copied into a preallocated circular arena at full loop
+     * rate; once the arena is full the oldest values are overwritten. Nothing
+     * touches the disk until Trigger() is called (on a brownout, a crash, a
+     * dashboard button...). Then a background thread writes the values from
+     * the last `window` to a .wpilog file of its own, named after the time
+     * and the reason:
+     *
+     * ```
+     * /home/lvuser/logs/flight_20250315_184502_1_brownout.wpilog
+     * ```
+     *
+     * This lets the normal WPILog output run decimated while still keeping
+     * full detail around faults.
+     *
+     * Keys under the excluded prefixes are never recorded, and Wants() says
+     * so, letting the logger skip computing lazy values that only the
+     * recorder would have stored (like debug visualizations).
+     */
+    class FlightRecorder
+    {
+    public:
+        static constexpr std::string_view kName = "flight";
+
+        /**
+         * @param keys Registry used to name the entries in dumps
+         * @param window How much history a dump contains
+         * @param capacity Arena size in bytes; it should hold `window` of
+         *        logging at full rate
+         * @param excludedPrefixes Comma-separated key prefixes that are not
+         *        recorded, e.g. `robot/Robot3d`
+         * @param directory Where dumps are written (default: the
+         *        DataLogManager log directory)
+         */
+        explicit FlightRecorder(
+            const LogKeyRegistry& keys,
+            std::chrono::milliseconds window = std::chrono::seconds{10},
+            std::size_t capacity = 4 << 20,
+            std::string_view excludedPrefixes = {},
+            std::string directory = {});
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+        /** @brief Finishes any dump in progress */
+        ~FlightRecorder();
+
+        /** @brief Whether values of a key are recorded (any thread) */
+        bool Wants(LogKey key) const
+        {
+            return !Excluded(key);
+        }
+
+        void Log(LogKey key, double value, std::int64_t timestamp = 0)
+        {
+            Record(key, value, timestamp, "double", &DumpRecord<double>);
+        }
+        void Log(LogKey key, long value, std::int64_t timestamp = 0)
+        {
+            Record(key, value, timestamp, "int64", &DumpRecord<long>);
+        }
+        void Log(LogKey key, bool value, std::int64_t timestamp = 0)
+        {
+            Record(key, value, timestamp, "boolean", &DumpRecord<bool>);
+        }
+        void Log(LogKey key, const std::string_view& value,
+                 std::int64_t timestamp = 0)
+        {
+            Record(key, value, timestamp, "string",
+                   &DumpRecord<std::string_view>);
+        }
+        void Log(LogKey key, std::span<double> values,
+                 std::int64_t timestamp = 0)
+        {
+            Record(key, values, timestamp, "double[]",
+                   &DumpRecord<std::span<double>>);
+        }
+        void Log(LogKey key, std::span<long> values,
+                 std::int64_t timestamp = 0)
+        {
+            Record(key, values, timestamp, "int64[]",
+                   &DumpRecord<std::span<long>>);
+        }
+        void Log(LogKey key, std::span<bool> values,
+                 std::int64_t timestamp = 0)
+        {
+            Record(key, values, timestamp, "boolean[]",
+                   &DumpRecord<std::span<bool>>);
+        }
+        void Log(LogKey key, std::span<std::string_view> values,
+                 std::int64_t timestamp = 0)
+        {
+            Record(key, values, timestamp, "string[]",
+                   &DumpRecord<std::span<std::string_view>>);
+        }
+        template <typename T, typename... I>
+            requires wpi::StructSerializable<T, I...>
+        void Log(LogKey key, const T& value, std::int64_t timestamp = 0)
+        {
+            Record(key, value, timestamp, StructTypeString<T>(), &DumpRaw,
+                   &AddSchema<T>);
+        }
+        template <typename T, typename... I>
+            requires wpi::StructSerializable<T, I...>
+        void Log(LogKey key, std::span<T> values, std::int64_t timestamp = 0)
+        {
+            Record(key, values, timestamp, StructArrayTypeString<T>(),
+                   &DumpRaw, &AddSchema<T>);
+        }
+
+        /**
+         * @brief Starts writing the recorded history to a file
+         *
+         * Safe to call from any thread. The dump runs in the background;
+         * triggers that arrive while one is in progress are ignored.
+         *
+         * @param reason Short description used in the file name
+         * @return false if a dump was already in progress
+         */
+        bool Trigger(std::string_view reason);
+
+        /** @brief Blocks until the dump in progress (if any) is written */
+        void Wait();
+
+    private:
+        /** @brief Writes one recorded payload to the dump file */
+        using DumpFn = void (*)(wpi::log::DataLog& log, int entry,
+                                std::span<std::byte> payload,
+                                std::int64_t timestamp);
+        /** @brief Adds a struct type's schema to the dump file */
+        using SchemaFn = void (*)(wpi::log::DataLog& log);
+
+        /** @brief What is known about each key that has been logged */
+        struct Channel
+        {
+            std::string_view type;  // WPILog type string
+            DumpFn dump = nullptr;
+            SchemaFn addSchema = nullptr;
+        };
+
+        /** @brief Precedes every value in the arena */
+        struct alignas(16) Header
+        {
+            std::int64_t timestamp;  // kPadding for padding to the end
+            LogKey key;
+            std::uint32_t size;  // Payload bytes after this header
+        };
+        static constexpr std::int64_t kPadding = -1;
+
+        /** @brief Bytes taken by a record, keeping headers aligned */
+        static std::size_t RecordSize(std::size_t payloadSize)
+        {
+            return (sizeof(Header) + payloadSize + sizeof(Header) - 1) &
+                   ~(sizeof(Header) - 1);
+        }
+
+        template <typename T>
+        void Record(LogKey key, const T& value, std::int64_t timestamp,
+                    std::string_view type, DumpFn dump,
+                    SchemaFn addSchema = nullptr)
+        {
+            if (Excluded(key))
+            {
+                return;
+            }
+            std::scoped_lock lock{arenaMutex};
+            Channel& channel = GetChannel(key);
+            if (!channel.dump)
+            {
+                channel = {type, dump, addSchema};
+            }
+            else if (channel.type != type)
+            {
+                ThrowMismatch(key, channel.type, type);
+            }
+
+            if (timestamp == 0)
+            {
+                timestamp = static_cast<std::int64_t>(wpi::Now());
+            }
+            auto payload =
+                Reserve(key, timestamp, LogRecordCodec<T>::Size(value));
+            if (payload.data())
+            {
+                LogRecordCodec<T>::Encode(value, payload);
+            }
+        }
+
+        template <typename T>
+        static void DumpRecord(wpi::log::DataLog& log, int entry,
+                               std::span<std::byte> payload,
+                               std::int64_t timestamp)
+        {
+            LogRecordCodec<T>::Decode(
+                payload, [&](const auto& value)
+                { Append(log, entry, value, timestamp); });
+        }
+
+        /** @brief Struct payloads are already in their packed form */
+        static void DumpRaw(wpi::log::DataLog& log, int entry,
+                            std::span<std::byte> payload,
+                            std::int64_t timestamp);
+
+        template <typename T>
+        static void AddSchema(wpi::log::DataLog& log)
+        {
+            log.AddStructSchema<T>();
+        }
+
+        template <typename T>
+        static std::string_view StructTypeString()
+        {
+            static const std::string type =
+                "struct:" + std::string{wpi::GetStructTypeName<T>()};
+            return type;
+        }
+
+        template <typename T>
+        static std::string_view StructArrayTypeString()
+        {
+            static const std::string type =
+                "struct:" + std::string{wpi::GetStructTypeName<T>()} + "[]";
+            return type;
+        }
+
+        static void Append(wpi::log::DataLog& log, int entry, double value,
+                           std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry, long value,
+                           std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry, bool value,
+                           std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry,
+                           std::string_view value, std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry,
+                           std::span<double> values, std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry,
+                           std::span<long> values, std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry,
+                           std::span<bool> values, std::int64_t timestamp);
+        static void Append(wpi::log::DataLog& log, int entry,
+                           std::span<std::string_view> values,
+                           std::int64_t timestamp);
+
+        Channel& GetChannel(LogKey key)
+        {
+            if (key >= channels.size())
+            {
+                channels.resize(key + 1);
+            }
+            return channels[key];
+        }
+
+        enum Match : std::uint8_t
+        {
+            kUnknown,
+            kRecorded,
+            kExcluded,
+        };
+
+        bool Excluded(LogKey key) const;
+
+        [[noreturn]] void ThrowMismatch(LogKey key, std::string_view expected,
+                                        std::string_view actual) const;
+
+        /**
+         * @brief Makes room for a record, overwriting the oldest ones
+         *
+         * @return Payload span, or an empty span if the value is too big
+         *         to ever fit
+         */
+        std::span<std::byte> Reserve(LogKey key, std::int64_t timestamp,
+                                     std::size_t payloadSize);
+
+        Header* HeaderAt(std::uint64_t position)
+        {
+            return &arena[(position & mask) / sizeof(Header)];
+        }
+
+        /** @brief Dump thread: waits for triggers and writes dumps */
+        void Run();
+        void WriteDump(const std::string& reason);
+
+        const LogKeyRegistry& keys;
+        const std::chrono::milliseconds window;
+        const std::string directory;
+        std::vector<std::string> excludedPrefixes;
+
+        // Whether each key is excluded, indexed by LogKey. Sized for every
+        // possible key because Wants() can run on any thread.
+        std::unique_ptr<std::atomic<Match>[]> matches;
+
+        // Written by whichever thread drains the logger, copied by the dump
+        std::mutex arenaMutex;
+        std::unique_ptr<Header[]> arena;  // Header-sized blocks
+        std::size_t mask;
+        std::uint64_t head = 0;  // Positions only grow; index is & mask
+        std::uint64_t tail = 0;
+        std::vector<Channel> channels;  // Indexed directly by LogKey
+
+        // Dump thread only: the arena copied out so logging can continue
+        // while the file is written
+        std::unique_ptr<Header[]> snapshot;
+        std::vector<Channel> snapshotChannels;
+        std::uint64_t dumpCount = 0;
+
+        std::mutex triggerMutex;
+        std::condition_variable triggered;
+        std::condition_variable finished;
+        std::string pendingReason;  // Empty when no dump is in progress
+        bool running = true;
+        std::thread thread;
+    };
+}  // namespace nfr
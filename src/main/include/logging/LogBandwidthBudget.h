@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logging/LogKeyRegistry.h"
+
+namespace nfr
+{
+    /** @brief How often, and how urgently, a key may be published */
+    struct LogRate
+    {
+        static constexpr std::uint8_t kPriorities = 4;
+        static constexpr std::uint8_t kDefaultPriority = 1;
+
+        double hz = 0;      ///< Most updates per second, 0 for no limit
+        bool once = false;  ///< Only the first value is ever published
+        std::uint8_t priority = kDefaultPriority;  ///< 0 is most important
+    };
+
+    /**
+     * @brief Per-prefix rates, e.g. `robot/drive/pose=50@0,git=once`
+     *
+     * Each rule is `prefix=rate` or `prefix=rate@priority`, where rate is a
+     * number of updates per second, `once` or `max`, and priority goes from
+     * 0 (most important) to 3. Like LogLevelRules, a rule covers its key and
+     * everything under it, and the longest matching prefix wins.
+     */
+    class LogRateRules
+    {
+    public:
+        /**
+         * @brief Parses comma-separated rules
+         *
+         * @return nullopt if any rule is malformed
+         */
+        static std::optional<LogRateRules> Parse(std::string_view spec);
+
+        /** @brief Rate for a key path, or nullopt if no rule matches */
+        std::optional<LogRate> Find(std::string_view path) const;
+
+        bool Empty() const
+        {
+            return rules.empty();
+        }
+
+    private:
+        // Longest prefix first, so the first match is the one that applies
+        std::vector<std::pair<std::string, LogRate>> rules;
+    };
+
+    /**
+     * @brief How much of the network a sink may use
+     *
+     * Example:
+     * ```cpp
+     * LogBandwidthBudget budget;
+     * budget.bytesPerSecond = 40'000;
+     * budget.rates = *LogRateRules::Parse("robot/drive/pose=50@0,git=once");
+     * logger.EnableNTLogging("logs", {}, budget);
+     * ```
+     */
+    struct LogBandwidthBudget
+    {
+        double bytesPerSecond = 0;  ///< 0 for no cap
+        LogRateRules rates;         ///< Keys no rule matches use `defaultRate`
+        LogRate defaultRate;
+    };
+
+    /** @brief What a LogBandwidthLimiter has let through so far */
+    struct LogBandwidthStats
+    {
+        std::uint64_t sent = 0;         ///< Values admitted
+        std::uint64_t bytes = 0;        ///< Estimated bytes admitted
+        std::uint64_t deferred = 0;     ///< Values held back by the byte cap
+        std::uint64_t rateLimited = 0;  ///< Values held back by their rate
+    };
+
+    /**
+     * @brief Decides which changed values a sink publishes right now
+     *
+     * ## Rates:
+     * Each key is limited to its LogRate. Updates are spaced by the average
+     * period rather than a strict minimum gap, so a 50 Hz key isn't halved by
+     * a loop that comes in slightly early.
+     *
+     * ## Bytes:
+     * A token bucket holding `kBurst` worth of the budget refills at
+     * `bytesPerSecond`. Priority N may only spend what is above N quarters of
+     * the bucket, so once the link is busy the least important keys stop
+     * first. Priority 0 is never held back by the byte cap.
+     *
+     * A value that is held back is dropped. For a key logged every cycle
+     * the next value goes out instead once there is room (the sink compares
+     * against what it last published, so it still counts as changed). Keys
+     * that are only logged now and then, like events and one-shot metadata,
+     * should be priority 0 with a `max` or `once` rate.
+     *
+     * Admit() must only be called from the thread that writes the sink;
+     * Wants() and GetStats() are safe from any thread.
+     */
+    class LogBandwidthLimiter
+    {
+    public:
+        /** @brief How much traffic may go out back to back */
+        static constexpr double kBurst = 0.1;
+
+        /**
+         * @param keys Registry used to look up the rate for a key
+         * @param budget Byte cap and rates, or the default for no limits
+         */
+        LogBandwidthLimiter(const LogKeyRegistry &keys,
+                            LogBandwidthBudget budget = {});
+
+        /**
+         * @brief Checks whether a value fits the budget, and charges it if so
+         *
+         * @param key Key being published
+         * @param bytes Estimated size of the update on the wire
+         * @param timestamp Time in microseconds
+         * @return true if the value should be published now
+         */
+        bool Admit(LogKey key, std::size_t bytes, std::int64_t timestamp);
+
+        /**
+         * @brief Whether a key's rate allows another update at a time
+         *
+         * The byte cap isn't checked, since it depends on the value's size,
+         * so Admit() may still hold back a value this wants. Safe to call
+         * from any thread.
+         *
+         * @param key Key about to be published
+         * @param now Time in microseconds
+         */
+        bool Wants(LogKey key, std::int64_t now) const
+        {
+            return now >= earliest[key].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Replaces the byte cap and rates
+         *
+         * The bucket starts out full again and every key's rate is looked
+         * up anew. Same thread as Admit().
+         */
+        void SetBudget(LogBandwidthBudget newBudget);
+
+        LogBandwidthStats GetStats() const;
+
+    private:
+        struct KeyState
+        {
+            bool resolved = false;
+            bool sent = false;
+            LogRate rate;
+            std::int64_t next = 0;  // Earliest time of the next update
+        };
+
+        KeyState &GetState(LogKey key);
+
+        const LogKeyRegistry &keys;
+        LogBandwidthBudget budget;
+        // Indexed directly by LogKey
+        std::vector<KeyState> states;
+        double capacity = 0;
+        double tokens = 0;
+        std::int64_t refilled = 0;
+
+        // Earliest time each key's rate admits an update, indexed by
+        // LogKey. Sized for every possible key because Wants() can run on
+        // any thread.
+        std::unique_ptr<std::atomic<std::int64_t>[]> earliest;
+
+        std::atomic<std::uint64_t> sent{0};
+        std::atomic<std::uint64_t> sentBytes{0};
+        std::atomic<std::uint64_t> deferred{0};
+        std::atomic<std::uint64_t> rateLimited{0};
+    };
+}  // namespace nfr
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace nfr
+{
+    /**
+     * @brief Converts values into a reusable buffer
+     *
+     * The buffer is kept between calls, so once it has grown to the largest
+     * array seen for a key, converting never allocates again.
+     *
+     * @param buffer Buffer owned by the caller (usually one per log key)
+     * @param values Values to convert
+     * @return View of the converted values inside `buffer`
+     */
+    template <typename To, typename From>
+    std::span<const To> ConvertInto(std::vector<To>& buffer,
+                                    std::span<From> values)
+    {
+        // assign() reuses existing capacity when it is large enough
+        buffer.assign(values.begin(), values.end());
+        return buffer;
+    }
+
+    /**
+     * @brief Copies string views into a reusable buffer of strings
+     *
+     * The buffer never shrinks, so each std::string keeps its capacity and
+     * re-assigning same-length (or shorter) text does not allocate.
+     */
+    inline std::span<const std::string> ConvertInto(
+        std::vector<std::string>& buffer, std::span<std::string_view> values)
+    {
+        if (buffer.size() < values.size())
+        {
+            buffer.resize(values.size());
+        }
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            buffer[i].assign(values[i]);
+        }
+        return std::span<const std::string>{buffer}.first(values.size());
+    }
+
+    /**
+     * @brief Views a span of longs as int64_t without copying when possible
+     *
+     * On 64-bit Linux `long` and `int64_t` are the same type, so the values
+     * are passed straight through. Elsewhere (e.g. the 32-bit roboRIO) they
+     * are widened into `buffer`.
+     */
+    inline std::span<const std::int64_t> AsInt64(
+        std::vector<std::int64_t>& buffer, std::span<long> values)
+    {
+        if constexpr (std::is_same_v<long, std::int64_t>)
+        {
+            return values;
+        }
+        else
+        {
+            return ConvertInto(buffer, values);
+        }
+    }
+}  // namespace nfr
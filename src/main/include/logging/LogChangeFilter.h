@@ -0,0 +1,189 @@
+#pragma once
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/geometry/Pose3d.h>
+#include <frc/geometry/Transform2d.h>
+#include <frc/geometry/Transform3d.h>
+#include <frc/geometry/Twist2d.h>
+#include <frc/geometry/Twist3d.h>
+#include <frc/kinematics/ChassisSpeeds.h>
+#include <frc/kinematics/SwerveModulePosition.h>
+#include <frc/kinematics/SwerveModuleState.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nfr
+{
+    /**
+     * @brief Rules for skipping values that haven't changed since the last
+     *        one that was published
+     *
+     * Integers, booleans and strings (and arrays of them) are compared
+     * exactly. Doubles, and struct types whose packed form is only doubles
+     * (see kPacksAsDoubles), count as unchanged while every component stays
+     * within `epsilon` of the last published value. Comparing against the
+     * last *published* value means slow drift is still published once it
+     * adds up.
+     *
+     * Example:
+     * ```cpp
+     * LogChangeFilter filter;
+     * filter.epsilon = 1e-4;
+     * filter.prefixEpsilons = {{"robot/drive/pose", 1e-3}};
+     * logger.EnableNTLogging("logs", filter);
+     * ```
+     */
+    struct LogChangeFilter
+    {
+        /// Set to false to publish every value, changed or not
+        bool enabled = true;
+
+        /// Tolerance for doubles and double-only structs
+        double epsilon = 1e-6;
+
+        /// Tolerances for keys under a prefix; the longest match wins
+        std::vector<std::pair<std::string, double>> prefixEpsilons;
+
+        /** @brief Gets the tolerance that applies to a key path */
+        double EpsilonFor(std::string_view path) const
+        {
+            double result = epsilon;
+            std::size_t longest = 0;
+            for (const auto& [prefix, value] : prefixEpsilons)
+            {
+                bool matches = path.starts_with(prefix) &&
+                               (path.size() == prefix.size() ||
+                                path[prefix.size()] == '/');
+                if (matches && prefix.size() >= longest)
+                {
+                    result = value;
+                    longest = prefix.size();
+                }
+            }
+            return result;
+        }
+    };
+
+    /**
+     * @brief Whether a wpi::Struct type packs into nothing but doubles
+     *
+     * Such types are compared component-wise with the filter's epsilon;
+     * every other struct is compared byte for byte. Specialize this for
+     * robot-specific structs that are made of doubles.
+     */
+    template <typename T>
+    inline constexpr bool kPacksAsDoubles = false;
+
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Rotation2d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Rotation3d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Translation2d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Translation3d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Pose2d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Pose3d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Transform2d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Transform3d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Twist2d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Twist3d> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::Quaternion> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::ChassisSpeeds> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::SwerveModuleState> = true;
+    template <>
+    inline constexpr bool kPacksAsDoubles<frc::SwerveModulePosition> = true;
+
+    /** @brief Whether two doubles are within epsilon (NaN never matches) */
+    inline bool NearlyEqual(double a, double b, double epsilon)
+    {
+        return std::abs(a - b) <= epsilon;
+    }
+
+    /** @brief Element-wise NearlyEqual for arrays of the same length */
+    inline bool NearlyEqual(std::span<const double> a,
+                            std::span<const double> b, double epsilon)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (!NearlyEqual(a[i], b[i], epsilon))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** @brief Element-wise equality across arrays of different types */
+    template <typename A, typename B>
+    bool ArrayEqual(std::span<A> a, std::span<B> b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (!(a[i] == b[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compares two packed wpi::Struct buffers of type T
+     *
+     * Double-only types are compared component-wise with `epsilon`; all
+     * others must match exactly.
+     */
+    template <typename T>
+    bool PackedEqual(std::span<const std::uint8_t> a,
+                     std::span<const std::uint8_t> b, double epsilon)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        if constexpr (kPacksAsDoubles<T>)
+        {
+            for (std::size_t offset = 0; offset + sizeof(double) <= a.size();
+                 offset += sizeof(double))
+            {
+                double x;
+                double y;
+                std::memcpy(&x, a.data() + offset, sizeof(double));
+                std::memcpy(&y, b.data() + offset, sizeof(double));
+                if (!NearlyEqual(x, y, epsilon))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        else
+        {
+            return std::memcmp(a.data(), b.data(), a.size()) == 0;
+        }
+    }
+}  // namespace nfr
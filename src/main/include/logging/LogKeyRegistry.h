@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nfr
+{
+    /**
+     * @brief Compact handle for an interned hierarchical log key
+     *
+     * Every path like "robot/drive/pose" is resolved exactly once into a small
+     * integer. Log sinks index their entries by this handle instead of hashing
+     * the path string on every write.
+     */
+    using LogKey = std::uint32_t;
+
+    /** @brief Handle of the (empty) root key that all paths hang off of */
+    inline constexpr LogKey kRootLogKey = 0;
+
+    /**
+     * @brief Interns hierarchical log keys into integer handles
+     *
+     * The registry is a tree: each node stores its full path once and a short
+     * list of child handles. Resolving `parent["child"]` scans the children of
+     * the parent and compares names, so once a key has been seen the lookup
+     * never allocates and never hashes a string.
+     *
+     * Nodes live in fixed-size chunks that are never moved, so a path returned
+     * by Path() stays valid for the lifetime of the registry.
+     *
+     * ## Threads:
+     * Every function may be called from any thread. Looking up a key that
+     * already exists takes no lock: child lists are only ever prepended to,
+     * and a new node is fully written before it is linked in. Only creating
+     * a key takes a mutex.
+     */
+    class LogKeyRegistry
+    {
+    public:
+        LogKeyRegistry();
+        LogKeyRegistry(const LogKeyRegistry&) = delete;
+        LogKeyRegistry& operator=(const LogKeyRegistry&) = delete;
+
+        /**
+         * @brief Resolves a child of an existing key, creating it if needed
+         *
+         * Names containing '/' are split, so `Child(root, "a/b")` returns the
+         * same handle as `Child(Child(root, "a"), "b")`.
+         *
+         * @param parent Handle of the parent key
+         * @param name Name of the child (may contain '/' separators)
+         * @return Handle for the child key
+         */
+        LogKey Child(LogKey parent, std::string_view name);
+
+        /**
+         * @brief Resolves a fixed list of children of a key at once
+         *
+         * The handles are resolved the first time a list is seen under a
+         * parent and cached; after that this is a scan over the cached
+         * tables comparing two integers, however many names there are.
+         *
+         * @param parent Handle of the parent key
+         * @param names Child names. The list is identified by its address,
+         *        so it must be static (e.g. a constexpr table).
+         * @return Handles in the same order as `names`, valid for the
+         *         lifetime of the registry
+         */
+        std::span<const LogKey> Children(
+            LogKey parent, std::span<const std::string_view> names);
+
+        /**
+         * @brief Gets the full path of a key, e.g. "robot/drive/pose"
+         */
+        std::string_view Path(LogKey key) const
+        {
+            return Get(key).path;
+        }
+
+        /** @brief Most keys a registry can hold; handles are always below */
+        static constexpr std::size_t Capacity()
+        {
+            return kMaxChunks * kChunkSize;
+        }
+
+        /** @brief Number of keys interned so far (including the root) */
+        std::size_t Size() const
+        {
+            return size.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct Node
+        {
+            std::string path;
+            std::size_t nameOffset = 0;
+            // Children form a linked list through nextSibling, newest first.
+            // The root is never a child, so kRootLogKey ends the list.
+            std::atomic<LogKey> firstChild{kRootLogKey};
+            LogKey nextSibling = kRootLogKey;
+
+            std::string_view Name() const
+            {
+                return std::string_view{path}.substr(nameOffset);
+            }
+        };
+
+        static constexpr std::size_t kChunkBits = 10;
+        static constexpr std::size_t kChunkSize = std::size_t{1} << kChunkBits;
+        static constexpr std::size_t kMaxChunks = 64;
+
+        Node& Get(LogKey key)
+        {
+            return chunks[key >> kChunkBits][key & (kChunkSize - 1)];
+        }
+
+        const Node& Get(LogKey key) const
+        {
+            return chunks[key >> kChunkBits][key & (kChunkSize - 1)];
+        }
+
+        LogKey ChildSegment(LogKey parent, std::string_view name);
+        /** @brief Looks up an existing child, or returns kRootLogKey */
+        LogKey FindChild(LogKey parent, std::string_view name) const;
+        /** @brief Adds a child (called with mutex held) */
+        LogKey Create(LogKey parent, std::string_view name);
+
+        // A name list resolved under one parent (see Children())
+        struct ChildTable
+        {
+            LogKey parent;
+            const std::string_view* names;
+            std::vector<LogKey> keys;
+            const ChildTable* next;
+        };
+
+        std::array<std::unique_ptr<Node[]>, kMaxChunks> chunks;
+        std::atomic<std::size_t> size{0};
+
+        // Newest first, prepended like child lists; owned by the deque
+        std::atomic<const ChildTable*> childTables{nullptr};
+        std::deque<ChildTable> childTableStorage;
+
+        // Held while creating keys and child tables
+        std::mutex mutex;
+    };
+}  // namespace nfr
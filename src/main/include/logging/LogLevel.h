@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Lowest level compiled into the program (0 debug, 1 info, 2 critical)
+ *
+ * Competition builds pass `-PlogLevel=info` to Gradle, which defines this
+ * as 1 so NFR_LOG_DEBUG statements compile to nothing.
+ */
+#ifndef NFR_LOG_LEVEL
+#define NFR_LOG_LEVEL 0
+#endif
+
+namespace nfr
+{
+    /**
+     * @brief How important a logged value is
+     *
+     * A LogContext is tagged with a level (kInfo unless NFR_LOG_DEBUG or
+     * At() says otherwise) and its values are only written when that level
+     * is at or above the threshold for its key.
+     */
+    enum class LogLevel : std::uint8_t
+    {
+        kDebug,     ///< Diagnostics only worth their cost while debugging
+        kInfo,      ///< Robot state we want in every log
+        kCritical,  ///< Needed to make sense of a match at all
+        kOff,       ///< Threshold only: writes nothing
+    };
+
+    /** @brief Levels below this are stripped at compile time */
+    inline constexpr LogLevel kCompiledLogLevel =
+        static_cast<LogLevel>(NFR_LOG_LEVEL);
+
+    /** @brief Parses "debug", "info", "critical" or "off" */
+    std::optional<LogLevel> ParseLogLevel(std::string_view name);
+
+    /**
+     * @brief Per-prefix thresholds, e.g. `robot/Robot3d=off,perf=critical`
+     *
+     * A rule applies to its key and everything under it; when several rules
+     * match a key, the longest prefix wins. Keys no rule matches use the
+     * logger's global threshold.
+     */
+    class LogLevelRules
+    {
+    public:
+        /**
+         * @brief Parses comma-separated `prefix=level` rules
+         *
+         * Whitespace around rules is ignored and an empty string means no
+         * rules.
+         *
+         * @return nullopt if any rule is malformed
+         */
+        static std::optional<LogLevelRules> Parse(std::string_view spec);
+
+        /** @brief Threshold for a key path, or nullopt if no rule matches */
+        std::optional<LogLevel> Find(std::string_view path) const;
+
+        bool Empty() const
+        {
+            return rules.empty();
+        }
+
+    private:
+        // Longest prefix first, so the first match is the one that applies
+        std::vector<std::pair<std::string, LogLevel>> rules;
+    };
+}  // namespace nfr
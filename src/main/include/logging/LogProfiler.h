@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "logging/LogKeyRegistry.h"
+
+namespace nfr
+{
+    /**
+     * @brief Accumulates what each log key costs in each sink
+     *
+     * For every (key, sink) pair the profiler counts calls, serialized bytes
+     * and nanoseconds spent inside the sink. Counters are reset each time a
+     * report is taken, so a report covers one period.
+     *
+     * Recording takes a mutex because sinks may be written from the async
+     * writer thread while the robot thread takes reports. Profiling is
+     * opt-in and meant for finding expensive keys, not for competition.
+     */
+    class LogProfiler
+    {
+    public:
+        /** @brief Totals for one key in one sink over a period */
+        struct Cost
+        {
+            std::uint64_t calls = 0;
+            std::uint64_t bytes = 0;
+            std::int64_t nanoseconds = 0;
+        };
+
+        /** @brief One row of a report */
+        struct Row
+        {
+            LogKey key;
+            std::size_t sink;  ///< Index into the sink names
+            Cost cost;
+        };
+
+        /**
+         * @param sinkNames Name of each sink, by sink index
+         * @param topCount Number of rows kept in each report
+         * @param period How often reports are produced
+         */
+        LogProfiler(std::vector<std::string_view> sinkNames,
+                    std::size_t topCount, std::chrono::nanoseconds period);
+
+        /** @brief Adds one sink write to the totals */
+        void Record(LogKey key, std::size_t sink, std::size_t bytes,
+                    std::chrono::nanoseconds elapsed);
+
+        /**
+         * @brief Takes the most expensive rows once per period
+         *
+         * @param rows Filled with up to topCount rows, most expensive first
+         * @param elapsed Set to the length of the period the rows cover
+         * @return false (and leaves `rows` alone) until a period has passed
+         */
+        bool TakeReport(std::vector<Row>& rows,
+                        std::chrono::nanoseconds& elapsed);
+
+        std::string_view SinkName(std::size_t sink) const
+        {
+            return sinkNames[sink];
+        }
+
+    private:
+        std::vector<std::string_view> sinkNames;
+        std::size_t topCount;
+        std::chrono::nanoseconds period;
+
+        std::mutex mutex;
+        // Indexed by key * sinkNames.size() + sink
+        std::vector<Cost> costs;
+        std::chrono::steady_clock::time_point periodStart;
+    };
+}  // namespace nfr
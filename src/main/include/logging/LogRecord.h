@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "logging/LogKeyRegistry.h"
+#include "wpi/struct/Struct.h"
+
+namespace nfr
+{
+    /**
+     * @brief Function that turns an encoded record back into a typed value
+     *
+     * Each value type gets its own replay function, so a record only needs to
+     * carry a function pointer to say how it should be decoded and which sink
+     * overload it belongs to.
+     *
+     * @param target Object that receives the decoded value (e.g. the Logger)
+     * @param key Key the value was logged under
+     * @param payload Encoded bytes written by LogRecordCodec<T>::Encode
+     */
+    using LogReplayFn = void (*)(void* target, LogKey key,
+                                 std::span<std::byte> payload);
+
+    /**
+     * @brief Fixed header in front of every record in a LogRingBuffer
+     *
+     * A record with a null replay function is padding that skips to the end
+     * of the buffer.
+     */
+    struct alignas(16) LogRecordHeader
+    {
+        std::uint32_t size;  ///< Payload bytes after this header
+        LogKey key;
+        LogReplayFn replay;
+    };
+
+    /** @brief All records are padded to this alignment */
+    inline constexpr std::size_t kLogRecordAlignment = alignof(LogRecordHeader);
+
+    /**
+     * @brief Serializes one value type into a flat, trivially copyable payload
+     *
+     * Specializations provide:
+     * - `Size(value)`: number of payload bytes needed
+     * - `Encode(value, out)`: write the payload into `out`
+     * - `Decode(payload, f)`: rebuild the value and call `f(value)`
+     *
+     * Decoding may point into the payload (strings, arrays) so the callback
+     * must not hold on to the value after it returns.
+     */
+    template <typename T>
+    struct LogRecordCodec;
+
+    /** @brief Codec for scalar values (double, long, bool) */
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    struct LogRecordCodec<T>
+    {
+        static std::size_t Size(const T&)
+        {
+            return sizeof(T);
+        }
+
+        static void Encode(const T& value, std::span<std::byte> out)
+        {
+            std::memcpy(out.data(), &value, sizeof(T));
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            T value;
+            std::memcpy(&value, payload.data(), sizeof(T));
+            f(value);
+        }
+    };
+
+    /** @brief Codec for strings: the payload is the raw characters */
+    template <>
+    struct LogRecordCodec<std::string_view>
+    {
+        static std::size_t Size(std::string_view value)
+        {
+            return value.size();
+        }
+
+        static void Encode(std::string_view value, std::span<std::byte> out)
+        {
+            std::memcpy(out.data(), value.data(), value.size());
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            f(std::string_view{reinterpret_cast<const char*>(payload.data()),
+                               payload.size()});
+        }
+    };
+
+    /**
+     * @brief Codec for arrays of scalars: the payload is the raw elements
+     *
+     * Payloads start on a 16-byte boundary, so the decoded span points
+     * straight into the ring buffer without copying.
+     */
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    struct LogRecordCodec<std::span<T>>
+    {
+        static std::size_t Size(std::span<T> values)
+        {
+            return values.size_bytes();
+        }
+
+        static void Encode(std::span<T> values, std::span<std::byte> out)
+        {
+            std::memcpy(out.data(), values.data(), values.size_bytes());
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            f(std::span<T>{reinterpret_cast<T*>(payload.data()),
+                           payload.size() / sizeof(T)});
+        }
+    };
+
+    /**
+     * @brief Codec for string arrays
+     *
+     * Layout: element count, one length per element, then all characters.
+     */
+    template <>
+    struct LogRecordCodec<std::span<std::string_view>>
+    {
+        static std::size_t Size(std::span<std::string_view> values)
+        {
+            std::size_t size = sizeof(std::uint32_t) * (values.size() + 1);
+            for (const auto& value : values)
+            {
+                size += value.size();
+            }
+            return size;
+        }
+
+        static void Encode(std::span<std::string_view> values,
+                           std::span<std::byte> out)
+        {
+            auto count = static_cast<std::uint32_t>(values.size());
+            std::byte* cursor = out.data();
+            std::memcpy(cursor, &count, sizeof(count));
+            cursor += sizeof(count);
+            for (const auto& value : values)
+            {
+                auto length = static_cast<std::uint32_t>(value.size());
+                std::memcpy(cursor, &length, sizeof(length));
+                cursor += sizeof(length);
+            }
+            for (const auto& value : values)
+            {
+                std::memcpy(cursor, value.data(), value.size());
+                cursor += value.size();
+            }
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            // Only touched by the single thread that drains records
+            thread_local std::vector<std::string_view> views;
+
+            std::uint32_t count;
+            const std::byte* lengths = payload.data() + sizeof(count);
+            std::memcpy(&count, payload.data(), sizeof(count));
+            const char* chars = reinterpret_cast<const char*>(
+                lengths + sizeof(std::uint32_t) * count);
+
+            views.resize(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                std::uint32_t length;
+                std::memcpy(&length, lengths + sizeof(length) * i,
+                            sizeof(length));
+                views[i] = std::string_view{chars, length};
+                chars += length;
+            }
+            f(std::span<std::string_view>{views});
+        }
+    };
+
+    /** @brief Codec for wpi::Struct types, stored in their packed form */
+    template <typename T>
+        requires wpi::StructSerializable<T>
+    struct LogRecordCodec<T>
+    {
+        static std::size_t Size(const T&)
+        {
+            return wpi::GetStructSize<T>();
+        }
+
+        static void Encode(const T& value, std::span<std::byte> out)
+        {
+            auto* bytes = reinterpret_cast<uint8_t*>(out.data());
+            wpi::PackStruct(std::span<uint8_t>{bytes, out.size()}, value);
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            f(wpi::UnpackStruct<T>(std::span<const uint8_t>{
+                reinterpret_cast<const uint8_t*>(payload.data()),
+                payload.size()}));
+        }
+    };
+
+    /** @brief Codec for arrays of wpi::Struct types */
+    template <typename T>
+        requires wpi::StructSerializable<T>
+    struct LogRecordCodec<std::span<T>>
+    {
+        static std::size_t Size(std::span<T> values)
+        {
+            return wpi::GetStructSize<T>() * values.size();
+        }
+
+        static void Encode(std::span<T> values, std::span<std::byte> out)
+        {
+            const std::size_t size = wpi::GetStructSize<T>();
+            auto* bytes = reinterpret_cast<uint8_t*>(out.data());
+            for (const auto& value : values)
+            {
+                wpi::PackStruct(std::span<uint8_t>{bytes, size}, value);
+                bytes += size;
+            }
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            // Only touched by the single thread that drains records
+            thread_local std::vector<T> values;
+
+            const std::size_t size = wpi::GetStructSize<T>();
+            const auto* bytes =
+                reinterpret_cast<const uint8_t*>(payload.data());
+            values.clear();
+            for (std::size_t offset = 0; offset + size <= payload.size();
+                 offset += size)
+            {
+                values.push_back(wpi::UnpackStruct<T>(
+                    std::span<const uint8_t>{bytes + offset, size}));
+            }
+            f(std::span<T>{values});
+        }
+    };
+
+    /** @brief A value together with the time it was logged */
+    template <typename T>
+    struct Timestamped
+    {
+        std::int64_t timestamp;
+        const T& value;
+    };
+
+    /**
+     * @brief Codec for timestamped values: the timestamp, then the value
+     *
+     * The timestamp takes a full alignment unit so array payloads behind it
+     * stay aligned. Decode() calls `f(timestamp, value)`.
+     */
+    template <typename T>
+    struct LogRecordCodec<Timestamped<T>>
+    {
+        static constexpr std::size_t kValueOffset = kLogRecordAlignment;
+
+        static std::size_t Size(const Timestamped<T>& record)
+        {
+            return kValueOffset + LogRecordCodec<T>::Size(record.value);
+        }
+
+        static void Encode(const Timestamped<T>& record,
+                           std::span<std::byte> out)
+        {
+            std::memcpy(out.data(), &record.timestamp,
+                        sizeof(record.timestamp));
+            LogRecordCodec<T>::Encode(record.value,
+                                      out.subspan(kValueOffset));
+        }
+
+        template <typename F>
+        static void Decode(std::span<std::byte> payload, F&& f)
+        {
+            std::int64_t timestamp;
+            std::memcpy(&timestamp, payload.data(), sizeof(timestamp));
+            LogRecordCodec<T>::Decode(payload.subspan(kValueOffset),
+                                      [&](const auto& value)
+                                      { f(timestamp, value); });
+        }
+    };
+}  // namespace nfr
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "logging/LogRecord.h"
+
+namespace nfr
+{
+    /**
+     * @brief Preallocated single-producer/single-consumer queue of log records
+     *
+     * The producer (robot thread) reserves space for a record, encodes it in
+     * place and commits. The consumer (writer thread) walks committed records
+     * and hands each one to its replay function. Neither side ever locks or
+     * allocates; when the buffer is full, TryReserve() fails and the caller
+     * decides to drop the record.
+     *
+     * Records are contiguous: if a record does not fit before the end of the
+     * buffer, the remaining space is filled with a padding record and the
+     * record starts over at the beginning.
+     */
+    class LogRingBuffer
+    {
+    public:
+        /**
+         * @param capacity Buffer size in bytes, rounded up to a power of two
+         */
+        explicit LogRingBuffer(std::size_t capacity);
+        LogRingBuffer(const LogRingBuffer&) = delete;
+        LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+        /**
+         * @brief Reserves space for a record with the given payload size
+         *
+         * Producer only. The header is filled in; the caller writes the
+         * payload into the returned span. Reserved records become visible to
+         * the consumer on the next Commit().
+         *
+         * @return Payload span, or an empty span if the buffer is full
+         */
+        std::span<std::byte> TryReserve(LogKey key, LogReplayFn replay,
+                                        std::size_t payloadSize);
+
+        /** @brief Publishes every record reserved so far (producer only) */
+        void Commit()
+        {
+            head.store(reserveHead, std::memory_order_release);
+        }
+
+        /**
+         * @brief Replays every committed record into a target (consumer only)
+         *
+         * @return Number of records replayed
+         */
+        std::size_t Drain(void* target);
+
+        /** @brief Total capacity in bytes */
+        std::size_t Capacity() const
+        {
+            return mask + 1;
+        }
+
+        /** @brief Bytes currently committed but not yet drained */
+        std::size_t Used() const
+        {
+            return static_cast<std::size_t>(
+                head.load(std::memory_order_acquire) -
+                tail.load(std::memory_order_acquire));
+        }
+
+    private:
+        // Storage unit that keeps every record aligned for its header
+        struct alignas(kLogRecordAlignment) Block
+        {
+            std::byte bytes[kLogRecordAlignment];
+        };
+
+        std::byte* At(std::uint64_t position)
+        {
+            return reinterpret_cast<std::byte*>(buffer.get()) +
+                   (position & mask);
+        }
+
+        std::unique_ptr<Block[]> buffer;
+        std::size_t mask;
+
+        // Producer-owned state. Positions only ever grow; the buffer index is
+        // position & mask.
+        alignas(64) std::atomic<std::uint64_t> head{0};
+        std::uint64_t reserveHead = 0;
+        std::uint64_t cachedTail = 0;
+
+        // Consumer-owned state
+        alignas(64) std::atomic<std::uint64_t> tail{0};
+    };
+}  // namespace nfr
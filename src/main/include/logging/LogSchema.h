@@ -0,0 +1,135 @@
+/**
+ * @file LogSchema.h
+ * @brief Describe a struct's fields once and log the whole struct with
+ *        precomputed key handles
+ *
+ * Instead of writing a Log() function that looks up every field by name:
+ *
+ * ```cpp
+ * inline void Log(const nfr::LogContext& log, const ShooterState& state)
+ * {
+ *     log["rpm"] << state.rpm;
+ *     log["atSpeed"] << state.atSpeed;
+ * }
+ * ```
+ *
+ * list the fields in a LogSchema specialization:
+ *
+ * ```cpp
+ * template <>
+ * struct nfr::LogSchema<ShooterState>
+ * {
+ *     static constexpr std::tuple kFields{
+ *         NFR_LOG_FIELD(ShooterState, rpm),
+ *         NFR_LOG_FIELD(ShooterState, atSpeed),
+ *     };
+ * };
+ * ```
+ *
+ * and `log["shooter"] << state` works as before. The table of field names is
+ * built at compile time and the writer is unrolled into one call per field.
+ * The child keys are resolved once per parent key (see
+ * LogKeyRegistry::Children()), so each write after the first one costs no
+ * string concatenation or key lookup at all.
+ *
+ * Fields can be any type a LogContext accepts, including other structs with
+ * a schema.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "logging/Logger.h"
+
+/**
+ * @brief Describes a field logged under its own name
+ *
+ * Use LogField directly to log a field under a different name:
+ * `nfr::LogField{"p50_us", &Summary::p50}`.
+ */
+#define NFR_LOG_FIELD(Type, member) ::nfr::LogField{#member, &Type::member}
+
+namespace nfr
+{
+    /**
+     * @brief One logged field: its key name and where it lives in the struct
+     */
+    template <typename Class, typename Member>
+    struct LogField
+    {
+        std::string_view name;
+        Member Class::*member;
+    };
+
+    /**
+     * @brief Specialize with a `static constexpr std::tuple kFields` of
+     *        LogFields to make a struct loggable
+     */
+    template <typename T>
+    struct LogSchema;
+
+    /** @brief Concept for types with a LogSchema specialization */
+    template <typename T>
+    concept HasLogSchema = requires { LogSchema<T>::kFields; };
+
+    /** @brief Field names of a schema, in order, as a compile-time table */
+    template <typename T>
+        requires HasLogSchema<T>
+    inline constexpr auto kLogFieldNames = std::apply(
+        [](const auto&... fields)
+        {
+            return std::array<std::string_view, sizeof...(fields)>{
+                fields.name...};
+        },
+        LogSchema<T>::kFields);
+
+    namespace detail
+    {
+        template <std::size_t N>
+        constexpr bool UniqueNames(const std::array<std::string_view, N>& names)
+        {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                for (std::size_t j = i + 1; j < N; ++j)
+                {
+                    if (names[i] == names[j])
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }  // namespace detail
+
+    /**
+     * @brief Logs every field of a struct with a LogSchema
+     *
+     * Found by argument-dependent lookup through LogContext, so
+     * `log["key"] << value` picks it up like a hand-written Log().
+     */
+    template <typename T>
+        requires HasLogSchema<T>
+    void Log(const LogContext& logContext, const T& value)
+    {
+        static_assert(detail::UniqueNames(kLogFieldNames<T>),
+                      "LogSchema has two fields with the same name");
+
+        constexpr auto& fields = LogSchema<T>::kFields;
+        Logger* logger = logContext.GetLogger();
+        std::span<const LogKey> keys = logger->GetKeys().Children(
+            logContext.GetKey(), kLogFieldNames<T>);
+        [&]<std::size_t... Index>(std::index_sequence<Index...>)
+        {
+            ((LogContext{keys[Index], logger, logContext.GetLevel()}
+              << value.*std::get<Index>(fields).member),
+             ...);
+        }(std::make_index_sequence<kLogFieldNames<T>.size()>{});
+    }
+}  // namespace nfr
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "logging/LogKeyRegistry.h"
+
+namespace nfr
+{
+    /**
+     * @brief Concept for a destination that logged values are written to
+     *
+     * A sink accepts every basic value type by interned key, along with a
+     * timestamp in microseconds (0 means "now"). Sinks that also accept
+     * wpi::Struct types do so with templated overloads:
+     *
+     * ```cpp
+     * template <typename T, typename... I>
+     *     requires wpi::StructSerializable<T, I...>
+     * void Log(LogKey key, const T& value, std::int64_t timestamp = 0);
+     *
+     * template <typename T, typename... I>
+     *     requires wpi::StructSerializable<T, I...>
+     * void Log(LogKey key, std::span<T> values, std::int64_t timestamp = 0);
+     * ```
+     *
+     * BasicLogger constructs sinks with the key registry as the first
+     * argument, so they can turn keys back into paths when they need to.
+     *
+     * Sinks that drop some values before writing them (decimation, rate
+     * limits) can say so ahead of time, which lets lazily computed values
+     * be skipped without computing them (see LogContext):
+     *
+     * ```cpp
+     * bool Wants(LogKey key) const;  // Would the next value be written?
+     * void Skip(LogKey key);         // Count a value nobody computed
+     * ```
+     *
+     * Both may be called from any logging thread while Log() runs on the
+     * writer thread. A sink without Wants() wants every value.
+     */
+    template <typename S>
+    concept LogSink = requires(S& sink, LogKey key, std::int64_t t, double d,
+                               long l, bool b, std::string_view s,
+                               std::span<double> ds, std::span<long> ls,
+                               std::span<bool> bs,
+                               std::span<std::string_view> ss) {
+        sink.Log(key, d, t);
+        sink.Log(key, l, t);
+        sink.Log(key, b, t);
+        sink.Log(key, s, t);
+        sink.Log(key, ds, t);
+        sink.Log(key, ls, t);
+        sink.Log(key, bs, t);
+        sink.Log(key, ss, t);
+    };
+
+    /** @brief Whether a sink would write the next value for a key */
+    template <typename S>
+    bool LogSinkWants(const S& sink, LogKey key)
+    {
+        if constexpr (requires { sink.Wants(key); })
+        {
+            return sink.Wants(key);
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    /** @brief Tells a sink a value for a key was offered but not computed */
+    template <typename S>
+    void LogSinkSkip(S& sink, LogKey key)
+    {
+        if constexpr (requires { sink.Skip(key); })
+        {
+            sink.Skip(key);
+        }
+    }
+
+    /**
+     * @brief Whether a sink gets only the summaries of keys LogStatistics
+     *        summarizes, not their values
+     *
+     * Sinks that send or store what they are given (NT, WPILog) say so with
+     * `static constexpr bool kSummariesOnly = true`. Other sinks, like the
+     * flight recorder, still get every value.
+     */
+    template <typename S>
+    constexpr bool LogSinkSummariesOnly()
+    {
+        if constexpr (requires { bool{S::kSummariesOnly}; })
+        {
+            return S::kSummariesOnly;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Name a sink is reported under (e.g. by the profiler)
+     *
+     * Sinks can provide `static constexpr std::string_view kName`.
+     */
+    template <typename S>
+    constexpr std::string_view LogSinkName()
+    {
+        if constexpr (requires { std::string_view{S::kName}; })
+        {
+            return S::kName;
+        }
+        else
+        {
+            return "sink";
+        }
+    }
+}  // namespace nfr
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "logging/LogRingBuffer.h"
+
+namespace nfr
+{
+    /** @brief Counters for values logged from threads other than the robot's */
+    struct LogStagingStats
+    {
+        std::size_t threads = 0;    ///< Threads that have logged so far
+        std::uint64_t queued = 0;   ///< Records accepted into their buffers
+        std::uint64_t dropped = 0;  ///< Records rejected because it was full
+    };
+
+    /**
+     * @brief Per-thread buffers for values logged off the robot thread
+     *
+     * The first time a thread pushes a value it gets a ring buffer of its
+     * own, so producers never share a lock or a buffer: pushing costs a
+     * thread-local lookup and a LogRingBuffer reservation. A single consumer
+     * (whichever thread writes to the sinks) drains every buffer.
+     *
+     * Buffers are kept until the staging area is destroyed, so a thread that
+     * stops logging keeps its (empty) buffer. That suits the few long-lived
+     * threads a robot has: notifiers, odometry, vision.
+     */
+    class LogStaging
+    {
+    public:
+        /**
+         * @param capacityPerThread Size of each thread's ring buffer in bytes
+         */
+        explicit LogStaging(std::size_t capacityPerThread = 64 * 1024);
+        LogStaging(const LogStaging&) = delete;
+        LogStaging& operator=(const LogStaging&) = delete;
+
+        /**
+         * @brief Queues one value in the calling thread's buffer (any thread)
+         *
+         * @return false if the record was dropped because the buffer is full
+         */
+        template <typename T>
+        bool Push(LogKey key, LogReplayFn replay, const T& value)
+        {
+            using Codec = LogRecordCodec<T>;
+            Producer& producer = Local();
+            auto payload =
+                producer.ring.TryReserve(key, replay, Codec::Size(value));
+            if (payload.data() == nullptr)
+            {
+                producer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            Codec::Encode(value, payload);
+            producer.ring.Commit();
+            producer.queued.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Replays every queued record into a target (consumer only)
+         *
+         * @return Number of records replayed
+         */
+        std::size_t Drain(void* target);
+
+        /** @brief Snapshot of the counters, summed over all threads */
+        LogStagingStats GetStats() const;
+
+    private:
+        struct Producer
+        {
+            Producer(std::size_t capacity, std::thread::id thread)
+                : ring(capacity), thread(thread)
+            {
+            }
+
+            LogRingBuffer ring;
+            const std::thread::id thread;
+            std::atomic<std::uint64_t> queued{0};
+            std::atomic<std::uint64_t> dropped{0};
+            Producer* next = nullptr;
+        };
+
+        /** @brief The calling thread's producer, registered on first use */
+        Producer& Local()
+        {
+            // One entry per thread: a thread normally logs to one logger
+            struct Cache
+            {
+                std::uint64_t owner = 0;
+                Producer* producer = nullptr;
+            };
+            thread_local Cache cache;
+            if (cache.owner != id)
+            {
+                cache = {id, &Register()};
+            }
+            return *cache.producer;
+        }
+
+        Producer& Register();
+
+        const std::size_t capacityPerThread;
+        // Tells staging areas apart in the thread-local cache; never reused,
+        // unlike addresses
+        const std::uint64_t id;
+
+        // Newest first; producers are only ever added, and are fully built
+        // before they are linked in, so the consumer walks this lock-free
+        std::atomic<Producer*> producers{nullptr};
+        std::deque<Producer> storage;  // Owns the producers
+        std::mutex mutex;              // Held while registering
+    };
+}  // namespace nfr
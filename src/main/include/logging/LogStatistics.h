@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "logging/LogKeyRegistry.h"
+#include "wpi/struct/Struct.h"
+
+namespace nfr
+{
+    /** @brief Summary of one key's values over a window */
+    struct LogSummary
+    {
+        LogKey key = kRootLogKey;
+        std::uint64_t count = 0;
+        double min = 0;
+        double max = 0;
+        double mean = 0;
+        double stddev = 0;
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+    };
+
+    /**
+     * @brief Log sink that summarizes numeric keys over a time window
+     *
+     * Every double or integer logged under one of the configured prefixes
+     * feeds a running min/max/mean/standard deviation (Welford's algorithm)
+     * and a fixed-size sample buffer for percentiles. Percentiles are exact
+     * while a window has at most `maxSamples` values and come from a uniform
+     * random sample of them after that.
+     *
+     * The logger collects the summaries once per window and logs them under
+     * `stats/<key>/...` (count, min, max, mean, stddev, p50, p90, p99). NT
+     * and WPILog get one summary per second instead of every sample: the
+     * logger doesn't pass them the values of summarized keys at all (see
+     * LogSinkSummariesOnly()). The flight recorder still gets every value.
+     * Values under `stats` itself are never summarized.
+     *
+     * Log() runs on the writer thread and Collect() on the robot thread, so
+     * the window is guarded by a mutex; keys that aren't summarized return
+     * before taking it.
+     */
+    class LogStatistics
+    {
+    public:
+        static constexpr std::string_view kName = "stats";
+        /** @brief Where the logger publishes summaries */
+        static constexpr std::string_view kOutputPrefix = "stats";
+
+        /**
+         * @param keys Registry used to match keys against the prefixes
+         * @param prefixList Comma-separated key prefixes to summarize, e.g.
+         *        `robot/drive/speed,perf`
+         * @param window How long each summary covers
+         * @param maxSamples Values kept per key and window for percentiles
+         */
+        LogStatistics(
+            const LogKeyRegistry& keys, std::string_view prefixList,
+            std::chrono::milliseconds window = std::chrono::seconds{1},
+            std::size_t maxSamples = 256);
+
+        /** @brief Whether values of a key are summarized (any thread) */
+        bool Wants(LogKey key) const
+        {
+            return Tracked(key);
+        }
+
+        void Log(LogKey key, double value, std::int64_t = 0)
+        {
+            Add(key, value);
+        }
+        void Log(LogKey key, long value, std::int64_t = 0)
+        {
+            Add(key, static_cast<double>(value));
+        }
+        // Only scalar numbers are summarized
+        void Log(LogKey, bool, std::int64_t = 0) {}
+        void Log(LogKey, const std::string_view&, std::int64_t = 0) {}
+        void Log(LogKey, std::span<double>, std::int64_t = 0) {}
+        void Log(LogKey, std::span<long>, std::int64_t = 0) {}
+        void Log(LogKey, std::span<bool>, std::int64_t = 0) {}
+        void Log(LogKey, std::span<std::string_view>, std::int64_t = 0) {}
+        template <typename T, typename... I>
+            requires wpi::StructSerializable<T, I...>
+        void Log(LogKey, const T&, std::int64_t = 0)
+        {
+        }
+        template <typename T, typename... I>
+            requires wpi::StructSerializable<T, I...>
+        void Log(LogKey, std::span<T>, std::int64_t = 0)
+        {
+        }
+
+        /**
+         * @brief Ends the window if it is over, summarizing every key that
+         *        got values during it
+         *
+         * @param now Time in microseconds
+         * @param out Replaced with the summaries (left empty if the window
+         *        isn't over yet)
+         * @return true if the window ended
+         */
+        bool Collect(std::int64_t now, std::vector<LogSummary>& out);
+
+    private:
+        /** @brief Running statistics for one key in the current window */
+        struct Accumulator
+        {
+            std::uint64_t count = 0;
+            double mean = 0;
+            double m2 = 0;  // Sum of squared differences from the mean
+            double min = 0;
+            double max = 0;
+            std::vector<double> samples;
+        };
+
+        enum Match : std::uint8_t
+        {
+            kUnknown,
+            kTracked,
+            kIgnored,
+        };
+
+        bool Tracked(LogKey key) const;
+        void Add(LogKey key, double value);
+
+        const LogKeyRegistry& keys;
+        std::vector<std::string> prefixes;
+        std::int64_t window;
+        std::size_t maxSamples;
+
+        // Whether each key matches a prefix, indexed by LogKey. Sized for
+        // every possible key because Wants() can run on any thread.
+        std::unique_ptr<std::atomic<Match>[]> matches;
+
+        std::mutex mutex;
+        // Indexed by LogKey; only tracked keys ever grow it
+        std::vector<Accumulator> accumulators;
+        // Keys that got values this window, so Collect() skips the rest
+        std::vector<LogKey> active;
+        std::int64_t windowStart = 0;
+        std::uint64_t random = 0x9E3779B97F4A7C15;
+    };
+}  // namespace nfr
@@ -27,20 +27,58 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
 #include <memory>
+#include <mutex>
 #include <span>
-#include <sstream>
 #include <streambuf>  // Include for std::streambuf
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "logging/AsyncLogWriter.h"
+#include "logging/FlightRecorder.h"
+#include "logging/LogKeyRegistry.h"
+#include "logging/LogLevel.h"
+#include "logging/LogProfiler.h"
+#include "logging/LogSink.h"
+#include "logging/LogStaging.h"
+#include "logging/LogStatistics.h"
 #include "logging/NTLogManager.h"
+#include "logging/TeeStreamBuf.h"
 #include "logging/WPILogManager.h"
 #include "units/base.h"
 #include "wpi/struct/Struct.h"
+#include "wpi/timestamp.h"
 
 namespace nfr
 {
     class LogContext;
+    template <LogSink... Sinks>
+    class BasicLogger;
+
+    /**
+     * @brief The robot's logger type
+     *
+     * Building with NFR_WPILOG_ONLY defined (`./gradlew build -PwpilogOnly`)
+     * leaves NetworkTables out entirely, so every write compiles down to the
+     * WPILog and flight recorder calls alone. New sinks are added to this
+     * list.
+     */
+#ifdef NFR_WPILOG_ONLY
+    using Logger = BasicLogger<WPILogManager, FlightRecorder, LogStatistics>;
+#else
+    using Logger = BasicLogger<WPILogManager, NTLogManager, FlightRecorder,
+                               LogStatistics>;
+#endif
 
     // === TEMPLATE CONCEPTS FOR TYPE SAFETY ===
     // These concepts determine which types can be logged and how
@@ -88,7 +126,6 @@ namespace nfr
         { t->Log(logContext) } -> std::same_as<void>;
     };
 
-    class Logger;
     /**
      * @brief Context for logging data with hierarchical keys
      *
@@ -99,6 +136,8 @@ namespace nfr
      * ## Key Structure:
      * Keys are like file paths: "robot/drivetrain/frontLeft/speed"
      * This creates a nested structure that's easy to navigate in log viewers.
+     * Internally each path is interned once into a LogKey handle, so a
+     * LogContext is just a handle and a logger pointer.
      *
      * ## Example Usage:
      * ```cpp
@@ -107,15 +146,28 @@ namespace nfr
      * robotLog["drivetrain"]["speed"] << 2.5;
      * ```
      *
+     * ## Levels:
+     * Every context is tagged with a LogLevel (kInfo by default; children
+     * inherit their parent's). If the tag is below the threshold the logger
+     * has for the key, the context is disabled: writes to it do nothing and
+     * objects' Log() functions aren't called at all, so whole subtrees of
+     * diagnostics cost one check. Tag debug-only values with NFR_LOG_DEBUG,
+     * which also strips them from builds compiled above debug:
+     * ```cpp
+     * NFR_LOG_DEBUG(log["odometry_residual"]) << ComputeResidual();
+     * ```
+     *
      * ## Design Notes:
-     * - Move-only type (can't be copied) for performance
+     * - Move-only type (can't be copied) to keep contexts scoped
+     * - Nested lookups reuse interned keys, so they don't allocate
      * - Supports many data types via operator<< overloads
      * - Uses template concepts to determine how to log different types
      */
     class LogContext
     {
     public:
-        LogContext(const std::string_view& key, Logger* logger);
+        LogContext(LogKey key, Logger* logger,
+                   LogLevel level = LogLevel::kInfo);
         LogContext(const LogContext&) = delete;
         LogContext& operator=(const LogContext&) = delete;
 
@@ -153,7 +205,10 @@ namespace nfr
             requires ExistsLogMethodFor<T>
         const LogContext& operator<<(const T& value) const
         {
-            Log(*this, value);  // Call the standalone Log() function
+            if (enabled)
+            {
+                Log(*this, value);  // Call the standalone Log() function
+            }
             return *this;
         }
 
@@ -167,7 +222,7 @@ namespace nfr
             requires HasPointerLogMethod<T>
         const LogContext& operator<<(T&& value) const
         {
-            if (value)  // Check for null pointer
+            if (enabled && value)  // Check for null pointer
             {
                 value->Log(*this);
             }
@@ -183,7 +238,7 @@ namespace nfr
             requires ExistsPointerLogMethodFor<T>
         const LogContext& operator<<(const T* value) const
         {
-            if (value)  // Check for null pointer
+            if (enabled && value)  // Check for null pointer
             {
                 Log(*this, *value);
             }
@@ -200,7 +255,48 @@ namespace nfr
             requires HasLogMethod<T>
         const LogContext& operator<<(const T& value) const
         {
-            value.Log(*this);  // Call the object's Log() method
+            if (enabled)
+            {
+                value.Log(*this);  // Call the object's Log() method
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Logs a value computed only if some sink will write it
+         *
+         * The function runs when the context is enabled and at least one
+         * enabled sink wants the key right now, i.e. it isn't decimating
+         * this sample away. Change filters still apply to the result, since
+         * they need the value to compare. Sinks that keep everything (the
+         * flight recorder) always want the value.
+         * ```cpp
+         * log["residual"] << [&] { return ComputeResidual(); };
+         * ```
+         */
+        template <typename F>
+            requires std::invocable<F&> &&
+                     (!std::is_void_v<std::invoke_result_t<F&>>)
+        const LogContext& operator<<(F&& compute) const;
+
+        /**
+         * @brief Runs a function that logs a group of values into this
+         *        context, only if the context is enabled
+         *
+         * For diagnostics that take work to compute:
+         * ```cpp
+         * NFR_LOG_DEBUG(log["Robot3d"]) << [&](const LogContext& log)
+         * { log["arm"] << ComputeArmPose(); };
+         * ```
+         */
+        template <typename F>
+            requires std::invocable<F&, const LogContext&>
+        const LogContext& operator<<(F&& write) const
+        {
+            if (enabled)
+            {
+                write(*this);
+            }
             return *this;
         }
 
@@ -214,9 +310,33 @@ namespace nfr
          * @param newKey The sub-key to append
          * @return New LogContext for the nested key
          */
-        LogContext operator[](std::string_view newKey) const
+        LogContext operator[](std::string_view newKey) const;
+
+        /**
+         * @brief The same key tagged with another level
+         *
+         * Prefer the NFR_LOG_DEBUG style macros, which also strip statements
+         * below the compiled level.
+         */
+        LogContext At(LogLevel newLevel) const
+        {
+            return LogContext{key, logger, newLevel};
+        }
+
+        /** @brief Whether values written here reach the sinks */
+        bool IsEnabled() const
+        {
+            return enabled;
+        }
+
+        explicit operator bool() const
+        {
+            return enabled;
+        }
+
+        LogLevel GetLevel() const
         {
-            return LogContext{key + "/" + std::string(newKey), logger};
+            return level;
         }
 
         Logger* GetLogger() const
@@ -224,140 +344,1012 @@ namespace nfr
             return logger;
         }
 
-        std::string GetKey() const
+        /** @brief Gets the interned handle for this context's key */
+        LogKey GetKey() const
         {
             return key;
         }
 
+        /** @brief Gets the full key path, e.g. "robot/drive/pose" */
+        std::string_view GetPath() const;
+
     private:
-        std::string key;
+        LogKey key;
         Logger* logger;
+        LogLevel level;
+        bool enabled;
     };
 
-    // New custom streambuf to duplicate output
-    class TeeStreamBuf : public std::streambuf
+    /**
+     * @brief Logs to a context only at a level, skipping the whole statement
+     *        (arguments included) when that level is off
+     *
+     * Below the compiled level (NFR_LOG_LEVEL) the statement is discarded at
+     * compile time; above it, the runtime threshold for the key is checked
+     * before anything on the right of `<<` is evaluated.
+     */
+#define NFR_LOG_AT(level, context)                                     \
+    if constexpr ((level) < ::nfr::kCompiledLogLevel)                  \
+    {                                                                  \
+    }                                                                  \
+    else if (auto nfrLogContext = (context).At(level); !nfrLogContext) \
+    {                                                                  \
+    }                                                                  \
+    else                                                               \
+        nfrLogContext
+
+#define NFR_LOG_DEBUG(context) NFR_LOG_AT(::nfr::LogLevel::kDebug, context)
+#define NFR_LOG_INFO(context) NFR_LOG_AT(::nfr::LogLevel::kInfo, context)
+#define NFR_LOG_CRITICAL(context) \
+    NFR_LOG_AT(::nfr::LogLevel::kCritical, context)
+
+    /**
+     * @brief Logger that writes to a fixed, compile-time list of sinks
+     *
+     * Each sink is optional at runtime (it exists once enabled), but the set
+     * of sink types is part of the logger's type, so writing a value is a
+     * fold over the sinks with no virtual calls; the compiler can inline the
+     * whole write path.
+     *
+     * Sinks are constructed with the key registry as their first argument
+     * (see LogSink). The robot uses the `Logger` alias; other combinations
+     * (e.g. with a mock sink) can be used through Log() directly.
+     *
+     * ## Threads:
+     * The thread that constructs the logger is the robot thread: it writes
+     * to the sinks (or the async queue) directly, and is the only one that
+     * may call the Enable*(), frame and Flush() functions. Values can be
+     * logged from any other thread too (notifiers, odometry, vision). They
+     * go into a buffer owned by that thread, stamped with the time they were
+     * logged, and reach the sinks at the next Flush() or, with async
+     * logging, on the writer thread. No lock is shared between producers.
+     */
+    template <LogSink... Sinks>
+    class BasicLogger
     {
     public:
-        // Constructor takes the primary buffer (for original destination)
-        // and a secondary stringstream (for logging)
-        TeeStreamBuf(std::streambuf* primaryBuf,
-                     std::shared_ptr<std::stringstream> logStream)
-            : primary_buf_(primaryBuf), log_stream_(logStream)
+        BasicLogger();
+        // Delete copy constructor and assignment operator
+        BasicLogger(const BasicLogger&) = delete;
+        BasicLogger& operator=(const BasicLogger&) = delete;
+
+        /** @brief Puts the original cout/cerr buffers back */
+        ~BasicLogger();
+
+        /** @brief Whether Sink is one of this logger's sink types */
+        template <typename Sink>
+        static constexpr bool kHasSink = (std::is_same_v<Sink, Sinks> || ...);
+
+        void Log(LogKey key, double value)
+        {
+            Submit(key, value);
+        }
+        void Log(LogKey key, long value)
+        {
+            Submit(key, value);
+        }
+        void Log(LogKey key, bool value)
+        {
+            Submit(key, value);
+        }
+        void Log(LogKey key, const std::string_view& value)
+        {
+            Submit(key, value);
+        }
+        void Log(LogKey key, std::span<double> values)
+        {
+            Submit(key, values);
+        }
+        void Log(LogKey key, std::span<long> values)
+        {
+            Submit(key, values);
+        }
+        void Log(LogKey key, std::span<bool> values)
+        {
+            Submit(key, values);
+        }
+        void Log(LogKey key, std::span<std::string_view> values)
+        {
+            Submit(key, values);
+        }
+        template <typename T, typename... I>
+            requires wpi::StructSerializable<T, I...>
+        void Log(LogKey key, const T& value)
+        {
+            Submit(key, value);
+        }
+        template <typename T, typename... I>
+            requires wpi::StructSerializable<T, I...>
+        void Log(LogKey key, std::span<T> values)
         {
+            Submit(key, values);
         }
 
-    protected:
-        int_type overflow(int_type c) override
+        /**
+         * @brief Creates a sink if it doesn't exist yet
+         *
+         * @param args Constructor arguments after the key registry
+         * @return The sink
+         */
+        template <typename Sink, typename... Args>
+            requires kHasSink<Sink>
+        Sink& EnableSink(Args&&... args)
         {
-            if (c == traits_type::eof())
+            auto& sink = std::get<std::unique_ptr<Sink>>(sinks_);
+            if (!sink)
             {
-                return traits_type::eof();
+                // The writer thread owns the sinks while it runs, so stop it
+                // while a sink is added and start it again afterwards
+                std::size_t asyncCapacity = GetAsyncStats().capacity;
+                async_writer_.reset();
+                sink = std::make_unique<Sink>(keys_,
+                                              std::forward<Args>(args)...);
+                if (asyncCapacity > 0)
+                {
+                    EnableAsyncLogging(asyncCapacity);
+                }
             }
+            return *sink;
+        }
 
-            // Write to the primary buffer (original destination)
-            if (primary_buf_->sputc(c) == traits_type::eof())
+        /**
+         * @brief Starts publishing to NetworkTables
+         *
+         * Does nothing if this logger was built without the NT sink.
+         *
+         * @param tableName Table that all topics are published under
+         * @param filter Rules for skipping values that haven't changed
+         * @param budget Byte cap and per-prefix rates for what gets
+         *               published; its counters are logged under
+         *               "logger/nt"
+         */
+        void EnableNTLogging(const std::string_view& tableName = "logs",
+                             LogChangeFilter filter = {},
+                             LogBandwidthBudget budget = {})
+        {
+            if constexpr (kHasSink<NTLogManager>)
             {
-                return traits_type::eof();
+                nt_stats_key_ = keys_.Child(kRootLogKey, "logger/nt");
+                EnableSink<NTLogManager>(tableName, std::move(filter),
+                                         std::move(budget));
             }
-
-            // Write to the logging stringstream
-            log_stream_->put(c);
-
-            return c;
         }
 
-        int sync() override
+        /**
+         * @brief Writes every value of a key to WPILog, whatever the
+         *        decimation (any thread)
+         *
+         * For keys whose values are each only logged once, like the summaries
+         * and samples captured between cycles (see BeginSample()).
+         */
+        void KeepEvery(LogKey key)
         {
-            int ret = 0;
-            if (primary_buf_->pubsync() == -1)
+            if constexpr (kHasSink<WPILogManager>)
             {
-                ret = -1;
+                if (auto* wpilog = GetSink<WPILogManager>())
+                {
+                    wpilog->KeepEvery(key);
+                }
             }
-            // No explicit sync needed for stringstream as it buffers
-            // internally.
-            return ret;
         }
 
-    private:
-        std::streambuf* primary_buf_;  // Original streambuf (e.g., std::cout's
-                                       // original buffer)
-        std::shared_ptr<std::stringstream>
-            log_stream_;  // Stringstream for logger
-    };
-
-    class Logger
-    {
-    public:
-        Logger();
-        // Delete copy constructor and assignment operator
-        Logger(const Logger&) = delete;
-        Logger& operator=(const Logger&) = delete;
-        void Log(const std::string_view& key, double value);
-        void Log(const std::string_view& key, long value);
-        void Log(const std::string_view& key, bool value);
-        void Log(const std::string_view& key, const std::string_view& value);
-        void Log(const std::string_view& key, std::span<double> values);
-        void Log(const std::string_view& key, std::span<long> values);
-        void Log(const std::string_view& key, std::span<bool> values);
-        void Log(const std::string_view& key,
-                 std::span<std::string_view> values);
-        template <typename T, typename... I>
-            requires wpi::StructSerializable<T, I...>
-        void Log(const std::string_view& key, const T& value)
+        /**
+         * @brief Replaces the NT sink's bandwidth budget, e.g. once the FMS
+         *        attaches
+         *
+         * Does nothing if NT logging isn't enabled.
+         */
+        void SetNTBandwidthBudget(LogBandwidthBudget budget)
         {
-            if (wpi_log_manager_)
+            if constexpr (kHasSink<NTLogManager>)
             {
-                wpi_log_manager_->Log(key, value);
+                if (auto* nt = GetSink<NTLogManager>())
+                {
+                    // The writer thread owns the sinks, so stop it while the
+                    // budget changes, as in EnableSink()
+                    std::size_t asyncCapacity = GetAsyncStats().capacity;
+                    async_writer_.reset();
+                    nt->SetBudget(std::move(budget));
+                    if (asyncCapacity > 0)
+                    {
+                        EnableAsyncLogging(asyncCapacity);
+                    }
+                }
             }
-            if (nt_log_manager_)
+        }
+
+        /**
+         * @brief Starts writing to the DataLogManager file
+         *
+         * @param decimation Write only every Nth value of each key
+         */
+        void EnableWPILogging(unsigned decimation = 1)
+        {
+            if constexpr (kHasSink<WPILogManager>)
             {
-                nt_log_manager_->Log(key, value);
+                EnableSink<WPILogManager>(decimation);
             }
         }
-        template <typename T, typename... I>
-            requires wpi::StructSerializable<T, I...>
-        void Log(const std::string_view& key, std::span<T> values)
+
+        /**
+         * @brief Starts keeping full-rate history in memory for dumps
+         *
+         * Does nothing if this logger was built without the flight recorder.
+         * Dumps are started with `GetSink<FlightRecorder>()->Trigger()`.
+         *
+         * @param window How much history a dump contains
+         * @param capacity Bytes of history kept (see FlightRecorder)
+         * @param excludedPrefixes Comma-separated key prefixes that are not
+         *        kept, so lazy values under them aren't computed just for
+         *        the recorder
+         */
+        void EnableFlightRecorder(
+            std::chrono::milliseconds window = std::chrono::seconds{10},
+            std::size_t capacity = 4 << 20,
+            std::string_view excludedPrefixes = {})
         {
-            if (wpi_log_manager_)
+            if constexpr (kHasSink<FlightRecorder>)
             {
-                wpi_log_manager_->Log(key, values);
+                EnableSink<FlightRecorder>(window, capacity,
+                                           excludedPrefixes);
             }
-            if (nt_log_manager_)
+        }
+
+        /**
+         * @brief Starts summarizing numeric keys over a window
+         *
+         * Does nothing if this logger was built without the statistics sink.
+         * Each window's summaries are logged under "stats" (see
+         * LogStatistics), and WPILog writes them without decimation. NT and
+         * WPILog get only the summaries of these keys, not their values;
+         * the flight recorder still gets every value.
+         *
+         * @param prefixes Comma-separated key prefixes to summarize
+         * @param window How long each summary covers
+         */
+        void EnableStatistics(
+            std::string_view prefixes,
+            std::chrono::milliseconds window = std::chrono::seconds{1})
+        {
+            if constexpr (kHasSink<LogStatistics>)
             {
-                nt_log_manager_->Log(key, values);
+                stats_key_ =
+                    keys_.Child(kRootLogKey, LogStatistics::kOutputPrefix);
+                EnableSink<LogStatistics>(prefixes, window);
             }
         }
-        void EnableNTLogging(const std::string_view& tableName = "logs");
-        void EnableWPILogging();
+
+        /**
+         * @brief Gets a sink, or nullptr if it isn't enabled
+         *
+         * Sinks are written from the async writer thread, so only call
+         * functions the sink documents as thread-safe.
+         */
+        template <typename Sink>
+            requires kHasSink<Sink>
+        Sink* GetSink()
+        {
+            return std::get<std::unique_ptr<Sink>>(sinks_).get();
+        }
+
+        /**
+         * @brief Moves sink writes onto a background writer thread
+         *
+         * After this call, Log() only encodes each value into a preallocated
+         * ring buffer; a writer thread replays them into the sinks. If the
+         * writer falls behind, records are dropped (and counted under
+         * "logger/async") rather than blocking the robot loop.
+         *
+         * @param bufferBytes Size of the ring buffer
+         */
+        void EnableAsyncLogging(std::size_t bufferBytes = 1 << 20);
+
+        /**
+         * @brief Stops the writer thread once it has written everything
+         *        queued; sinks are written from Log() again afterwards
+         *
+         * Call before the program exits so no queued values are lost.
+         */
+        void DisableAsyncLogging();
+
+        /**
+         * @brief Measures what each key costs in each sink
+         *
+         * Every sink write is timed and its serialized size counted. Once
+         * per period, Flush() publishes the most expensive key/sink pairs
+         * under "logger/profile" (keys, microseconds, bytes and calls per
+         * second, plus a readable table). Adds a lock and two clock reads
+         * per sink write, so leave it off at competitions.
+         *
+         * @param topCount Number of key/sink pairs in each report
+         * @param reportPeriod How often a report is published
+         */
+        void EnableProfiling(
+            std::size_t topCount = 10,
+            std::chrono::milliseconds reportPeriod = std::chrono::seconds{1});
+
+        /**
+         * @brief Starts a frame: everything logged until EndFrame() is
+         *        stamped with the time of this call
+         *
+         * Values logged in the same robot cycle then line up exactly in
+         * post-match analysis, and the sinks don't read the clock for every
+         * write. With async logging on, the frame's records are also held
+         * back and handed to the writer thread together at EndFrame().
+         *
+         * Call the Enable*() functions outside of frames.
+         */
+        void BeginFrame();
+
+        /**
+         * @brief Ends the current frame, committing its records
+         *
+         * Values logged after this are stamped with the time they are
+         * written. Does nothing if no frame is open.
+         */
+        void EndFrame();
+
+        /**
+         * @brief Stamps values logged until EndSample() with the time they
+         *        were captured, rather than the frame's or the current time
+         *
+         * For samples another thread captured between cycles (e.g. 200 Hz
+         * odometry) and the robot thread logs in a batch. Robot thread only;
+         * samples don't nest, and must end before the frame does.
+         *
+         * @param timestamp Capture time in microseconds (wpi::Now() base)
+         */
+        void BeginSample(std::int64_t timestamp);
+
+        /** @brief Goes back to the frame's (or the current) time */
+        void EndSample();
+
+        /**
+         * @brief Sets the threshold for keys no level rule matches
+         *
+         * Contexts tagged below it are disabled. Defaults to kDebug
+         * (everything compiled in is logged).
+         */
+        void SetLogLevel(LogLevel threshold);
+
+        /**
+         * @brief Replaces the per-prefix thresholds (see LogLevelRules)
+         *
+         * @param spec Rules like `robot/Robot3d=off,perf=critical`
+         * @return false (keeping the current rules) if spec is malformed
+         */
+        bool SetLogLevelRules(std::string_view spec);
+
+        /**
+         * @brief Whether a context for a key and level would be enabled
+         *        (any thread)
+         */
+        bool IsEnabled(LogKey key, LogLevel level) const;
+
+        /**
+         * @brief Whether any enabled sink would write the next value of a
+         *        key (any thread)
+         *
+         * If none would, the sinks count the value as offered and skipped,
+         * so decimation moves on as if it had been logged.
+         */
+        bool Wants(LogKey key);
+
+        /** @brief Async queue counters (all zero if async logging is off) */
+        AsyncLogStats GetAsyncStats() const
+        {
+            return async_writer_ ? async_writer_->GetStats() : AsyncLogStats{};
+        }
+
+        /** @brief Root log context (only for the robot's `Logger` type) */
         LogContext operator[](std::string_view key)
+            requires std::is_same_v<BasicLogger, Logger>
         {
-            return LogContext{std::string(key), this};
+            return LogContext{keys_.Child(kRootLogKey, key), this};
         }
+
+        /**
+         * @brief Ends a robot cycle's logging (robot thread)
+         *
+         * Logs captured console lines and queue statistics, and hands queued
+         * values on to the sinks.
+         */
         void Flush();
 
+        /** @brief Registry that maps hierarchical key paths to handles */
+        LogKeyRegistry& GetKeys()
+        {
+            return keys_;
+        }
+
     private:
-        std::unique_ptr<NTLogManager> nt_log_manager_{nullptr};
-        std::unique_ptr<WPILogManager> wpi_log_manager_{nullptr};
+        /**
+         * @brief Sends a value to the writer thread, or straight to the sinks
+         * when async logging is off
+         */
+        template <typename T>
+        void Submit(LogKey key, const T& value)
+        {
+            if (std::this_thread::get_id() != owner_thread_)
+            {
+                // Other threads aren't part of the robot's frames, so their
+                // values carry their own time
+                staging_.Push(key, &BasicLogger::ReplayTimestamped<T>,
+                              Timestamped<T>{
+                                  static_cast<std::int64_t>(wpi::Now()),
+                                  value});
+                return;
+            }
+            if (async_writer_)
+            {
+                async_writer_->Push(key, &BasicLogger::Replay<T>, value);
+            }
+            else
+            {
+                Write(key, value, frame_timestamp_);
+            }
+        }
+
+        /** @brief Decodes a queued record and writes it (writer thread) */
+        template <typename T>
+        static void Replay(void* target, LogKey key,
+                           std::span<std::byte> payload)
+        {
+            auto* logger = static_cast<BasicLogger*>(target);
+            LogRecordCodec<T>::Decode(
+                payload, [&](const auto& value)
+                { logger->Write(key, value, logger->replay_timestamp_); });
+        }
+
+        /** @brief Decodes a record staged by another thread and writes it */
+        template <typename T>
+        static void ReplayTimestamped(void* target, LogKey key,
+                                      std::span<std::byte> payload)
+        {
+            auto* logger = static_cast<BasicLogger*>(target);
+            LogRecordCodec<Timestamped<T>>::Decode(
+                payload, [&](std::int64_t timestamp, const auto& value)
+                { logger->Write(key, value, timestamp); });
+        }
+
+        /**
+         * @brief Replays a frame marker: records after it get its timestamp
+         *        (writer thread)
+         */
+        static void ReplayFrameTime(void* target, LogKey,
+                                    std::span<std::byte> payload)
+        {
+            auto* logger = static_cast<BasicLogger*>(target);
+            LogRecordCodec<std::int64_t>::Decode(
+                payload, [&](std::int64_t timestamp)
+                { logger->replay_timestamp_ = timestamp; });
+        }
+
+        /** @brief Fans a value out to every enabled sink */
+        template <typename T>
+        void Write(LogKey key, const T& value, std::int64_t timestamp)
+        {
+            if (profiler_)
+            {
+                WriteProfiled(key, value, timestamp,
+                              std::index_sequence_for<Sinks...>{});
+                return;
+            }
+            std::apply(
+                [&](auto&... sink)
+                {
+                    ((Receives(sink, key) ? sink->Log(key, value, timestamp)
+                                          : void()),
+                     ...);
+                },
+                sinks_);
+        }
+
+        /**
+         * @brief Whether a sink is enabled and gets the values of a key
+         *
+         * Sinks that only want summaries skip the keys the statistics sink
+         * summarizes (see LogSinkSummariesOnly()).
+         */
+        template <typename Sink>
+        bool Receives(const std::unique_ptr<Sink>& sink, LogKey key) const
+        {
+            if (!sink)
+            {
+                return false;
+            }
+            if constexpr (kHasSink<LogStatistics> &&
+                          LogSinkSummariesOnly<Sink>())
+            {
+                const auto& stats =
+                    std::get<std::unique_ptr<LogStatistics>>(sinks_);
+                return !stats || !stats->Wants(key);
+            }
+            return true;
+        }
+
+        /** @brief Write() that times each sink for the profiler */
+        template <typename T, std::size_t... Index>
+        void WriteProfiled(LogKey key, const T& value, std::int64_t timestamp,
+                           std::index_sequence<Index...>)
+        {
+            const std::size_t bytes = LogRecordCodec<T>::Size(value);
+            auto writeOne = [&](auto& sink, std::size_t index)
+            {
+                if (Receives(sink, key))
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    sink->Log(key, value, timestamp);
+                    profiler_->Record(key, index, bytes,
+                                      std::chrono::steady_clock::now() - start);
+                }
+            };
+            (writeOne(std::get<Index>(sinks_), Index), ...);
+        }
+
+        /** @brief Publishes the profiler's latest report, if one is due */
+        void LogProfileReport();
+
+        /** @brief Sets the time the robot thread's values are stamped with */
+        void SetWriteTime(std::int64_t timestamp);
+
+        /** @brief Logs the summaries of a statistics window that ended */
+        void LogSummaries();
+
+        // Declared before the sinks, which hold a reference to it
+        LogKeyRegistry keys_;
+        const std::thread::id owner_thread_ = std::this_thread::get_id();
+        LogKey cout_key_;
+        LogKey cerr_key_;
+
+        std::tuple<std::unique_ptr<Sinks>...> sinks_;
 
         // Store original streambufs
         std::streambuf* original_cout_buf_;
         std::streambuf* original_cerr_buf_;
 
-        // Stringstreams to capture cout/cerr for logging
-        std::shared_ptr<std::stringstream> cout_log_stream_;
-        std::shared_ptr<std::stringstream> cerr_log_stream_;
-
-        // Our tee streambufs
+        // Our tee streambufs, which capture cout/cerr as timestamped lines
         TeeStreamBuf cout_tee_buf_;
         TeeStreamBuf cerr_tee_buf_;
+
+        // Per-key cost profiling (off unless EnableProfiling() is called)
+        std::unique_ptr<LogProfiler> profiler_{nullptr};
+        std::vector<LogProfiler::Row> profile_rows_;
+
+        // Reused for every statistics window's summaries
+        std::vector<LogSummary> summaries_;
+        LogKey stats_key_{kRootLogKey};
+        LogKey profile_key_{kRootLogKey};
+
+        // Time of the open frame, or 0 outside of frames (robot thread)
+        std::int64_t frame_timestamp_ = 0;
+        // frame_timestamp_ from before BeginSample() (robot thread)
+        std::int64_t sample_saved_timestamp_ = 0;
+        // Time from the last frame marker replayed (writer thread)
+        std::int64_t replay_timestamp_ = 0;
+
+        // Values logged from other threads, drained by Flush() or by the
+        // writer thread
+        LogStaging staging_;
+        LogKey staging_stats_key_{kRootLogKey};
+        LogKey nt_stats_key_{kRootLogKey};
+
+        /** @brief Threshold the rules give a key, or kNoLevelRule */
+        LogLevel RuleThreshold(LogKey key) const;
+
+        // Verbosity: the global threshold, plus prefix rules that are only
+        // consulted while there are any
+        std::atomic<LogLevel> log_level_{LogLevel::kDebug};
+        std::atomic<bool> has_level_rules_{false};
+        LogLevelRules level_rules_;
+        mutable std::mutex level_mutex_;
+        // Each key's rule threshold, resolved (under the mutex) the first
+        // time it is checked after the rules change. An entry is the rules'
+        // generation shifted left 8 bits, plus the threshold; SetLogLevelRules
+        // bumps the generation, so older entries no longer match. Indexed by
+        // LogKey and sized for every possible key, since any thread checks.
+        static constexpr auto kNoLevelRule = static_cast<LogLevel>(0xFF);
+        std::atomic<std::uint32_t> level_rules_generation_{1};
+        std::unique_ptr<std::atomic<std::uint32_t>[]> key_thresholds_{
+            std::make_unique<std::atomic<std::uint32_t>[]>(
+                LogKeyRegistry::Capacity())};
+
+        // Declared last so the writer thread stops before the sinks it writes
+        // to are destroyed
+        std::unique_ptr<AsyncLogWriter> async_writer_{nullptr};
+        LogKey async_stats_key_{kRootLogKey};
     };
 
+    template <LogSink... Sinks>
+    BasicLogger<Sinks...>::BasicLogger()
+        // Save original streambufs
+        : original_cout_buf_(std::cout.rdbuf()),
+          original_cerr_buf_(std::cerr.rdbuf()),
+          // Initialize tee streambufs with the original destinations
+          cout_tee_buf_(original_cout_buf_),
+          cerr_tee_buf_(original_cerr_buf_)
+    {
+        cout_key_ = keys_.Child(kRootLogKey, "cout");
+        cerr_key_ = keys_.Child(kRootLogKey, "cerr");
+        staging_stats_key_ = keys_.Child(kRootLogKey, "logger/threads");
+
+        // Set cout and cerr to use our tee streambufs
+        std::cout.rdbuf(&cout_tee_buf_);
+        std::cerr.rdbuf(&cerr_tee_buf_);
+    }
+
+    template <LogSink... Sinks>
+    BasicLogger<Sinks...>::~BasicLogger()
+    {
+        std::cout.rdbuf(original_cout_buf_);
+        std::cerr.rdbuf(original_cerr_buf_);
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::EnableAsyncLogging(std::size_t bufferBytes)
+    {
+        if (!async_writer_)
+        {
+            async_stats_key_ = keys_.Child(kRootLogKey, "logger/async");
+            async_writer_ =
+                std::make_unique<AsyncLogWriter>(bufferBytes, this, &staging_);
+        }
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::SetLogLevel(LogLevel threshold)
+    {
+        log_level_.store(threshold, std::memory_order_relaxed);
+    }
+
+    template <LogSink... Sinks>
+    bool BasicLogger<Sinks...>::SetLogLevelRules(std::string_view spec)
+    {
+        auto rules = LogLevelRules::Parse(spec);
+        if (!rules)
+        {
+            return false;
+        }
+        std::scoped_lock lock{level_mutex_};
+        level_rules_ = std::move(*rules);
+        level_rules_generation_.fetch_add(1, std::memory_order_release);
+        has_level_rules_.store(!level_rules_.Empty(),
+                               std::memory_order_release);
+        return true;
+    }
+
+    template <LogSink... Sinks>
+    LogLevel BasicLogger<Sinks...>::RuleThreshold(LogKey key) const
+    {
+        const std::uint32_t generation =
+            level_rules_generation_.load(std::memory_order_acquire) & 0xFFFFFF;
+        auto& entry = key_thresholds_[key];
+        std::uint32_t cached = entry.load(std::memory_order_relaxed);
+        if ((cached >> 8) != generation)
+        {
+            // Racing threads store the same answer, or one for older rules
+            // that the next check resolves again
+            std::scoped_lock lock{level_mutex_};
+            const std::uint32_t current =
+                level_rules_generation_.load(std::memory_order_relaxed) &
+                0xFFFFFF;
+            const LogLevel threshold =
+                level_rules_.Find(keys_.Path(key)).value_or(kNoLevelRule);
+            cached = (current << 8) | static_cast<std::uint32_t>(threshold);
+            entry.store(cached, std::memory_order_relaxed);
+        }
+        return static_cast<LogLevel>(cached & 0xFF);
+    }
+
+    template <LogSink... Sinks>
+    bool BasicLogger<Sinks...>::IsEnabled(LogKey key, LogLevel level) const
+    {
+        if (level < kCompiledLogLevel)
+        {
+            return false;
+        }
+        LogLevel threshold = log_level_.load(std::memory_order_relaxed);
+        if (has_level_rules_.load(std::memory_order_acquire))
+        {
+            if (LogLevel rule = RuleThreshold(key); rule != kNoLevelRule)
+            {
+                threshold = rule;
+            }
+        }
+        return level >= threshold;
+    }
+
+    template <LogSink... Sinks>
+    bool BasicLogger<Sinks...>::Wants(LogKey key)
+    {
+        bool wanted = std::apply(
+            [&](auto&... sink)
+            { return ((sink && LogSinkWants(*sink, key)) || ...); },
+            sinks_);
+        if (!wanted)
+        {
+            std::apply(
+                [&](auto&... sink)
+                {
+                    ((sink ? LogSinkSkip(*sink, key) : void()), ...);
+                },
+                sinks_);
+        }
+        return wanted;
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::DisableAsyncLogging()
+    {
+        // The writer drains the ring and every thread's buffer before its
+        // thread exits
+        async_writer_.reset();
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::BeginFrame()
+    {
+        frame_timestamp_ = static_cast<std::int64_t>(wpi::Now());
+        if (async_writer_)
+        {
+            // The writer thread learns the frame's time from a marker record
+            // queued ahead of the frame's values
+            async_writer_->BeginBatch();
+            async_writer_->Push(kRootLogKey, &BasicLogger::ReplayFrameTime,
+                                frame_timestamp_);
+        }
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::EndFrame()
+    {
+        if (frame_timestamp_ == 0)
+        {
+            return;
+        }
+        frame_timestamp_ = 0;
+        if (async_writer_)
+        {
+            async_writer_->Push(kRootLogKey, &BasicLogger::ReplayFrameTime,
+                                std::int64_t{0});
+            async_writer_->EndBatch();
+        }
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::EnableProfiling(
+        std::size_t topCount, std::chrono::milliseconds reportPeriod)
+    {
+        if (!profiler_)
+        {
+            // The writer thread reads profiler_, so pause it like EnableSink
+            std::size_t asyncCapacity = GetAsyncStats().capacity;
+            async_writer_.reset();
+            profile_key_ = keys_.Child(kRootLogKey, "logger/profile");
+            profiler_ = std::make_unique<LogProfiler>(
+                std::vector<std::string_view>{LogSinkName<Sinks>()...},
+                topCount, reportPeriod);
+            if (asyncCapacity > 0)
+            {
+                EnableAsyncLogging(asyncCapacity);
+            }
+        }
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::BeginSample(std::int64_t timestamp)
+    {
+        sample_saved_timestamp_ = frame_timestamp_;
+        SetWriteTime(timestamp);
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::EndSample()
+    {
+        SetWriteTime(sample_saved_timestamp_);
+        sample_saved_timestamp_ = 0;
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::SetWriteTime(std::int64_t timestamp)
+    {
+        // Works like a frame: direct writes read frame_timestamp_, and the
+        // writer thread picks the time up from a marker queued in order
+        frame_timestamp_ = timestamp;
+        if (async_writer_)
+        {
+            async_writer_->Push(kRootLogKey, &BasicLogger::ReplayFrameTime,
+                                timestamp);
+        }
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::LogSummaries()
+    {
+        static constexpr std::array<std::string_view, 7> kStatNames = {
+            "min", "max", "mean", "stddev", "p50", "p90", "p99"};
+        static constexpr std::array<std::string_view, 1> kCountName = {
+            "count"};
+
+        for (const auto& summary : summaries_)
+        {
+            LogKey parent = keys_.Child(stats_key_, keys_.Path(summary.key));
+            auto statKeys = keys_.Children(parent, kStatNames);
+            LogKey countKey = keys_.Children(parent, kCountName)[0];
+            const std::array<double, kStatNames.size()> values = {
+                summary.min, summary.max, summary.mean, summary.stddev,
+                summary.p50, summary.p90, summary.p99};
+
+            // One summary per window is already a low rate; decimating it
+            // as well would leave gaps
+            KeepEvery(countKey);
+            for (LogKey key : statKeys)
+            {
+                KeepEvery(key);
+            }
+
+            Log(countKey, static_cast<long>(summary.count));
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                Log(statKeys[i], values[i]);
+            }
+        }
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::LogProfileReport()
+    {
+        std::chrono::nanoseconds elapsed;
+        if (!profiler_->TakeReport(profile_rows_, elapsed))
+        {
+            return;
+        }
+
+        // Report rates so periods of different lengths compare directly
+        const double perSecond =
+            1.0 / std::chrono::duration<double>(elapsed).count();
+        std::vector<std::string> names;
+        std::vector<double> micros;
+        std::vector<double> bytes;
+        std::vector<double> calls;
+        std::string table = "us/s      bytes/s   calls/s   key (sink)";
+        for (const auto& row : profile_rows_)
+        {
+            names.push_back(std::string{keys_.Path(row.key)} + " (" +
+                            std::string{profiler_->SinkName(row.sink)} + ")");
+            micros.push_back(row.cost.nanoseconds * 1e-3 * perSecond);
+            bytes.push_back(row.cost.bytes * perSecond);
+            calls.push_back(row.cost.calls * perSecond);
+
+            char line[64];
+            std::snprintf(line, sizeof(line), "\n%-9.1f %-9.0f %-9.1f ",
+                          micros.back(), bytes.back(), calls.back());
+            table += line;
+            table += names.back();
+        }
+
+        std::vector<std::string_view> nameViews(names.begin(), names.end());
+        Log(keys_.Child(profile_key_, "keys"),
+            std::span<std::string_view>{nameViews});
+        Log(keys_.Child(profile_key_, "us_per_s"), std::span<double>{micros});
+        Log(keys_.Child(profile_key_, "bytes_per_s"), std::span<double>{bytes});
+        Log(keys_.Child(profile_key_, "calls_per_s"), std::span<double>{calls});
+        Log(keys_.Child(profile_key_, "table"), table);
+    }
+
+    template <LogSink... Sinks>
+    void BasicLogger<Sinks...>::Flush()
+    {
+        // Only complete lines are logged, and nothing at all on quiet cycles
+        if (auto lines = cout_tee_buf_.TakeLines(); !lines.empty())
+        {
+            Log(cout_key_, lines);
+        }
+        if (auto lines = cerr_tee_buf_.TakeLines(); !lines.empty())
+        {
+            Log(cerr_key_, lines);
+        }
+
+        if (!async_writer_)
+        {
+            // Without a writer thread, this thread writes other threads'
+            // values to the sinks
+            staging_.Drain(this);
+        }
+        if (auto stats = staging_.GetStats(); stats.threads > 0)
+        {
+            Log(keys_.Child(staging_stats_key_, "count"),
+                static_cast<long>(stats.threads));
+            Log(keys_.Child(staging_stats_key_, "queued"),
+                static_cast<long>(stats.queued));
+            Log(keys_.Child(staging_stats_key_, "dropped"),
+                static_cast<long>(stats.dropped));
+        }
+
+        if constexpr (kHasSink<LogStatistics>)
+        {
+            auto* stats = GetSink<LogStatistics>();
+            if (stats &&
+                stats->Collect(static_cast<std::int64_t>(wpi::Now()),
+                               summaries_))
+            {
+                LogSummaries();
+            }
+        }
+
+        if constexpr (kHasSink<NTLogManager>)
+        {
+            if (auto* nt = GetSink<NTLogManager>())
+            {
+                auto stats = nt->GetBandwidthStats();
+                Log(keys_.Child(nt_stats_key_, "sent"),
+                    static_cast<long>(stats.sent));
+                Log(keys_.Child(nt_stats_key_, "bytes"),
+                    static_cast<long>(stats.bytes));
+                Log(keys_.Child(nt_stats_key_, "deferred"),
+                    static_cast<long>(stats.deferred));
+                Log(keys_.Child(nt_stats_key_, "rate_limited"),
+                    static_cast<long>(stats.rateLimited));
+            }
+        }
+
+        if (async_writer_)
+        {
+            auto stats = async_writer_->GetStats();
+            Log(keys_.Child(async_stats_key_, "queued"),
+                static_cast<long>(stats.queued));
+            Log(keys_.Child(async_stats_key_, "dropped"),
+                static_cast<long>(stats.dropped));
+            Log(keys_.Child(async_stats_key_, "written"),
+                static_cast<long>(stats.written));
+            Log(keys_.Child(async_stats_key_, "peak_usage"),
+                static_cast<long>(stats.peakUsage));
+
+            // End of the robot cycle: let the writer pick up this cycle's
+            // records (EndFrame() does this once the frame is committed)
+            if (frame_timestamp_ == 0)
+            {
+                async_writer_->Wake();
+            }
+        }
+
+        if (profiler_)
+        {
+            LogProfileReport();
+        }
+    }
+
+    inline LogContext LogContext::operator[](std::string_view newKey) const
+    {
+        return LogContext{logger->GetKeys().Child(key, newKey), logger, level};
+    }
+
+    inline std::string_view LogContext::GetPath() const
+    {
+        return logger->GetKeys().Path(key);
+    }
+
+    template <typename F>
+        requires std::invocable<F&> &&
+                 (!std::is_void_v<std::invoke_result_t<F&>>)
+    const LogContext& LogContext::operator<<(F&& compute) const
+    {
+        if (enabled && logger->Wants(key))
+        {
+            *this << compute();
+        }
+        return *this;
+    }
+
     template <typename T>
         requires wpi::StructSerializable<T>
     inline const LogContext& operator<<(const LogContext& logContext,
                                         const T& t)
     {
-        logContext.GetLogger()->Log(logContext.GetKey(), t);
+        if (logContext.IsEnabled())
+        {
+            logContext.GetLogger()->Log(logContext.GetKey(), t);
+        }
         return logContext;
     }
 
@@ -366,7 +1358,10 @@ namespace nfr
     inline const LogContext& operator<<(const LogContext& logContext,
                                         std::span<T> values)
     {
-        logContext.GetLogger()->Log(logContext.GetKey(), values);
+        if (logContext.IsEnabled())
+        {
+            logContext.GetLogger()->Log(logContext.GetKey(), values);
+        }
         return logContext;
     }
 
@@ -380,7 +1375,13 @@ namespace nfr
         requires IsStructArray<T>
     inline const LogContext& operator<<(const LogContext& logContext, T values)
     {
-        logContext.GetLogger()->Log(logContext.GetKey(), std::span(values));
+        if (logContext.IsEnabled())
+        {
+            // Dynamic extent: Log() can't deduce from a fixed-size span
+            logContext.GetLogger()->Log(
+                logContext.GetKey(),
+                std::span<typename T::value_type>(values));
+        }
         return logContext;
     }
 
@@ -389,8 +1390,11 @@ namespace nfr
     inline const LogContext& operator<<(const LogContext& logContext,
                                         const T& t)
     {
-        logContext.GetLogger()->Log(logContext.GetKey(),
-                                    static_cast<double>(t));
+        if (logContext.IsEnabled())
+        {
+            logContext.GetLogger()->Log(logContext.GetKey(),
+                                        static_cast<double>(t));
+        }
         return logContext;
     }
 
@@ -399,11 +1403,17 @@ namespace nfr
     inline const LogContext& operator<<(const LogContext& logContext,
                                         std::span<T> values)
     {
-        std::vector<double> double_values;
-        double_values.reserve(values.size());
-        for (const auto& v : values)
+        if (!logContext.IsEnabled())
+        {
+            return logContext;
+        }
+        // Reused between calls so steady-state logging doesn't allocate. The
+        // sinks (and the async ring) copy the values before this returns.
+        thread_local std::vector<double> double_values;
+        double_values.resize(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i)
         {
-            double_values.push_back(static_cast<double>(v));
+            double_values[i] = static_cast<double>(values[i]);
         }
         logContext.GetLogger()->Log(logContext.GetKey(),
                                     std::span<double>{double_values});
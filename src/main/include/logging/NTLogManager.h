@@ -11,15 +11,22 @@
 #include <networktables/StructArrayTopic.h>
 #include <networktables/StructTopic.h>
 
+#include <cstdint>
 #include <memory>
 #include <span>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 #include <variant>
+#include <vector>
 
+#include "logging/LogBandwidthBudget.h"
+#include "logging/LogChangeFilter.h"
+#include "logging/LogKeyRegistry.h"
+#include "logging/StructSlots.h"
 #include "networktables/Topic.h"
 #include "wpi/struct/Struct.h"
+#include "wpi/timestamp.h"
 
 namespace nt
 {
@@ -29,109 +36,331 @@ namespace nt
 namespace nfr
 {
     /**
-     * @brief A logging manager that writes logs to a file.
+     * @brief A logging manager that publishes logs to NetworkTables.
+     *
+     * Each topic remembers the last value it published, and values that
+     * haven't changed (according to the LogChangeFilter) are skipped before
+     * they reach NT.
+     *
+     * With a LogBandwidthBudget, changed values also have to fit their key's
+     * rate and the byte cap. Values that don't are dropped; since the change
+     * filter compares against the last value published, a key logged every
+     * cycle gets its newest value out once there is room. Keys that are only
+     * logged now and then need priority 0, which the byte cap never holds
+     * back (see LogBandwidthLimiter).
      */
     class NTLogManager
     {
     public:
-        NTLogManager(const std::string_view &tableName = "logs");
+        static constexpr std::string_view kName = "nt";
+        /** @brief Summarized keys arrive as summaries (see LogStatistics) */
+        static constexpr bool kSummariesOnly = true;
+
+        /**
+         * @param keys Registry used to look up the topic name for a key
+         * @param tableName NetworkTable that all topics are published under
+         * @param filter Rules for skipping unchanged values
+         * @param budget Limits on how much gets published
+         */
+        NTLogManager(const LogKeyRegistry &keys,
+                     const std::string_view &tableName = "logs",
+                     LogChangeFilter filter = {},
+                     LogBandwidthBudget budget = {});
+
+        /**
+         * @brief Replaces the bandwidth budget
+         *
+         * Only while nothing else is logging to this sink (see
+         * BasicLogger::SetNTBandwidthBudget()).
+         */
+        void SetBudget(LogBandwidthBudget budget)
+        {
+            limiter.SetBudget(std::move(budget));
+        }
+
+        /**
+         * @brief Whether the key's rate allows publishing another value now
+         *
+         * Lets the logger skip computing lazy values the budget would drop.
+         * Whether the value changed, and whether it fits the byte cap, can't
+         * be known before it is computed. Safe to call from any thread.
+         */
+        bool Wants(LogKey key) const
+        {
+            return limiter.Wants(key, static_cast<std::int64_t>(wpi::Now()));
+        }
+
+        /**
+         * @brief What the bandwidth budget has let through so far
+         *
+         * Safe to call from any thread.
+         */
+        LogBandwidthStats GetBandwidthStats() const
+        {
+            return limiter.GetStats();
+        }
+
         /**
          * @brief Logs a double value to a file.
          * @param key The key/name for the log entry.
          * @param value The double value to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, double value);
+        void Log(LogKey key, double value, std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a long integer value to a file.
          * @param key The key/name for the log entry.
          * @param value The long integer value to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, long value);
+        void Log(LogKey key, long value, std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a boolean value to a file.
          * @param key The key/name for the log entry.
          * @param value The boolean value to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, bool value);
+        void Log(LogKey key, bool value, std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a string value to a file.
          * @param key The key/name for the log entry.
          * @param value The string value to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, const std::string_view &value);
+        void Log(LogKey key, const std::string_view &value,
+                 std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a span of double values to a file.
          * @param key The key/name for the log entry.
          * @param values The span of double values to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, std::span<double> values);
+        void Log(LogKey key, std::span<double> values,
+                 std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a span of long integer values to a file.
          * @param key The key/name for the log entry.
          * @param values The span of long integer values to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, std::span<long> values);
+        void Log(LogKey key, std::span<long> values,
+                 std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a span of boolean values to a file.
          * @param key The key/name for the log entry.
          * @param values The span of boolean values to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key, std::span<bool> values);
+        void Log(LogKey key, std::span<bool> values,
+                 std::int64_t timestamp = 0);
 
         /**
          * @brief Logs a span of string values to a file.
          * @param key The key/name for the log entry.
          * @param values The span of string values to log.
+         * @param timestamp Time in microseconds, or 0 for now.
          */
-        void Log(const std::string_view &key,
-                 std::span<std::string_view> values);
+        void Log(LogKey key, std::span<std::string_view> values,
+                 std::int64_t timestamp = 0);
 
         template <typename T, typename... I>
             requires wpi::StructSerializable<T, I...>
-        void Log(const std::string_view &key, const T &value)
+        void Log(LogKey key, const T &value, std::int64_t timestamp = 0)
         {
-            if (!structEntries.contains(std::string(key)))
+            using Slot = StructPublisherSlot<nt::StructPublisher<T, I...>>;
+            auto &slot = structEntries.Get<Slot>(
+                key, StructTypeName<T>(),
+                [&]
+                {
+                    return Slot{
+                        table->GetStructTopic<T, I...>(keys.Path(key))
+                            .Publish(),
+                        {}, false, filter.EpsilonFor(keys.Path(key))};
+                });
+            if (!StructChanged(slot, std::span<const T>{&value, 1}) ||
+                !Admit(key, wpi::GetStructSize<T>(), timestamp))
             {
-                structEntries[std::string(key)] =
-                    std::make_shared<nt::StructPublisher<T, I...>>(
-                        table->GetStructTopic<T, I...>(key).Publish());
+                return;
             }
-            auto topic = structEntries[std::string(key)].get();
-            auto structTopic = (nt::StructPublisher<T, I...> *)topic;
-            structTopic->Set(value);
+            slot.publisher.Set(value, timestamp);
+            CommitStruct(slot);
         }
 
         template <typename T, typename... I>
             requires wpi::StructSerializable<T, I...>
-        void Log(const std::string_view &key, std::span<T> values)
+        void Log(LogKey key, std::span<T> values, std::int64_t timestamp = 0)
         {
-            if (!structEntries.contains(std::string(key)))
+            using Slot =
+                StructPublisherSlot<nt::StructArrayPublisher<T, I...>>;
+            auto &slot = structEntries.Get<Slot>(
+                key, StructArrayTypeName<T>(),
+                [&]
+                {
+                    return Slot{
+                        table->GetStructArrayTopic<T, I...>(keys.Path(key))
+                            .Publish(),
+                        {}, false, filter.EpsilonFor(keys.Path(key))};
+                });
+            if (!StructChanged(slot, std::span<const T>{values}) ||
+                !Admit(key, wpi::GetStructSize<T>() * values.size(),
+                       timestamp))
             {
-                structEntries[std::string(key)] =
-                    std::make_shared<nt::StructArrayPublisher<T, I...>>(
-                        table->GetStructArrayTopic<T, I...>(key).Publish());
+                return;
             }
-            auto topic = structEntries[std::string(key)].get();
-            auto structArrayTopic = (nt::StructArrayPublisher<T, I...> *)topic;
-            structArrayTopic->Set(values);
+            slot.publisher.Set(values, timestamp);
+            CommitStruct(slot);
         }
 
     private:
+        /**
+         * @brief Publisher plus the last value it published
+         *
+         * For array types NT can't take as-is, `last` doubles as the buffer
+         * values are converted into before publishing.
+         */
+        template <typename Publisher, typename Value>
+        struct CachedPublisher
+        {
+            Publisher publisher;
+            Value last{};
+            bool published = false;
+            double epsilon = 0;
+        };
+
+        /**
+         * @brief String arrays keep their buffer at its largest size so the
+         *        strings keep their capacity, and track the used length
+         */
+        struct StringArraySlot
+        {
+            nt::StringArrayPublisher publisher;
+            std::vector<std::string> last{};
+            std::size_t size = 0;
+            bool published = false;
+        };
+
+        /** @brief Struct publisher plus the last packed value it published */
+        template <typename Publisher>
+        struct StructPublisherSlot
+        {
+            Publisher publisher;
+            std::vector<std::uint8_t> last{};
+            bool published = false;
+            double epsilon = 0;
+        };
+
+        using DoubleSlot = CachedPublisher<nt::DoublePublisher, double>;
+        using IntegerSlot = CachedPublisher<nt::IntegerPublisher, long>;
+        using BooleanSlot = CachedPublisher<nt::BooleanPublisher, bool>;
+        using StringSlot = CachedPublisher<nt::StringPublisher, std::string>;
+        using DoubleArraySlot =
+            CachedPublisher<nt::DoubleArrayPublisher, std::vector<double>>;
+        using IntegerArraySlot =
+            CachedPublisher<nt::IntegerArrayPublisher,
+                            std::vector<std::int64_t>>;
+        using BooleanArraySlot =
+            CachedPublisher<nt::BooleanArrayPublisher, std::vector<int>>;
+
+        using Topic =
+            std::variant<std::monostate, DoubleSlot, IntegerSlot, BooleanSlot,
+                         StringSlot, DoubleArraySlot, IntegerArraySlot,
+                         BooleanArraySlot, StringArraySlot>;
+
+        /** @brief Creates the slot for a new topic */
+        template <typename Slot, typename Publisher>
+        Slot MakeSlot(LogKey key, Publisher publisher)
+        {
+            Slot slot{std::move(publisher)};
+            if constexpr (requires { slot.epsilon; })
+            {
+                slot.epsilon = filter.EpsilonFor(keys.Path(key));
+            }
+            return slot;
+        }
+
+        /** @brief Rough NT4 framing cost of one update: topic, time, type */
+        static constexpr std::size_t kUpdateOverhead = 12;
+
+        /**
+         * @brief Charges a changed value against the bandwidth budget
+         *
+         * @param bytes Size of the value itself
+         * @return true if the value should be published now
+         */
+        bool Admit(LogKey key, std::size_t bytes, std::int64_t timestamp)
+        {
+            if (timestamp == 0)
+            {
+                timestamp = static_cast<std::int64_t>(wpi::Now());
+            }
+            return limiter.Admit(key, bytes + kUpdateOverhead, timestamp);
+        }
+
+        /**
+         * @brief Packs struct values and checks them against the last ones
+         *        published
+         *
+         * The packed values stay in packBuffer until CommitStruct() records
+         * them as published.
+         *
+         * @return true if the values should be published
+         */
+        template <typename Slot, typename T>
+        bool StructChanged(Slot &slot, std::span<const T> values)
+        {
+            if (!filter.enabled)
+            {
+                return true;
+            }
+            const std::size_t size = wpi::GetStructSize<T>();
+            packBuffer.resize(size * values.size());
+            std::uint8_t *out = packBuffer.data();
+            for (const auto &value : values)
+            {
+                wpi::PackStruct(std::span<std::uint8_t>{out, size}, value);
+                out += size;
+            }
+            return !slot.published ||
+                   !PackedEqual<T>(packBuffer, slot.last, slot.epsilon);
+        }
+
+        /** @brief Remembers the values StructChanged() packed as published */
+        template <typename Slot>
+        void CommitStruct(Slot &slot)
+        {
+            if (!filter.enabled)
+            {
+                return;
+            }
+            // Swapping keeps both buffers' capacity for the next call
+            std::swap(packBuffer, slot.last);
+            slot.published = true;
+        }
+
+        /** @brief Gets the topic slot for a key, growing as needed */
+        Topic &GetTopic(LogKey key)
+        {
+            if (key >= topics.size())
+            {
+                topics.resize(key + 1);
+            }
+            return topics[key];
+        }
+
+        const LogKeyRegistry &keys;
         std::shared_ptr<nt::NetworkTable> table;
-        std::unordered_map<
-            std::string,
-            std::variant<nt::DoublePublisher, nt::IntegerPublisher,
-                         nt::BooleanPublisher, nt::StringPublisher,
-                         nt::DoubleArrayPublisher, nt::IntegerArrayPublisher,
-                         nt::BooleanArrayPublisher, nt::StringArrayPublisher>>
-            topics;
-        std::unordered_map<std::string, std::shared_ptr<nt::Publisher>>
-            structEntries;
+        LogChangeFilter filter;
+        LogBandwidthLimiter limiter;
+        // Indexed directly by LogKey
+        std::vector<Topic> topics;
+        StructSlots structEntries;
+        // Scratch space for packing struct values before comparing them
+        std::vector<std::uint8_t> packBuffer;
     };
 }  // namespace nfr
\ No newline at end of file
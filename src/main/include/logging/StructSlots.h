@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logging/LogKeyRegistry.h"
+#include "wpi/struct/Struct.h"
+
+namespace nfr
+{
+    /**
+     * @brief Per-key storage for struct entries of arbitrary types
+     *
+     * Struct publishers and log entries are templates, so each key's entry
+     * has its own type. Entries are constructed in place in an arena of
+     * fixed-size blocks (never moved or freed until the sink goes away), and
+     * each key's slot records a tag for the exact entry type. A write is a
+     * single index into the slot table plus a tag comparison; reusing a key
+     * with a different struct type throws instead of reinterpreting memory.
+     *
+     * ```cpp
+     * auto& entry = slots.Get<wpi::log::StructLogEntry<frc::Pose2d>>(
+     *     key, "Pose2d", [&] { return wpi::log::StructLogEntry<...>(...); });
+     * ```
+     */
+    class StructSlots
+    {
+    public:
+        /**
+         * @param keys Registry used to name keys in error messages
+         */
+        explicit StructSlots(const LogKeyRegistry& keys);
+        StructSlots(const StructSlots&) = delete;
+        StructSlots& operator=(const StructSlots&) = delete;
+        ~StructSlots();
+
+        /**
+         * @brief Gets the entry for a key, creating it on first use
+         *
+         * @param key Key to look up
+         * @param typeName Name of the logged type, for error messages
+         * @param make Called once to construct the entry
+         * @return The entry stored for the key
+         * @throws std::runtime_error if the key holds a different entry type
+         */
+        template <typename Entry, typename Make>
+        Entry& Get(LogKey key, std::string_view typeName, Make&& make)
+        {
+            if (key < slots.size() && slots[key].entry)
+            {
+                Slot& slot = slots[key];
+                if (slot.tag != &kTag<Entry>)
+                {
+                    ThrowMismatch(key, slot.typeName, typeName);
+                }
+                return *static_cast<Entry*>(slot.entry);
+            }
+
+            void* memory = Allocate(sizeof(Entry), alignof(Entry));
+            Entry* entry = ::new (memory) Entry(std::forward<Make>(make)());
+            if (key >= slots.size())
+            {
+                slots.resize(key + 1);
+            }
+            slots[key] = Slot{entry, &kTag<Entry>, &Destroy<Entry>, typeName};
+            return *entry;
+        }
+
+    private:
+        // One distinct address per entry type
+        template <typename Entry>
+        static constexpr char kTag = 0;
+
+        template <typename Entry>
+        static void Destroy(void* entry)
+        {
+            static_cast<Entry*>(entry)->~Entry();
+        }
+
+        struct Slot
+        {
+            void* entry = nullptr;
+            const void* tag = nullptr;
+            void (*destroy)(void*) = nullptr;
+            std::string_view typeName;
+        };
+
+        void* Allocate(std::size_t size, std::size_t alignment);
+
+        [[noreturn]] void ThrowMismatch(LogKey key, std::string_view existing,
+                                        std::string_view requested) const;
+
+        static constexpr std::size_t kBlockSize = 16 * 1024;
+
+        const LogKeyRegistry& keys;
+        // Indexed directly by LogKey
+        std::vector<Slot> slots;
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        std::size_t blockUsed = kBlockSize;
+    };
+
+    /** @brief Name of a struct type for error messages, e.g. "Pose2d" */
+    template <typename T>
+    std::string_view StructTypeName()
+    {
+        return wpi::GetStructTypeName<T>();
+    }
+
+    /** @brief Name of an array of a struct type, e.g. "Pose2d[]" */
+    template <typename T>
+    std::string_view StructArrayTypeName()
+    {
+        static const std::string name =
+            std::string{wpi::GetStructTypeName<T>()} + "[]";
+        return name;
+    }
+}  // namespace nfr
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace nfr
+{
+    /**
+     * @brief Streambuf that passes output through and captures it as lines
+     *
+     * Everything written goes straight to the primary buffer (the original
+     * console) and is also split into lines. Each complete, non-empty line
+     * is stamped with the FPGA time and queued for the logger:
+     *
+     * ```
+     * [12.345678] Running in non-competition mode.
+     * ```
+     *
+     * ## Bounded memory:
+     * Captured text lives in two buffers of fixed capacity that are swapped
+     * by TakeLines(). If the robot prints faster than the logger drains, the
+     * extra lines are dropped and counted instead of growing memory, and a
+     * note with the number of dropped bytes is added on the next drain.
+     * Lines longer than kMaxLineLength are split.
+     */
+    class TeeStreamBuf : public std::streambuf
+    {
+    public:
+        static constexpr std::size_t kDefaultCapacity = 16 * 1024;
+        static constexpr std::size_t kMaxLineLength = 1024;
+
+        /**
+         * @param primaryBuf Buffer that all output is passed through to
+         * @param capacity Most bytes of captured lines held between drains
+         */
+        explicit TeeStreamBuf(std::streambuf* primaryBuf,
+                              std::size_t capacity = kDefaultCapacity);
+
+        /**
+         * @brief Takes the lines completed since the last call
+         *
+         * @return Lines separated by '\n' (empty if nothing was printed).
+         *         Valid until the next call.
+         */
+        std::string_view TakeLines();
+
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+        int sync() override;
+
+    private:
+        // Both called with mutex_ held
+        void Capture(const char* s, std::size_t n);
+        void EndLine();
+
+        std::streambuf* primary_buf_;  // Original streambuf (e.g., std::cout's
+                                       // original buffer)
+        std::size_t capacity_;
+
+        std::mutex mutex_;
+        std::array<char, kMaxLineLength> line_;  // Line being written
+        std::size_t line_length_ = 0;
+        std::string pending_;  // Completed lines waiting for TakeLines()
+        std::string taken_;    // Lines handed out by the last TakeLines()
+        std::uint64_t dropped_bytes_ = 0;
+    };
+}  // namespace nfr
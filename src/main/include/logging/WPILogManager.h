@@ -2,68 +2,179 @@
 
 #include <wpi/DataLog.h>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <string_view>
 #include <variant>
+#include <vector>
 
+#include "logging/LogKeyRegistry.h"
+#include "logging/StructSlots.h"
 #include "wpi/struct/Struct.h"
 
 namespace nfr
 {
+    /**
+     * @brief A logging manager that writes logs to the DataLogManager file
+     *
+     * With a decimation of N, only every Nth value of each key is written,
+     * which keeps the file small when a FlightRecorder holds the full-rate
+     * history. Strings are always written, since they are mostly events
+     * (like console output) rather than samples. Keys that are already
+     * published at a low rate (like LogStatistics summaries) can opt out with
+     * KeepEvery().
+     */
     class WPILogManager
     {
     public:
-        WPILogManager();
-        void Log(const std::string_view& key, double value);
-        void Log(const std::string_view& key, long value);
-        void Log(const std::string_view& key, bool value);
-        void Log(const std::string_view& key, const std::string_view& value);
-        void Log(const std::string_view& key, std::span<double> values);
-        void Log(const std::string_view& key, std::span<long> values);
-        void Log(const std::string_view& key, std::span<bool> values);
-        void Log(const std::string_view& key,
-                 std::span<std::string_view> values);
+        static constexpr std::string_view kName = "wpilog";
+        /** @brief Summarized keys arrive as summaries (see LogStatistics) */
+        static constexpr bool kSummariesOnly = true;
+
+        /**
+         * @param keys Registry used to look up the entry name for a key
+         * @param decimation Write every Nth value of each key
+         */
+        explicit WPILogManager(const LogKeyRegistry& keys,
+                               unsigned decimation = 1);
+
+        /** @brief Whether decimation keeps the next value of a key */
+        bool Wants(LogKey key) const
+        {
+            if (decimation <= 1)
+            {
+                return true;
+            }
+            auto count = decimationCounts[key].load(std::memory_order_relaxed);
+            return count == 0 || count == kKeepEvery;
+        }
+
+        /**
+         * @brief Writes every value of a key, whatever the decimation
+         *
+         * Safe to call from any thread.
+         */
+        void KeepEvery(LogKey key)
+        {
+            if (decimation > 1)
+            {
+                decimationCounts[key].store(kKeepEvery,
+                                            std::memory_order_relaxed);
+            }
+        }
+
+        /** @brief Counts a value that was never computed as a skipped one */
+        void Skip(LogKey key)
+        {
+            if (decimation > 1)
+            {
+                Advance(key);
+            }
+        }
+
+        void Log(LogKey key, double value, std::int64_t timestamp = 0);
+        void Log(LogKey key, long value, std::int64_t timestamp = 0);
+        void Log(LogKey key, bool value, std::int64_t timestamp = 0);
+        void Log(LogKey key, const std::string_view& value,
+                 std::int64_t timestamp = 0);
+        void Log(LogKey key, std::span<double> values,
+                 std::int64_t timestamp = 0);
+        void Log(LogKey key, std::span<long> values,
+                 std::int64_t timestamp = 0);
+        void Log(LogKey key, std::span<bool> values,
+                 std::int64_t timestamp = 0);
+        void Log(LogKey key, std::span<std::string_view> values,
+                 std::int64_t timestamp = 0);
         template <typename T, typename... I>
             requires wpi::StructSerializable<T, I...>
-        void Log(const std::string_view& key, const T& value)
+        void Log(LogKey key, const T& value, std::int64_t timestamp = 0)
         {
-            if (!structEntries.contains(std::string(key)))
+            if (Decimated(key))
             {
-                structEntries[std::string(key)] =
-                    std::make_shared<wpi::log::StructLogEntry<T, I...>>(logRef,
-                                                                        key);
+                return;
             }
-            auto entry = structEntries[std::string(key)].get();
-            auto structEntry = (wpi::log::StructLogEntry<T, I...>*)entry;
-            structEntry->Append(value);
+            using StructEntry = wpi::log::StructLogEntry<T, I...>;
+            structEntries
+                .Get<StructEntry>(
+                    key, StructTypeName<T>(),
+                    [&] { return StructEntry(logRef, keys.Path(key)); })
+                .Append(value, timestamp);
         }
         template <typename T, typename... I>
             requires wpi::StructSerializable<T, I...>
-        void Log(const std::string_view& key, std::span<T> values)
+        void Log(LogKey key, std::span<T> values, std::int64_t timestamp = 0)
         {
-            if (!structEntries.contains(std::string(key)))
+            if (Decimated(key))
             {
-                structEntries[std::string(key)] =
-                    std::make_shared<wpi::log::StructArrayLogEntry<T, I...>>(
-                        logRef, key);
+                return;
             }
-            auto entry = structEntries[std::string(key)].get();
-            auto structArrayEntry =
-                (wpi::log::StructArrayLogEntry<T, I...>*)entry;
-            structArrayEntry->Append(values);
+            using StructEntry = wpi::log::StructArrayLogEntry<T, I...>;
+            structEntries
+                .Get<StructEntry>(
+                    key, StructArrayTypeName<T>(),
+                    [&] { return StructEntry(logRef, keys.Path(key)); })
+                .Append(values, timestamp);
         }
 
     private:
+        using Entry = std::variant<
+            std::monostate, wpi::log::DoubleLogEntry, wpi::log::BooleanLogEntry,
+            wpi::log::IntegerLogEntry, wpi::log::StringLogEntry,
+            wpi::log::DoubleArrayLogEntry, wpi::log::BooleanArrayLogEntry,
+            wpi::log::IntegerArrayLogEntry, wpi::log::StringArrayLogEntry>;
+
+        // Counts stay below the decimation, which is at most 255, so the top
+        // value is free to mark keys that are never decimated
+        static constexpr std::uint8_t kKeepEvery = UINT8_MAX;
+
+        /** @brief Whether to skip this value of a key to honor decimation */
+        bool Decimated(LogKey key)
+        {
+            return decimation > 1 && Advance(key) != 0;
+        }
+
+        /**
+         * @brief Moves a key's count on by one value, returning the old one
+         *        (always 0 for KeepEvery() keys)
+         */
+        unsigned Advance(LogKey key)
+        {
+            auto& count = decimationCounts[key];
+            std::uint8_t current = count.load(std::memory_order_relaxed);
+            if (current == kKeepEvery)
+            {
+                return 0;
+            }
+            while (!count.compare_exchange_weak(
+                current, static_cast<std::uint8_t>((current + 1) % decimation),
+                std::memory_order_relaxed))
+            {
+            }
+            return current;
+        }
+
+        /** @brief Gets the entry slot for a key, growing as needed */
+        Entry& GetEntry(LogKey key)
+        {
+            if (key >= entries.size())
+            {
+                entries.resize(key + 1);
+            }
+            return entries[key];
+        }
+
+        const LogKeyRegistry& keys;
         wpi::log::DataLog& logRef;
-        std::unordered_map<
-            std::string,
-            std::variant<
-                wpi::log::DoubleLogEntry, wpi::log::BooleanLogEntry,
-                wpi::log::IntegerLogEntry, wpi::log::StringLogEntry,
-                wpi::log::DoubleArrayLogEntry, wpi::log::BooleanArrayLogEntry,
-                wpi::log::IntegerArrayLogEntry, wpi::log::StringArrayLogEntry>>
-            entries;
-        std::unordered_map<std::string, std::shared_ptr<wpi::log::DataLogEntry>>
-            structEntries;
+        // Indexed directly by LogKey
+        std::vector<Entry> entries;
+        StructSlots structEntries;
+        // DataLog copies on Append, so one conversion buffer serves every key
+        std::vector<std::int64_t> int64Buffer;
+        unsigned decimation;
+        // Values seen since the last one written, indexed by LogKey. Sized
+        // for every possible key up front (when decimating) because Skip()
+        // can run on another thread while the writer thread logs.
+        std::unique_ptr<std::atomic<std::uint8_t>[]> decimationCounts;
     };
 }  // namespace nfr
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <frc/geometry/Translation2d.h>
+#include <units/length.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nfr
+{
+    /** @brief A cell of a NavGrid: its column (x) and row (y) */
+    struct GridCell
+    {
+        int x = 0;
+        int y = 0;
+
+        bool operator==(const GridCell&) const = default;
+    };
+
+    /**
+     * @brief Which parts of the field the robot can't drive through
+     *
+     * The field is split into square cells, each of which is free or
+     * blocked. Rows are packed one bit per cell into 64-bit words, so the
+     * whole field at 0.3 m cells (59 × 27) fits in 27 words and a row is
+     * checked, shifted or merged a word at a time.
+     *
+     * Cell (0, 0) is at the field origin, on the blue alliance wall, with x
+     * along the length of the field (as in PathPlanner's navgrid.json).
+     */
+    class NavGrid
+    {
+    public:
+        /** @brief A grid with every cell free */
+        NavGrid(int width, int height, units::meter_t nodeSize);
+
+        /**
+         * @brief Loads a PathPlanner navgrid.json
+         *
+         * @throws std::runtime_error if the file can't be read or isn't a
+         *         navgrid
+         */
+        static NavGrid Load(const std::string& path);
+
+        int Width() const
+        {
+            return width;
+        }
+
+        int Height() const
+        {
+            return height;
+        }
+
+        units::meter_t NodeSize() const
+        {
+            return nodeSize;
+        }
+
+        bool Contains(GridCell cell) const
+        {
+            return cell.x >= 0 && cell.x < width && cell.y >= 0 &&
+                   cell.y < height;
+        }
+
+        /** @brief Whether a cell is blocked; outside the grid always is */
+        bool IsBlocked(GridCell cell) const
+        {
+            if (!Contains(cell))
+            {
+                return true;
+            }
+            return (Row(cell.y)[cell.x / 64] >> (cell.x % 64)) & 1;
+        }
+
+        void SetBlocked(GridCell cell, bool blocked = true);
+
+        /** @brief Number of blocked cells */
+        int BlockedCount() const;
+
+        /**
+         * @brief Copy with every cell within `clearance` of an obstacle
+         *        blocked too
+         *
+         * Planning for the robot's center over the inflated grid keeps the
+         * rest of the robot `clearance` away from obstacles.
+         */
+        NavGrid Inflated(units::meter_t clearance) const;
+
+        /**
+         * @brief Whether the straight line between two cell centers only
+         *        crosses free cells
+         *
+         * A line passing exactly through a corner needs both cells beside
+         * the corner free, so it can't slip between two diagonal obstacles.
+         */
+        bool HasLineOfSight(GridCell from, GridCell to) const;
+
+        /** @brief Cell containing a field position, clamped to the grid */
+        GridCell CellAt(const frc::Translation2d& position) const;
+
+        /** @brief Field position of a cell's center */
+        frc::Translation2d CenterOf(GridCell cell) const;
+
+        /**
+         * @brief Closest free cell to `cell` (itself, if it is free)
+         *
+         * Searches outwards up to `maxDistance` cells.
+         */
+        std::optional<GridCell> NearestFree(GridCell cell,
+                                            int maxDistance) const;
+
+    private:
+        const std::uint64_t* Row(int y) const
+        {
+            return words.data() + y * wordsPerRow;
+        }
+
+        std::uint64_t* Row(int y)
+        {
+            return words.data() + y * wordsPerRow;
+        }
+
+        int width;
+        int height;
+        int wordsPerRow;
+        units::meter_t nodeSize;
+        // Bit x % 64 of word x / 64 of a row is cell x; bits past the width
+        // stay clear
+        std::vector<std::uint64_t> words;
+    };
+}  // namespace nfr
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <frc/geometry/Rotation2d.h>
+#include <frc/geometry/Translation2d.h>
+#include <units/acceleration.h>
+#include <units/length.h>
+#include <units/velocity.h>
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "pathfinding/NavGrid.h"
+#include "trajectory/CachedTrajectory.h"
+
+namespace nfr
+{
+    /** @brief Limits for turning a path into a trajectory */
+    struct PathConstraints
+    {
+        units::meters_per_second_t maxVelocity = 3_mps;
+        units::meters_per_second_squared_t maxAcceleration = 3_mps_sq;
+        /**
+         * @brief How far before and after each corner it is rounded off,
+         *        at most (less where that would cut into an obstacle)
+         */
+        units::meter_t cornerRadius = 0.5_m;
+        /** @brief Distance between trajectory samples */
+        units::meter_t sampleSpacing = 0.05_m;
+    };
+
+    /**
+     * @brief Finds paths across a NavGrid with Theta*
+     *
+     * Theta* is A* that lets each cell's parent be any cell it can see, not
+     * just a neighbor, so paths run straight across open field at any angle
+     * instead of zig-zagging along the grid's 8 directions. A path is only
+     * its start, the corners it turns at and its goal.
+     *
+     * Everything a search needs is allocated once, for the grid's size, and
+     * reused, so FindPath() doesn't allocate. A Pathfinder searches one
+     * path at a time; it may run on another thread than the one that made
+     * it, as long as it isn't used from two at once.
+     */
+    class Pathfinder
+    {
+    public:
+        /** @param grid Must outlive the pathfinder */
+        explicit Pathfinder(const NavGrid& grid);
+
+        /**
+         * @brief Finds a path between two field positions
+         *
+         * Ends in a blocked cell are moved to the nearest free one (a robot
+         * bumped into an inflated obstacle can still get out).
+         *
+         * @param waypoints Filled with the start, each corner and the goal;
+         *        cleared if there is no path
+         * @return Whether there is a path
+         */
+        bool FindPath(const frc::Translation2d& start,
+                      const frc::Translation2d& goal,
+                      std::vector<frc::Translation2d>& waypoints);
+
+        /** @brief Cells expanded by the last search */
+        int LastExpanded() const
+        {
+            return expanded;
+        }
+
+    private:
+        int Index(GridCell cell) const
+        {
+            return cell.y * grid->Width() + cell.x;
+        }
+
+        GridCell CellOf(int index) const
+        {
+            return {index % grid->Width(), index / grid->Width()};
+        }
+
+        /** @brief Straight-line distance between cell centers, in cells */
+        static float Distance(GridCell a, GridCell b);
+
+        /** @brief Cost to `cell` through `parent`, if it is cheaper */
+        void Relax(int cell, int parent, GridCell goal);
+
+        const NavGrid* grid;
+        int expanded = 0;
+        // Per cell: which search last reached it (so nothing has to be
+        // cleared between searches), cost from the start, and parent
+        std::uint32_t search = 0;
+        std::vector<std::uint32_t> reached;
+        std::vector<std::uint32_t> closed;
+        std::vector<float> cost;
+        std::vector<int> parent;
+        // Binary heap of (cost + distance to goal, cell); cells whose cost
+        // dropped after being pushed are pushed again and the stale entry
+        // skipped when popped
+        std::vector<std::pair<float, int>> open;
+    };
+
+    /**
+     * @brief Turns a path into a trajectory SwerveDrive can follow
+     *
+     * Rounds off each corner with a curve, as tightly as it takes for the
+     * curve to stay in free cells of `grid`, then drives along it as fast
+     * as the constraints allow: accelerating from rest, slowing where the
+     * curve is too tight to take at speed, and stopping at the goal.
+     * Heading turns steadily from `startHeading` to `endHeading` over the
+     * trajectory (a swerve robot doesn't have to face where it drives).
+     *
+     * @param grid The (inflated) grid the path was found on
+     */
+    CachedTrajectory ToTrajectory(const NavGrid& grid,
+                                  std::span<const frc::Translation2d> waypoints,
+                                  frc::Rotation2d startHeading,
+                                  frc::Rotation2d endHeading,
+                                  const PathConstraints& constraints);
+}  // namespace nfr
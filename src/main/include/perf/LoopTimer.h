@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace nfr
+{
+    class LogContext;
+
+    /**
+     * @brief Rolling timing statistics for one phase of the robot loop
+     *
+     * Keeps the last kWindowSize durations in a fixed ring, so recording is
+     * a single store and never allocates. Percentiles are only computed when
+     * the statistics are logged.
+     *
+     * Logs (in microseconds): `last_us`, `p50_us`, `p99_us`, `max_us`.
+     */
+    class PhaseTimer
+    {
+    public:
+        /// About 5 seconds of 20ms loops
+        static constexpr std::size_t kWindowSize = 256;
+
+        /** @brief Summary of the current window, in microseconds */
+        struct Summary
+        {
+            double last = 0;
+            double p50 = 0;
+            double p99 = 0;
+            double max = 0;
+        };
+
+        /** @brief Adds one measured duration to the window */
+        void Record(std::chrono::nanoseconds duration)
+        {
+            samples_[next_] = duration.count();
+            last_ = duration.count();
+            next_ = (next_ + 1) % kWindowSize;
+            if (count_ < kWindowSize)
+            {
+                ++count_;
+            }
+        }
+
+        /** @brief Computes percentiles over the current window */
+        Summary Summarize() const;
+
+        void Log(const LogContext& log) const;
+
+    private:
+        std::array<std::int64_t, kWindowSize> samples_{};
+        std::size_t next_ = 0;
+        std::size_t count_ = 0;
+        std::int64_t last_ = 0;
+    };
+
+    /**
+     * @brief Times the enclosing scope into a PhaseTimer
+     *
+     * Uses std::chrono::steady_clock, which is a cheap vDSO call on the
+     * roboRIO and desktop, so a scope costs well under a microsecond.
+     *
+     * ```cpp
+     * {
+     *     ScopedTimer timer{schedulerTimer};
+     *     frc2::CommandScheduler::GetInstance().Run();
+     * }
+     * ```
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(PhaseTimer& timer)
+            : timer_(timer), start_(std::chrono::steady_clock::now())
+        {
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer()
+        {
+            timer_.Record(std::chrono::steady_clock::now() - start_);
+        }
+
+    private:
+        PhaseTimer& timer_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * @brief Named set of PhaseTimers for one loop
+     *
+     * Phases are registered once up front; the returned reference is what
+     * ScopedTimer uses, so timing a phase never looks anything up. Logging
+     * the LoopTimer logs every phase under its name, e.g.
+     * `perf/scheduler/p99_us`.
+     */
+    class LoopTimer
+    {
+    public:
+        /**
+         * @brief Registers a phase (or returns the existing one)
+         *
+         * @param name Name the phase is logged under
+         * @return Timer for the phase; stays valid for the LoopTimer's life
+         */
+        PhaseTimer& AddPhase(std::string_view name);
+
+        void Log(const LogContext& log) const;
+
+    private:
+        std::vector<std::pair<std::string, std::unique_ptr<PhaseTimer>>>
+            phases_;
+    };
+}  // namespace nfr
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <units/time.h>
+
+#include <optional>
+#include <string>
+
+namespace nfr
+{
+    /** @brief What to replay and where to write the result */
+    struct ReplayOptions
+    {
+        std::string input;   ///< Recorded `.wpilog` file
+        std::string output;  ///< Defaults to `<input>_replay.wpilog`
+        /** @brief Start this far into the log */
+        units::second_t from{0};
+        /** @brief Stop this far into the log (default: the end) */
+        std::optional<units::second_t> to;
+        /**
+         * @brief Reset odometry to the recorded pose every cycle
+         *
+         * With this off the recorded pose only seeds odometry and the
+         * simulated drivetrain is left to drive itself from there.
+         */
+        bool followPose = true;
+    };
+
+    /** @brief Whether the program was started with `--replay` */
+    bool IsReplayRequested(int argc, char** argv);
+
+    /**
+     * @brief Parses `--replay <log> [--out <log>] [--from <s>] [--to <s>]
+     *        [--no-follow-pose]`
+     *
+     * @return nullopt (after printing usage) if the arguments are invalid
+     */
+    std::optional<ReplayOptions> ParseReplayOptions(int argc, char** argv);
+
+    /**
+     * @brief Replays a recorded match through the simulated robot
+     *
+     * Reads the driver station state, joysticks and drivetrain pose from a
+     * recorded log and feeds them back, cycle by cycle, through the same
+     * Robot, RobotContainer and command scheduler that ran the match.
+     * Simulated time is paused and stepped by one robot period per cycle,
+     * so the replay runs as fast as the CPU allows and gives the same
+     * result every run. Everything the robot logs goes to a new file,
+     * alongside the recorded inputs under "replay/".
+     *
+     * ```bash
+     * frcUserProgram --replay FRC_20250301_q12.wpilog --from 15 --to 150
+     * ```
+     *
+     * Only runs in simulation builds.
+     *
+     * @return Process exit code
+     */
+    int RunLogReplay(const ReplayOptions& options);
+}  // namespace nfr
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/kinematics/ChassisSpeeds.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nfr
+{
+    /**
+     * @brief Values of one log entry in timestamp order
+     *
+     * @tparam T Decoded value type
+     */
+    template <typename T>
+    struct ReplaySeries
+    {
+        std::vector<std::int64_t> timestamps;  ///< Microseconds, ascending
+        std::vector<T> values;
+
+        /** @brief Latest value logged at or before a time, or nullptr */
+        const T* At(std::int64_t timestamp) const
+        {
+            auto it = std::upper_bound(timestamps.begin(), timestamps.end(),
+                                       timestamp);
+            if (it == timestamps.begin())
+            {
+                return nullptr;
+            }
+            return &values[it - timestamps.begin() - 1];
+        }
+
+        bool Empty() const
+        {
+            return timestamps.empty();
+        }
+    };
+
+    /** @brief Recorded state of one joystick */
+    struct ReplayJoystick
+    {
+        ReplaySeries<std::vector<float>> axes;
+        ReplaySeries<std::vector<int>> buttons;  ///< One flag per button
+        ReplaySeries<std::vector<std::int64_t>> povs;
+    };
+
+    /** @brief Log entries the drivetrain state is read from */
+    struct ReplayDriveKeys
+    {
+        std::string pose = "robot/drive/pose";
+        std::string speeds = "robot/drive/speeds";
+    };
+
+    /**
+     * @brief Robot inputs read back from a recorded `.wpilog`
+     *
+     * Reads the driver station state and joysticks that
+     * `frc::DriverStation::StartDataLog` records (`DS:enabled`,
+     * `DS:joystick0/axes`, ...), the alliance from the logged FMSInfo table
+     * and the drivetrain state that SwerveDrive::Log records. The whole file
+     * is decoded up front so replaying does no parsing.
+     */
+    class ReplayInputs
+    {
+    public:
+        static constexpr int kJoystickCount = 6;
+
+        /**
+         * @brief Reads a log file
+         *
+         * @param path `.wpilog` file to read
+         * @param driveKeys Entries holding the drivetrain state
+         * @throws std::runtime_error if the file can't be read, isn't a
+         *         WPILog file or has no driver station data
+         */
+        explicit ReplayInputs(const std::string& path,
+                              const ReplayDriveKeys& driveKeys = {});
+
+        /** @brief Time of the first driver station sample (microseconds) */
+        std::int64_t GetStartTime() const
+        {
+            return startTime;
+        }
+
+        /** @brief Time of the last recorded value (microseconds) */
+        std::int64_t GetEndTime() const
+        {
+            return endTime;
+        }
+
+        /**
+         * @brief Makes the simulated driver station match the log
+         *
+         * Sets the robot mode, alliance and every recorded joystick to their
+         * latest values at a time, then notifies the driver station so the
+         * next loop sees them.
+         */
+        void ApplyDriverStation(std::int64_t timestamp) const;
+
+        /**
+         * @brief Recorded robot pose at a time
+         *
+         * Poses are interpolated between samples, since the file log may
+         * only keep every Nth one.
+         */
+        std::optional<frc::Pose2d> GetPose(std::int64_t timestamp) const;
+
+        /** @brief Latest recorded chassis speeds at a time */
+        std::optional<frc::ChassisSpeeds> GetSpeeds(
+            std::int64_t timestamp) const;
+
+    private:
+        // Flags are stored as ints, like DataLogReader's boolean arrays
+        ReplaySeries<int> enabled;
+        ReplaySeries<int> autonomous;
+        ReplaySeries<int> test;
+        ReplaySeries<int> estop;
+        ReplaySeries<int> redAlliance;
+        std::array<ReplayJoystick, kJoystickCount> joysticks;
+        ReplaySeries<frc::Pose2d> pose;
+        ReplaySeries<frc::ChassisSpeeds> speeds;
+
+        std::int64_t startTime = 0;
+        std::int64_t endTime = 0;
+    };
+}  // namespace nfr
@@ -3,18 +3,48 @@
 #include <choreo/Choreo.h>
 #include <frc/Notifier.h>
 #include <frc/controller/PIDController.h>
+#include <frc/kinematics/SwerveDriveOdometry.h>
 #include <frc2/command/SubsystemBase.h>
 #include <frc2/command/sysid/SysIdRoutine.h>
 #include <logging/Logger.h>
+#include <pathfinding/NavGrid.h>
+#include <pathfinding/Pathfinder.h>
 #include <pathplanner/lib/auto/AutoBuilder.h>
 #include <pathplanner/lib/controllers/PPHolonomicDriveController.h>
+#include <trajectory/CachedTrajectory.h>
 #include <units/time.h>
+#include <util/SampleQueue.h>
+#include <util/SeqLock.h>
+#include <vision/VisionFusion.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 #include <ctre/phoenix6/SignalLogger.hpp>
 #include <ctre/phoenix6/swerve/SwerveDrivetrain.hpp>
 
 namespace nfr
 {
+    /**
+     * @brief One odometry update, copied out of the odometry thread
+     *
+     * Fixed-size so capturing it never allocates. Also the type of the
+     * per-cycle snapshot (see SwerveDrive::GetSnapshot()).
+     */
+    struct SwerveOdometrySample
+    {
+        /** @brief Capture time in microseconds (wpi::Now() base) */
+        std::int64_t timestamp = 0;
+        frc::Pose2d pose;
+        frc::ChassisSpeeds speeds;
+        std::array<frc::SwerveModuleState, 4> moduleStates;
+        std::array<frc::SwerveModulePosition, 4> modulePositions;
+        units::second_t odometryPeriod = 0_s;
+    };
+
     /**
      * @brief Advanced swerve drivetrain subsystem for FRC robots
      *
@@ -52,7 +82,53 @@ namespace nfr
                             ctre::phoenix6::hardware::TalonFX,
                             ctre::phoenix6::hardware::CANcoder>
     {
+    public:
+        /**
+         * @brief One odometry update (declared outside the class so
+         *        SeqLock can check it is default-constructible here)
+         */
+        using OdometrySample = SwerveOdometrySample;
+
     private:
+        // === ODOMETRY CAPTURE ===
+        /**
+         * @brief Odometry updates held between robot cycles
+         *
+         * 200 Hz is 4 per 20ms cycle; 64 covers a loop overrun of over 300ms
+         * before any are dropped.
+         */
+        static constexpr std::size_t kOdometryQueueSize = 64;
+
+        /**
+         * @brief Every odometry update since the last Periodic()
+         *
+         * Filled by the odometry thread; Periodic() is the only consumer.
+         */
+        SampleQueue<OdometrySample> odometrySamples{kOdometryQueueSize};
+
+        /** @brief This cycle's updates from odometrySamples, for Log() */
+        std::vector<OdometrySample> cycleSamples;
+
+        /**
+         * @brief Latest odometry update, written by the odometry thread (and
+         *        ResetPose()) and read once per cycle without taking CTRE's
+         *        state lock
+         */
+        SeqLock<OdometrySample> latestOdometry;
+
+        /** @brief The drivetrain as of the start of this cycle */
+        OdometrySample snapshot;
+
+        /** @brief Copies each odometry update into odometrySamples */
+        void StartOdometryCapture();
+
+        /** @brief Copies the parts of a CTRE state we use */
+        static OdometrySample CaptureSample(SwerveDriveState const &state);
+
+        // === VISION ===
+        /** @brief Vets camera observations for the estimator */
+        VisionFusion vision;
+
         // === SIMULATION CONSTANTS ===
         /** @brief How often to update simulation physics (200 Hz = every 5ms)
          */
@@ -64,6 +140,23 @@ namespace nfr
         /** @brief Tracks time for simulation physics calculations */
         units::second_t lastSimTime;
 
+        /** @brief Module locations, for simOdometry */
+        frc::SwerveDriveKinematics<4> simKinematics;
+
+        /** @brief Guards the ground truth pose below */
+        mutable std::mutex simPoseMutex;
+
+        /**
+         * @brief Odometry without vision, updated by the simulation thread
+         *
+         * The simulated wheels never slip, so this is where the simulated
+         * robot actually is. Empty until the next update after a reset.
+         */
+        std::optional<frc::SwerveDriveOdometry<4>> simOdometry;
+
+        /** @brief Where simOdometry starts (the last reset pose) */
+        frc::Pose2d simStartPose;
+
         // === FIELD ORIENTATION CONSTANTS ===
         /** @brief Blue alliance perspective: 0° is away from blue alliance wall
          */
@@ -232,6 +325,9 @@ namespace nfr
         /** @brief Starts the simulation thread (only runs in simulation) */
         void StartSimThread();
 
+        /** @brief Moves simOdometry along with the simulated wheels */
+        void UpdateSimPose();
+
         // === MANUAL DRIVE REQUESTS ===
 
         /**
@@ -294,7 +390,9 @@ namespace nfr
          * @param odometryStandardDeviation Trust level for wheel-based position
          * tracking
          * @param visionStandardDeviation Trust level for camera-based position
-         * tracking
+         * tracking, for measurements added with AddVisionMeasurement()
+         * @param visionFusionConfig How camera observations are checked and
+         * weighted (see AddVisionObservation())
          * @param translationPID PID gains for autonomous X/Y movement
          * @param rotationPID PID gains for autonomous rotation
          * @param maxTranslationSpeed Speed limit for safety (m/s)
@@ -312,6 +410,7 @@ namespace nfr
                     units::hertz_t updateRate,
                     std::array<double, 3> const &odometryStandardDeviation,
                     std::array<double, 3> const &visionStandardDeviation,
+                    VisionFusionConfig const &visionFusionConfig,
                     pathplanner::PIDConstants translationPID,
                     pathplanner::PIDConstants rotationPID,
                     units::meters_per_second_t maxTranslationSpeed,
@@ -428,6 +527,19 @@ namespace nfr
          */
         void Periodic() override;
 
+        /**
+         * @brief The drivetrain's state as of the start of this cycle
+         *
+         * Taken once in Periodic(), so everything that runs on the robot
+         * thread in a cycle (commands, path following, logging) reads the
+         * same state without locking or copying CTRE's. Use GetState() only
+         * for something that needs an update from the current cycle.
+         */
+        const OdometrySample &GetSnapshot() const
+        {
+            return snapshot;
+        }
+
         /**
          * @brief Adds vision-based position measurement to improve odometry
          *
@@ -441,6 +553,49 @@ namespace nfr
         void AddVisionMeasurement(frc::Pose2d pose,
                                   units::second_t timestamp) override;
 
+        /**
+         * @brief Queues a camera observation for the pose estimator
+         *
+         * Safe to call from camera threads. Once per cycle, Periodic() checks
+         * the queued observations against where odometry had the robot when
+         * each frame was captured, drops outliers, and adds the rest in
+         * capture order, trusted less the farther and fewer the tags were
+         * (see VisionFusion).
+         *
+         * @param observation Pose estimate from one camera frame
+         * @return false if too many observations were queued this cycle and
+         * this one was dropped
+         */
+        bool AddVisionObservation(const VisionObservation &observation)
+        {
+            return vision.Submit(observation);
+        }
+
+        /**
+         * @brief Moves odometry to a known pose
+         *
+         * Also lets the next vision observation through without comparing it
+         * to the old odometry, and moves this cycle's snapshot and
+         * GetLatestPose() to the new pose right away.
+         */
+        void ResetPose(frc::Pose2d const &pose) override;
+
+        /** @brief Latest odometry pose, from any thread (e.g. simulation) */
+        frc::Pose2d GetLatestPose() const
+        {
+            return latestOdometry.Load().pose;
+        }
+
+        /**
+         * @brief Where the simulated robot actually is, from any thread
+         *
+         * Follows the simulated wheels and gyro from the last ResetPose()
+         * without any vision, so simulated cameras can see the field from
+         * here rather than from the estimate they are correcting. Only
+         * moves in simulation.
+         */
+        frc::Pose2d GetSimulatedPose() const;
+
         // === AUTONOMOUS PATH FOLLOWING ===
 
         /**
@@ -455,6 +610,41 @@ namespace nfr
          */
         void FollowTrajectory(const choreo::SwerveSample &sample);
 
+        /** @brief Follows a single sample from a CachedTrajectory */
+        void FollowTrajectory(const TrajectorySample &sample);
+
+        /**
+         * @brief Creates a command that follows a whole trajectory
+         *
+         * Samples it with a TrajectoryCursor each cycle, from when the
+         * command starts until the trajectory's total time has passed.
+         *
+         * @param trajectory Must outlive the command
+         * @param fromAllianceStart For a trajectory planned on the blue side
+         *        (Choreo and PathPlanner autos): when the command starts,
+         *        flips it to the red side on the red alliance the way
+         *        PathPlanner flips paths, and resets odometry to its first
+         *        pose
+         */
+        frc2::CommandPtr FollowCachedTrajectory(
+            const CachedTrajectory &trajectory,
+            bool fromAllianceStart = false);
+
+        /**
+         * @brief Creates a command that drives to a pose around obstacles
+         *
+         * When it starts, a path from the current pose is searched for on
+         * another thread (see Pathfinder) and smoothed into a trajectory;
+         * the robot holds still until it is ready, then follows it. Ends
+         * once the trajectory is done, or straight away if there is no path.
+         *
+         * @param grid Obstacles, already inflated; must outlive the command
+         * @param goal Where to end up, facing which way
+         * @param constraints Speed limits for the trajectory
+         */
+        frc2::CommandPtr DriveToPose(const NavGrid &grid, frc::Pose2d goal,
+                                     PathConstraints constraints);
+
         // === SWERVE MODULE CALIBRATION ===
 
         /**
@@ -514,6 +704,11 @@ namespace nfr
          * - Motor currents and temperatures
          * - Any error conditions
          *
+         * Also logs every odometry update from this cycle under "odometry",
+         * each stamped with the time it was captured, so the log has the
+         * full 200 Hz instead of one update per cycle, and what vision
+         * fusion accepted and rejected under "vision".
+         *
          * @param log Logging context to write data to
          */
         void Log(const nfr::LogContext &log) const;
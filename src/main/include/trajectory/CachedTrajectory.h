@@ -0,0 +1,179 @@
+#pragma once
+
+#include <units/angle.h>
+#include <units/angular_velocity.h>
+#include <units/force.h>
+#include <units/length.h>
+#include <units/time.h>
+#include <units/velocity.h>
+#include <wpi/MappedFileRegion.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nfr
+{
+    /** @brief Where a trajectory wants the robot at one moment */
+    struct TrajectorySample
+    {
+        units::second_t timestamp = 0_s;
+        units::meter_t x = 0_m;
+        units::meter_t y = 0_m;
+        units::radian_t heading = 0_rad;
+        units::meters_per_second_t vx = 0_mps;
+        units::meters_per_second_t vy = 0_mps;
+        units::radians_per_second_t omega = 0_rad_per_s;
+        /** @brief Field-relative force on each module [FL, FR, BL, BR] */
+        std::array<units::newton_t, 4> moduleForcesX{};
+        std::array<units::newton_t, 4> moduleForcesY{};
+    };
+
+    /**
+     * @brief A trajectory stored as one array per field, ready to sample
+     *
+     * Choreo and PathPlanner hand trajectories over as a list of sample
+     * structs. This keeps each field (time, x, y, heading, ...) in its own
+     * contiguous column instead, so finding the time only walks the time
+     * column and interpolating touches one cache line per field. Sample
+     * with a TrajectoryCursor to make each lookup O(1) as time moves
+     * forward.
+     *
+     * Trajectories are converted once (see TrajectoryImport.h), and can be
+     * saved in that form: a 24-byte header followed by the columns as
+     * little-endian doubles, one after the other. Map() uses such a file in
+     * place, without parsing or copying it, so a build can precompute every
+     * trajectory and the robot only maps them when autonomous starts.
+     */
+    class CachedTrajectory
+    {
+    public:
+        /** @brief The columns, in file order */
+        enum Column : std::size_t
+        {
+            kTime,
+            kX,
+            kY,
+            kHeading,
+            kVx,
+            kVy,
+            kOmega,
+            kModuleForceX,                     ///< 4 columns, FL to BR
+            kModuleForceY = kModuleForceX + 4,  ///< 4 columns, FL to BR
+            kColumnCount = kModuleForceY + 4,
+        };
+
+        /** @brief File extension for saved trajectories */
+        static constexpr std::string_view kExtension = ".trajcache";
+
+        /** @brief An empty trajectory */
+        CachedTrajectory() = default;
+
+        /**
+         * @brief Converts samples to columns
+         *
+         * @throws std::invalid_argument if the timestamps go backwards
+         */
+        explicit CachedTrajectory(std::span<const TrajectorySample> samples);
+
+        CachedTrajectory(CachedTrajectory&& other) noexcept;
+        CachedTrajectory& operator=(CachedTrajectory&& other) noexcept;
+
+        /**
+         * @brief Uses a saved trajectory file in place
+         *
+         * @throws std::runtime_error if the file can't be mapped or isn't a
+         *         saved trajectory
+         */
+        static CachedTrajectory Map(const std::string& path);
+
+        /**
+         * @brief Writes the trajectory for Map()
+         *
+         * @throws std::runtime_error if the file can't be written
+         */
+        void Save(const std::string& path) const;
+
+        std::size_t Size() const
+        {
+            return size;
+        }
+
+        bool Empty() const
+        {
+            return size == 0;
+        }
+
+        /** @brief Timestamp of the last sample */
+        units::second_t TotalTime() const
+        {
+            return units::second_t{Empty() ? 0 : Values(kTime)[size - 1]};
+        }
+
+        /** @brief One column, in the units TrajectorySample uses (SI) */
+        std::span<const double> Values(std::size_t column) const
+        {
+            return {data + column * size, size};
+        }
+
+        /** @brief Sample `index` */
+        TrajectorySample operator[](std::size_t index) const;
+
+        /**
+         * @brief Interpolated sample at a time (binary search)
+         *
+         * Times outside the trajectory clamp to its ends.
+         */
+        TrajectorySample Sample(units::second_t time) const;
+
+        /**
+         * @brief Interpolates between sample `index` and the next one
+         *
+         * @param fraction 0 for sample `index`, 1 for the next
+         */
+        TrajectorySample Interpolate(std::size_t index, double fraction) const;
+
+    private:
+        // Column-major: all times, then all x, ...; points into `owned` or
+        // `region`
+        const double* data = nullptr;
+        std::size_t size = 0;
+        std::vector<double> owned;
+        wpi::MappedFileRegion region;
+    };
+
+    /**
+     * @brief Samples a trajectory as time moves forward
+     *
+     * Remembers which samples the last lookup fell between and walks on
+     * from there, so following a trajectory at 50 Hz costs O(1) per cycle
+     * instead of a search. Going back in time falls back to a binary
+     * search.
+     */
+    class TrajectoryCursor
+    {
+    public:
+        /** @param trajectory Must outlive the cursor */
+        explicit TrajectoryCursor(const CachedTrajectory& trajectory)
+            : trajectory(&trajectory)
+        {
+        }
+
+        /** @brief Interpolated sample at a time, clamped to the ends */
+        TrajectorySample Sample(units::second_t time);
+
+        /** @brief Starts the next lookup from the beginning */
+        void Reset()
+        {
+            index = 0;
+        }
+
+    private:
+        const CachedTrajectory* trajectory;
+        std::size_t index = 0;
+    };
+}  // namespace nfr
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <choreo/trajectory/SwerveSample.h>
+#include <choreo/trajectory/Trajectory.h>
+#include <pathplanner/lib/trajectory/PathPlannerTrajectory.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "trajectory/CachedTrajectory.h"
+
+namespace nfr
+{
+    /** @brief Where saved trajectories go, under the deploy directory */
+    inline constexpr std::string_view kTrajectoryCacheDirectory =
+        "trajectories";
+
+    /** @brief Converts a Choreo trajectory (its forces are field-relative) */
+    CachedTrajectory FromChoreo(
+        const choreo::Trajectory<choreo::SwerveSample>& trajectory);
+
+    /**
+     * @brief Converts a generated PathPlanner trajectory
+     *
+     * PathPlanner gives module forces relative to the robot; they are turned
+     * to the field by each state's heading, to match Choreo.
+     */
+    CachedTrajectory FromPathPlanner(
+        pathplanner::PathPlannerTrajectory trajectory);
+
+    /**
+     * @brief Converts a trajectory from the deploy directory
+     *
+     * Looks for a Choreo trajectory (choreo/<name>.traj) first, then a
+     * PathPlanner path (pathplanner/paths/<name>.path), which is generated
+     * with the robot config from the PathPlanner GUI.
+     *
+     * @return std::nullopt if neither exists or can be loaded
+     */
+    std::optional<CachedTrajectory> ConvertTrajectory(std::string_view name);
+
+    /**
+     * @brief Loads a trajectory, from its saved form if there is one
+     *
+     * Maps trajectories/<name>.trajcache from the deploy directory, which the
+     * build saves ahead of time, and only falls back to ConvertTrajectory()
+     * (parsing JSON, and generating PathPlanner paths) without it.
+     *
+     * @return std::nullopt if the trajectory can't be found
+     */
+    std::optional<CachedTrajectory> LoadTrajectory(std::string_view name);
+}  // namespace nfr
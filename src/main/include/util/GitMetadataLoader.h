@@ -43,39 +43,42 @@ struct GitMetadata
     int total_commit_count;         ///< Total number of commits in repository
 };
 
-#include <logging/Logger.h>
+#include <logging/LogSchema.h>
+
+#include <tuple>
 
 /**
- * @brief Logs git metadata to the logging system
- *
- * This function integrates GitMetadata with our custom logging system.
- * It's called automatically to record version information in the logs.
+ * @brief Describes how GitMetadata is logged
  *
- * @param logContext Where to write the git information
- * @param metadata The git metadata to log
+ * Every field is logged under its own name, e.g. "git/commit_id". The keys
+ * are resolved once, so logging the metadata again costs one write per
+ * field. New fields only need a line here.
  */
-inline void Log(const nfr::LogContext& logContext, const GitMetadata& metadata)
+template <>
+struct nfr::LogSchema<GitMetadata>
 {
-    logContext["branch"] << metadata.branch;
-    logContext["build_host"] << metadata.build_host;
-    logContext["build_user_email"] << metadata.build_user_email;
-    logContext["build_user_name"] << metadata.build_user_name;
-    logContext["build_version"] << metadata.build_version;
-    logContext["closest_tag_commit_count"] << metadata.closest_tag_commit_count;
-    logContext["closest_tag_name"] << metadata.closest_tag_name;
-    logContext["commit_id"] << metadata.commit_id;
-    logContext["commit_id_abbrev"] << metadata.commit_id_abbrev;
-    logContext["commit_id_describe"] << metadata.commit_id_describe;
-    logContext["commit_message_full"] << metadata.commit_message_full;
-    logContext["commit_message_short"] << metadata.commit_message_short;
-    logContext["commit_time"] << metadata.commit_time;
-    logContext["commit_user_email"] << metadata.commit_user_email;
-    logContext["commit_user_name"] << metadata.commit_user_name;
-    logContext["dirty"] << metadata.dirty;
-    logContext["remote_origin_url"] << metadata.remote_origin_url;
-    logContext["tags"] << metadata.tags;
-    logContext["total_commit_count"] << metadata.total_commit_count;
-}
+    static constexpr std::tuple kFields{
+        NFR_LOG_FIELD(GitMetadata, branch),
+        NFR_LOG_FIELD(GitMetadata, build_host),
+        NFR_LOG_FIELD(GitMetadata, build_user_email),
+        NFR_LOG_FIELD(GitMetadata, build_user_name),
+        NFR_LOG_FIELD(GitMetadata, build_version),
+        NFR_LOG_FIELD(GitMetadata, closest_tag_commit_count),
+        NFR_LOG_FIELD(GitMetadata, closest_tag_name),
+        NFR_LOG_FIELD(GitMetadata, commit_id),
+        NFR_LOG_FIELD(GitMetadata, commit_id_abbrev),
+        NFR_LOG_FIELD(GitMetadata, commit_id_describe),
+        NFR_LOG_FIELD(GitMetadata, commit_message_full),
+        NFR_LOG_FIELD(GitMetadata, commit_message_short),
+        NFR_LOG_FIELD(GitMetadata, commit_time),
+        NFR_LOG_FIELD(GitMetadata, commit_user_email),
+        NFR_LOG_FIELD(GitMetadata, commit_user_name),
+        NFR_LOG_FIELD(GitMetadata, dirty),
+        NFR_LOG_FIELD(GitMetadata, remote_origin_url),
+        NFR_LOG_FIELD(GitMetadata, tags),
+        NFR_LOG_FIELD(GitMetadata, total_commit_count),
+    };
+};
 
 /**
  * @brief Loads git metadata from a properties file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace nfr
+{
+    /**
+     * @brief Preallocated single-producer/single-consumer queue of samples
+     *
+     * For handing fixed-size samples from a fast thread (like CTRE's odometry
+     * thread) to the robot thread. Neither side ever locks or allocates, so
+     * the producer can't be held up by the consumer. When the queue is full,
+     * new samples are dropped and counted rather than overwriting ones the
+     * consumer may be reading.
+     *
+     * @tparam T Sample type; copied in and out, so keep it trivially small
+     */
+    template <typename T>
+    class SampleQueue
+    {
+    public:
+        /** @param capacity Number of samples, rounded up to a power of two */
+        explicit SampleQueue(std::size_t capacity)
+            : mask(std::bit_ceil(capacity) - 1),
+              slots(std::make_unique<T[]>(mask + 1))
+        {
+        }
+        SampleQueue(const SampleQueue&) = delete;
+        SampleQueue& operator=(const SampleQueue&) = delete;
+
+        /**
+         * @brief Adds a sample (producer only)
+         *
+         * @return false if the queue was full and the sample was dropped
+         */
+        bool TryPush(const T& sample)
+        {
+            const std::uint64_t current = head.load(std::memory_order_relaxed);
+            if (current - tail.load(std::memory_order_acquire) > mask)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            slots[current & mask] = sample;
+            head.store(current + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Hands every sample queued so far to a function, oldest
+         *        first (consumer only)
+         *
+         * @return Number of samples consumed
+         */
+        template <typename F>
+        std::size_t Drain(F&& consume)
+        {
+            const std::uint64_t current = tail.load(std::memory_order_relaxed);
+            const std::uint64_t end = head.load(std::memory_order_acquire);
+            for (std::uint64_t i = current; i != end; ++i)
+            {
+                consume(static_cast<const T&>(slots[i & mask]));
+            }
+            tail.store(end, std::memory_order_release);
+            return static_cast<std::size_t>(end - current);
+        }
+
+        /** @brief Samples dropped because the queue was full (any thread) */
+        std::uint64_t Dropped() const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        std::size_t Capacity() const
+        {
+            return mask + 1;
+        }
+
+    private:
+        const std::size_t mask;
+        std::unique_ptr<T[]> slots;
+        // Each index on its own cache line so the two threads don't contend
+        alignas(64) std::atomic<std::uint64_t> head{0};
+        alignas(64) std::atomic<std::uint64_t> tail{0};
+        std::atomic<std::uint64_t> dropped{0};
+    };
+}  // namespace nfr
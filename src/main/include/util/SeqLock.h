@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace nfr
+{
+    /**
+     * @brief Latest value of something one thread updates and others read,
+     *        without either side locking
+     *
+     * A sequence lock: the writer bumps a counter to odd, copies the value
+     * in, and bumps it back to even. Readers copy the value out and retry if
+     * the counter was odd or changed meanwhile. The writer is never held up
+     * by readers, which is what a high-rate thread (like CTRE's odometry
+     * thread) needs; readers only retry when they overlap a write. Writes
+     * usually come from one thread; one from another thread (like a pose
+     * reset) waits for a write in progress to finish.
+     *
+     * The value is stored as atomic words so the copies are well-defined
+     * even while they race.
+     *
+     * @tparam T Trivially copyable, default constructible value type
+     */
+    template <typename T>
+        requires std::is_trivially_copyable_v<T> &&
+                 std::is_default_constructible_v<T>
+    class SeqLock
+    {
+    public:
+        SeqLock() = default;
+        explicit SeqLock(const T& value)
+        {
+            Store(value);
+        }
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+        /** @brief Replaces the value (any thread) */
+        void Store(const T& value)
+        {
+            std::array<std::uint64_t, kWords> buffer{};
+            std::memcpy(buffer.data(), &value, sizeof(T));
+
+            // Taking the count from even to odd claims the write; acquiring
+            // orders it after the previous writer's
+            std::uint64_t start = sequence.load(std::memory_order_relaxed);
+            do
+            {
+                while ((start & 1) != 0)
+                {
+                    start = sequence.load(std::memory_order_relaxed);
+                }
+            } while (!sequence.compare_exchange_weak(
+                start, start + 1, std::memory_order_acquire,
+                std::memory_order_relaxed));
+            // Keeps the word stores below from moving above the odd count
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < kWords; ++i)
+            {
+                words[i].store(buffer[i], std::memory_order_relaxed);
+            }
+            sequence.store(start + 2, std::memory_order_release);
+        }
+
+        /** @brief Copies out the latest complete value (any thread) */
+        T Load() const
+        {
+            std::array<std::uint64_t, kWords> buffer;
+            std::uint64_t start;
+            do
+            {
+                start = sequence.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < kWords; ++i)
+                {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                // Keeps the word loads above from moving below the recheck
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((start & 1) != 0 ||
+                     sequence.load(std::memory_order_relaxed) != start);
+
+            // T is trivially copyable, so this is fine even when it has
+            // default member initializers (GCC's -Wclass-memaccess)
+            T value;
+            std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+            return value;
+        }
+
+    private:
+        static constexpr std::size_t kWords =
+            (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        std::atomic<std::uint64_t> sequence{0};
+        std::array<std::atomic<std::uint64_t>, kWords> words{};
+    };
+}  // namespace nfr
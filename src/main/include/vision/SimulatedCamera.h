@@ -0,0 +1,92 @@
+#pragma once
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/geometry/Transform2d.h>
+#include <units/angle.h>
+#include <units/length.h>
+#include <units/time.h>
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "vision/VisionFusion.h"
+
+namespace nfr
+{
+    /** @brief Where a simulated camera is and how good it is */
+    struct SimulatedCameraConfig
+    {
+        std::uint8_t id = 0;
+        /** @brief Camera position and heading relative to the robot center */
+        frc::Transform2d robotToCamera;
+        units::radian_t fieldOfView = 1.2_rad;
+        units::meter_t maxRange = 5_m;
+        /** @brief Time from capture until the pose estimate is ready */
+        units::second_t latency = 40_ms;
+        /**
+         * @brief Position noise (1 sigma) with one tag 1 m away
+         *
+         * Scales with distance² / tag count, like VisionFusion's standard
+         * deviations.
+         */
+        units::meter_t translationNoise = 0.02_m;
+        units::radian_t rotationNoise = 0.02_rad;
+        /** @brief Fraction of frames that are 2-4 m off (misread tags) */
+        double outlierRate = 0;
+    };
+
+    /**
+     * @brief Camera that turns a known robot pose into the observations a
+     *        real AprilTag pipeline would produce
+     *
+     * A tag is seen when it is within range and field of view and the camera
+     * is in front of it. The pose is the true one plus Gaussian noise that
+     * grows with distance and shrinks with tag count; optionally some frames
+     * are wildly wrong, to exercise outlier rejection. Each frame comes out
+     * `latency` after it was captured, stamped with its capture time.
+     *
+     * Used in simulation to feed VisionFusion from a camera thread, and in
+     * tests with a fixed seed for repeatable detections.
+     */
+    class SimulatedCamera
+    {
+    public:
+        /**
+         * @param config Camera placement and quality
+         * @param tags Field poses of the AprilTags (facing out of the tag)
+         * @param seed Random seed for the noise
+         */
+        SimulatedCamera(const SimulatedCameraConfig& config,
+                        std::vector<frc::Pose2d> tags,
+                        std::uint64_t seed = 1);
+
+        /**
+         * @brief Takes a frame and returns one whose processing has finished
+         *
+         * @param now Current FPGA time
+         * @param truePose Where the robot really is now
+         * @return The oldest frame captured at least `latency` ago, if any
+         */
+        std::optional<VisionObservation> Update(units::second_t now,
+                                                const frc::Pose2d& truePose);
+
+        /**
+         * @brief What the camera sees at a pose, with no latency
+         *
+         * @return nullopt if no tag is visible
+         */
+        std::optional<VisionObservation> Capture(units::second_t now,
+                                                 const frc::Pose2d& truePose);
+
+    private:
+        SimulatedCameraConfig config;
+        std::vector<frc::Pose2d> tags;
+        std::mt19937_64 random;
+        std::normal_distribution<double> noise;
+        std::uniform_real_distribution<double> uniform;
+        std::deque<VisionObservation> inFlight;
+    };
+}  // namespace nfr
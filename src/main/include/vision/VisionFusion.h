@@ -0,0 +1,191 @@
+#pragma once
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/interpolation/TimeInterpolatableBuffer.h>
+#include <units/angle.h>
+#include <units/length.h>
+#include <units/time.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace nfr
+{
+    class LogContext;
+
+    /** @brief One camera's estimate of the robot pose from AprilTags */
+    struct VisionObservation
+    {
+        /** @brief FPGA time the frame was captured (not when it arrived) */
+        units::second_t timestamp = 0_s;
+        frc::Pose2d pose;
+        int tagCount = 0;
+        units::meter_t averageTagDistance = 0_m;
+        std::uint8_t camera = 0;
+    };
+
+    /** @brief An observation that passed VisionFusion's checks */
+    struct VisionMeasurement
+    {
+        units::second_t timestamp = 0_s;
+        frc::Pose2d pose;
+        /** @brief [x (m), y (m), rotation (rad)] */
+        std::array<double, 3> standardDeviations{};
+    };
+
+    /** @brief Tuning for VisionFusion */
+    struct VisionFusionConfig
+    {
+        /**
+         * @brief Standard deviations of one tag seen from 1 m away
+         *
+         * Scaled by distance² / tag count, so a far single tag is trusted
+         * much less than several close ones. [x, y, rotation]
+         */
+        std::array<double, 3> singleTagStandardDeviation{0.05, 0.05, 9999999};
+        /** @brief Same, for poses solved from two or more tags */
+        std::array<double, 3> multiTagStandardDeviation{0.02, 0.02, 0.05};
+        /** @brief Observations with tags farther than this are dropped */
+        units::meter_t maxTagDistance = 5_m;
+        /** @brief Most an observation may disagree with odometry */
+        units::meter_t maxTranslationError = 1_m;
+        units::radian_t maxRotationError = 0.5_rad;
+        /**
+         * @brief Multi-tag observations in a row that must disagree with
+         *        odometry by about the same offset before odometry is
+         *        assumed lost (a collision or wheel slip) and vision is let
+         *        through to re-seed it, as after a reset
+         */
+        int realignAfter = 5;
+        /** @brief Odometry kept for checking late observations */
+        units::second_t historyLength = 1_s;
+        /** @brief Observations queued per cycle before more are dropped */
+        std::size_t queueSize = 32;
+    };
+
+    /**
+     * @brief Checks and batches vision observations for the pose estimator
+     *
+     * Cameras hand observations to Submit() from their own threads. Once per
+     * robot cycle, Process() takes everything queued since the last cycle,
+     * sorts it by capture time, and drops observations that:
+     * - see no tags, or only tags beyond `maxTagDistance`
+     * - were captured before the odometry history starts (or in the future)
+     * - disagree with where odometry had the robot when the frame was
+     *   captured, by more than `maxTranslationError`/`maxRotationError`
+     *
+     * Comparing against the pose at capture time rather than the current
+     * one is what lets a frame from 100 ms ago be checked fairly while the
+     * robot is moving. Until an observation agrees with odometry (and
+     * again after Reset()), odometry may not know where on the field it is,
+     * so instead of that check only multi-tag observations are let through.
+     * Those pull the estimate toward them over a few frames until one
+     * agrees. The same happens when `realignAfter` multi-tag observations
+     * in a row put the robot about the same distance from odometry: one
+     * misread is dropped, but odometry knocked off by a collision is fixed.
+     *
+     * The rest come back in capture order with standard deviations scaled
+     * by tag distance and count, for the estimator to fuse in one go.
+     *
+     * Submit() is thread-safe; everything else belongs to the robot thread.
+     */
+    class VisionFusion
+    {
+    public:
+        /** @brief Why observations were dropped */
+        enum Rejection : std::uint8_t
+        {
+            kNoTags,
+            kTooFar,
+            kStale,
+            kDisagrees,
+            kUnaligned,  ///< Single tag while odometry isn't checked yet
+            kRejectionCount,
+        };
+
+        /** @brief What Process() has done so far */
+        struct Stats
+        {
+            std::uint64_t accepted = 0;
+            std::array<std::uint64_t, kRejectionCount> rejected{};
+            std::uint64_t dropped = 0;  ///< Queue was full
+            /** @brief Times odometry was assumed lost and vision re-seeded */
+            std::uint64_t realigned = 0;
+        };
+
+        explicit VisionFusion(const VisionFusionConfig& config);
+
+        /**
+         * @brief Queues an observation for the next Process() (any thread)
+         *
+         * @return false if the queue was full and the observation was
+         *         dropped
+         */
+        bool Submit(const VisionObservation& observation);
+
+        /**
+         * @brief Records where odometry had the robot at a time
+         *
+         * @param timestamp FPGA time of the odometry update
+         * @param pose Estimated pose at that time
+         */
+        void AddOdometry(units::second_t timestamp, const frc::Pose2d& pose);
+
+        /**
+         * @brief Checks every queued observation
+         *
+         * @param now Current FPGA time
+         * @return Accepted measurements, oldest first; valid until the next
+         *         call
+         */
+        std::span<const VisionMeasurement> Process(units::second_t now);
+
+        /**
+         * @brief Forgets the odometry history after the pose is reset, and
+         *        accepts multi-tag observations without comparing against
+         *        it until one agrees
+         */
+        void Reset();
+
+        Stats GetStats() const;
+
+        /** @brief Logs counts and the latest accepted and rejected poses */
+        void Log(const LogContext& log) const;
+
+    private:
+        std::array<double, 3> StandardDeviations(
+            const VisionObservation& observation) const;
+        std::optional<Rejection> Check(const VisionObservation& observation,
+                                       units::second_t now);
+        bool LostOdometry(const VisionObservation& observation,
+                          const frc::Pose2d& expected);
+
+        VisionFusionConfig config;
+
+        std::mutex mutex;
+        // Filled by Submit(); swapped with `batch` by Process(), so neither
+        // side allocates once both have grown to `queueSize`
+        std::vector<VisionObservation> pending;
+        std::atomic<std::uint64_t> dropped{0};
+
+        std::vector<VisionObservation> batch;
+        std::vector<VisionMeasurement> accepted;
+        frc::TimeInterpolatableBuffer<frc::Pose2d> history;
+        // Set once an accepted observation agrees with odometry
+        bool aligned = false;
+        // Multi-tag observations in a row that disagreed with odometry, and
+        // by how far the last one did
+        int disagreements = 0;
+        frc::Translation2d disagreementOffset;
+
+        Stats stats;  // Except `dropped`, which Submit() counts
+        frc::Pose2d lastAccepted;
+        frc::Pose2d lastRejected;
+    };
+}  // namespace nfr
@@ -0,0 +1,56 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Per thread, so allocations made by background threads (NT, DataLog)
+    // don't show up in the robot-thread counts the tests care about
+    thread_local std::size_t allocationCount = 0;
+
+    void* CountedAlloc(std::size_t size)
+    {
+        ++allocationCount;
+        if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+}  // namespace
+
+std::size_t nfr::test::AllocationCount()
+{
+    return allocationCount;
+}
+
+void* operator new(std::size_t size)
+{
+    return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace nfr::test
+{
+    /**
+     * @brief Number of global operator new calls made on this thread so far
+     *
+     * The test binary replaces the global allocation functions to count
+     * calls, so tests can assert that a hot path doesn't allocate:
+     *
+     * ```cpp
+     * auto before = AllocationCount();
+     * logger["x"] << value;
+     * EXPECT_EQ(AllocationCount(), before);
+     * ```
+     */
+    std::size_t AllocationCount();
+}  // namespace nfr::test
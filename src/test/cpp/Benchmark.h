@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace nfr::test
+{
+    /**
+     * @brief Multiplier for wall-clock budgets, from NFR_BENCHMARK_SCALE
+     *
+     * Defaults to 3: the budgets are already loose, and tripling them keeps
+     * a busy CI runner from failing the tests while an order-of-magnitude
+     * regression still does. Set it to 1 to check the budgets as written,
+     * higher on a slower machine, or to 0 to only report times:
+     *
+     * ```cpp
+     * if (double scale = TimeScale(); scale > 0)
+     * {
+     *     EXPECT_LT(microseconds, 500 * scale);
+     * }
+     * ```
+     */
+    inline double TimeScale()
+    {
+        const char* scale = std::getenv("NFR_BENCHMARK_SCALE");
+        return scale ? std::atof(scale) : 3.0;
+    }
+
+    /**
+     * @brief Runs `op` several times and returns the fastest run, so one
+     *        descheduling doesn't skew the result
+     */
+    template <typename F>
+    std::chrono::steady_clock::duration Fastest(int runs, F&& op)
+    {
+        using Clock = std::chrono::steady_clock;
+        auto fastest = Clock::duration::max();
+        for (int i = 0; i < runs; ++i)
+        {
+            auto begin = Clock::now();
+            op();
+            fastest = std::min(fastest, Clock::now() - begin);
+        }
+        return fastest;
+    }
+}  // namespace nfr::test
@@ -0,0 +1,159 @@
+#include <trajectory/CachedTrajectory.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+using namespace units::literals;
+
+namespace
+{
+    /** @brief Driving along x at 2 m/s, one sample every 0.1 s */
+    std::vector<TrajectorySample> DrivingSamples(int count = 11)
+    {
+        std::vector<TrajectorySample> samples;
+        for (int i = 0; i < count; ++i)
+        {
+            TrajectorySample sample;
+            sample.timestamp = units::second_t{i * 0.1};
+            sample.x = units::meter_t{i * 0.2};
+            sample.y = 1_m;
+            sample.heading = units::radian_t{i * 0.1};
+            sample.vx = 2_mps;
+            sample.omega = 1_rad_per_s;
+            sample.moduleForcesX[3] = units::newton_t{i * 10.0};
+            samples.push_back(sample);
+        }
+        return samples;
+    }
+
+    std::string TempPath(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+}  // namespace
+
+TEST(CachedTrajectoryTest, StoresEachFieldAsAColumn)
+{
+    CachedTrajectory trajectory{DrivingSamples()};
+    ASSERT_EQ(trajectory.Size(), 11u);
+    EXPECT_DOUBLE_EQ(trajectory.TotalTime().value(), 1);
+
+    auto x = trajectory.Values(CachedTrajectory::kX);
+    ASSERT_EQ(x.size(), 11u);
+    EXPECT_DOUBLE_EQ(x[5], 1);
+    auto force = trajectory.Values(CachedTrajectory::kModuleForceX + 3);
+    EXPECT_DOUBLE_EQ(force[10], 100);
+
+    auto sample = trajectory[4];
+    EXPECT_DOUBLE_EQ(sample.timestamp.value(), 0.4);
+    EXPECT_DOUBLE_EQ(sample.y.value(), 1);
+    EXPECT_DOUBLE_EQ(sample.moduleForcesX[3].value(), 40);
+}
+
+TEST(CachedTrajectoryTest, CursorInterpolatesAsTimeMovesForward)
+{
+    CachedTrajectory trajectory{DrivingSamples()};
+    TrajectoryCursor cursor{trajectory};
+    for (int i = 0; i <= 50; ++i)
+    {
+        // Robot loop times: several lookups between each pair of samples
+        units::second_t time{i * 0.02};
+        auto sample = cursor.Sample(time);
+        EXPECT_NEAR(sample.timestamp.value(), time.value(), 1e-9);
+        EXPECT_NEAR(sample.x.value(), 2 * time.value(), 1e-9);
+        EXPECT_NEAR(sample.heading.value(), time.value(), 1e-9);
+        EXPECT_NEAR(sample.moduleForcesX[3].value(), 100 * time.value(), 1e-9);
+        // Binary search gives the same answer
+        EXPECT_NEAR(trajectory.Sample(time).x.value(), sample.x.value(), 1e-12);
+    }
+}
+
+TEST(CachedTrajectoryTest, CursorHandlesJumpsAndTheEnds)
+{
+    CachedTrajectory trajectory{DrivingSamples()};
+    TrajectoryCursor cursor{trajectory};
+
+    // Before the start and after the end clamp to the first and last sample
+    EXPECT_DOUBLE_EQ(cursor.Sample(-1_s).x.value(), 0);
+    EXPECT_DOUBLE_EQ(cursor.Sample(5_s).x.value(), 2);
+    // Back in time, after the cursor has walked to the end
+    EXPECT_NEAR(cursor.Sample(0.25_s).x.value(), 0.5, 1e-9);
+    EXPECT_NEAR(cursor.Sample(0.35_s).x.value(), 0.7, 1e-9);
+    EXPECT_DOUBLE_EQ(cursor.Sample(-1_s).x.value(), 0);
+    // Forward several samples at once
+    EXPECT_NEAR(cursor.Sample(0.95_s).x.value(), 1.9, 1e-9);
+
+    cursor.Reset();
+    EXPECT_NEAR(cursor.Sample(0.05_s).x.value(), 0.1, 1e-9);
+
+    CachedTrajectory empty;
+    TrajectoryCursor emptyCursor{empty};
+    EXPECT_DOUBLE_EQ(emptyCursor.Sample(1_s).x.value(), 0);
+    EXPECT_DOUBLE_EQ(empty.TotalTime().value(), 0);
+}
+
+TEST(CachedTrajectoryTest, InterpolatesHeadingTheShortWay)
+{
+    auto samples = DrivingSamples(2);
+    samples[0].heading = units::radian_t{std::numbers::pi - 0.1};
+    samples[1].heading = units::radian_t{-std::numbers::pi + 0.1};
+    CachedTrajectory trajectory{samples};
+
+    // Through ±π, not back through 0
+    auto heading = trajectory.Sample(0.05_s).heading.value();
+    EXPECT_NEAR(std::abs(heading), std::numbers::pi, 1e-9);
+}
+
+TEST(CachedTrajectoryTest, RejectsTimestampsThatGoBackwards)
+{
+    auto samples = DrivingSamples();
+    samples[5].timestamp = 0.1_s;
+    EXPECT_THROW(CachedTrajectory{samples}, std::invalid_argument);
+}
+
+TEST(CachedTrajectoryTest, MapsWhatWasSaved)
+{
+    auto path = TempPath("cached_trajectory_test.trajcache");
+    {
+        CachedTrajectory trajectory{DrivingSamples()};
+        trajectory.Save(path);
+    }
+
+    auto mapped = CachedTrajectory::Map(path);
+    ASSERT_EQ(mapped.Size(), 11u);
+    EXPECT_DOUBLE_EQ(mapped.TotalTime().value(), 1);
+    TrajectoryCursor cursor{mapped};
+    EXPECT_NEAR(cursor.Sample(0.55_s).x.value(), 1.1, 1e-9);
+    EXPECT_DOUBLE_EQ(mapped[10].moduleForcesX[3].value(), 100);
+
+    // Still usable after being moved
+    CachedTrajectory moved = std::move(mapped);
+    EXPECT_DOUBLE_EQ(moved[5].x.value(), 1);
+    EXPECT_TRUE(mapped.Empty());
+}
+
+TEST(CachedTrajectoryTest, RefusesFilesItDidNotSave)
+{
+    EXPECT_THROW(CachedTrajectory::Map(TempPath("no_such.trajcache")),
+                 std::runtime_error);
+
+    auto path = TempPath("not_a_trajectory.trajcache");
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "{\"name\": \"a Choreo trajectory, not a saved one\"}";
+    }
+    EXPECT_THROW(CachedTrajectory::Map(path), std::runtime_error);
+
+    // Cut off partway through the columns
+    CachedTrajectory{DrivingSamples()}.Save(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(CachedTrajectory::Map(path), std::runtime_error);
+}
@@ -0,0 +1,147 @@
+#include <logging/Logger.h>
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    /** @brief Logs a lazy value and counts how often it was computed */
+    struct CountingValue
+    {
+        int computed = 0;
+
+        void LogTo(const LogContext& log)
+        {
+            log << [&]
+            {
+                ++computed;
+                return static_cast<double>(computed);
+            };
+        }
+    };
+}  // namespace
+
+TEST(LazyLogTest, NotComputedWithoutSinks)
+{
+    Logger logger;
+    CountingValue value;
+    for (int i = 0; i < 10; ++i)
+    {
+        value.LogTo(logger["lazy"]);
+    }
+    EXPECT_EQ(value.computed, 0);
+}
+
+TEST(LazyLogTest, ComputedOnlyForSamplesDecimationKeeps)
+{
+    Logger logger;
+    logger.EnableWPILogging(3);
+    CountingValue value;
+    for (int i = 0; i < 9; ++i)
+    {
+        value.LogTo(logger["lazy"]);
+    }
+    EXPECT_EQ(value.computed, 3);
+}
+
+TEST(LazyLogTest, ComputedEveryTimeForSinksThatKeepEverything)
+{
+    Logger logger;
+    logger.EnableWPILogging(3);
+    logger.EnableFlightRecorder();
+    CountingValue value;
+    for (int i = 0; i < 9; ++i)
+    {
+        value.LogTo(logger["lazy"]);
+    }
+    EXPECT_EQ(value.computed, 9);
+}
+
+TEST(LazyLogTest, NotComputedWhenTheContextIsDisabled)
+{
+    Logger logger;
+    logger.EnableFlightRecorder();
+    ASSERT_TRUE(logger.SetLogLevelRules("lazy=off"));
+    CountingValue value;
+    value.LogTo(logger["lazy"]);
+    EXPECT_EQ(value.computed, 0);
+}
+
+TEST(LazyLogTest, ComputedEveryTimeForKeysWPILogKeepsInFull)
+{
+    Logger logger;
+    logger.EnableWPILogging(3);
+    logger.GetSink<WPILogManager>()->KeepEvery(
+        logger.GetKeys().Child(kRootLogKey, "lazy"));
+    CountingValue value;
+    for (int i = 0; i < 9; ++i)
+    {
+        value.LogTo(logger["lazy"]);
+    }
+    EXPECT_EQ(value.computed, 9);
+}
+
+TEST(LazyLogTest, NotComputedForKeysTheFlightRecorderExcludes)
+{
+    Logger logger;
+    logger.EnableWPILogging(3);
+    logger.EnableFlightRecorder(std::chrono::seconds{10}, 4 << 20,
+                                "robot/Robot3d");
+    CountingValue excluded;
+    CountingValue recorded;
+    for (int i = 0; i < 9; ++i)
+    {
+        excluded.LogTo(logger["robot"]["Robot3d"]["component_1"]);
+        recorded.LogTo(logger["robot"]["drive"]["speed"]);
+    }
+    EXPECT_EQ(excluded.computed, 3);
+    EXPECT_EQ(recorded.computed, 9);
+}
+
+TEST(LazyLogTest, ComputedOnlyWhenTheNTRateAllowsIt)
+{
+    Logger logger;
+    LogBandwidthBudget budget;
+    budget.rates = LogRateRules::Parse("lazy=10").value();
+    logger.EnableNTLogging("lazy_log_test", {}, budget);
+    CountingValue value;
+    // Far quicker than 10 per second
+    for (int i = 0; i < 9; ++i)
+    {
+        value.LogTo(logger["lazy"]);
+    }
+    EXPECT_EQ(value.computed, 1);
+}
+
+TEST(LazyLogTest, ComputedOnlyWhenARobotSinkWantsIt)
+{
+    // The sinks Robot::Robot() enables, as they are set up at competitions
+    Logger logger;
+    logger.EnableFlightRecorder(std::chrono::seconds{10}, 4 << 20,
+                                "robot/Robot3d");
+    logger.EnableWPILogging(5);
+    LogBandwidthBudget budget;
+    budget.bytesPerSecond = 40'000;
+    budget.rates =
+        LogRateRules::Parse(
+            "robot/drive/pose=50@0,robot/drive=10@1,robot/match_time=1@1,"
+            "robot/Robot3d=10@2,git=once@0,cerr=max@0,cout=max@0,perf=2@3,"
+            "logger=1@3")
+            .value();
+    budget.defaultRate = {.hz = 10, .priority = 2};
+    logger.EnableNTLogging("lazy_log_test", {}, budget);
+    logger.EnableStatistics("robot/drive/speed,drive/sim/period");
+
+    // Ten cycles' worth in far less than a cycle: WPILog keeps the 1st and
+    // 6th, NT's 10 Hz rate only lets the 1st through, and the recorder and
+    // statistics don't keep Robot3d at all
+    CountingValue value;
+    for (int i = 0; i < 10; ++i)
+    {
+        value.LogTo(logger["robot"]["Robot3d"]["component_1"]);
+    }
+    EXPECT_EQ(value.computed, 2);
+}
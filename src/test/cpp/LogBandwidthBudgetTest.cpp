@@ -0,0 +1,182 @@
+#include <logging/LogBandwidthBudget.h>
+#include <logging/LogKeyRegistry.h>
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    constexpr std::int64_t kLoop = 20'000;  // 50 Hz, in microseconds
+
+    LogBandwidthBudget MakeBudget(double bytesPerSecond, const char* rates)
+    {
+        LogBandwidthBudget budget;
+        budget.bytesPerSecond = bytesPerSecond;
+        budget.rates = LogRateRules::Parse(rates).value();
+        return budget;
+    }
+}  // namespace
+
+TEST(LogBandwidthBudgetTest, ParsesRatesAndPriorities)
+{
+    auto rules =
+        LogRateRules::Parse("robot=10, robot/drive/pose=50@0 ,git=once@3");
+    ASSERT_TRUE(rules);
+
+    EXPECT_DOUBLE_EQ(rules->Find("robot/drive/pose")->hz, 50);
+    EXPECT_EQ(rules->Find("robot/drive/pose")->priority, 0);
+    EXPECT_DOUBLE_EQ(rules->Find("robot/drive/speeds")->hz, 10);
+    EXPECT_EQ(rules->Find("robot/drive/speeds")->priority,
+              LogRate::kDefaultPriority);
+    EXPECT_TRUE(rules->Find("git/sha")->once);
+    EXPECT_FALSE(rules->Find("perf"));
+
+    EXPECT_FALSE(LogRateRules::Parse("robot=fast"));
+    EXPECT_FALSE(LogRateRules::Parse("robot=0"));
+    EXPECT_FALSE(LogRateRules::Parse("robot=10@4"));
+    EXPECT_FALSE(LogRateRules::Parse("=10"));
+}
+
+TEST(LogBandwidthBudgetTest, LimitsKeysToTheirRate)
+{
+    LogKeyRegistry keys;
+    LogBandwidthLimiter limiter{keys, MakeBudget(0, "slow=10,git=once")};
+    LogKey slow = keys.Child(kRootLogKey, "slow");
+    LogKey fast = keys.Child(kRootLogKey, "fast");
+    LogKey git = keys.Child(kRootLogKey, "git/sha");
+
+    int slowSent = 0;
+    int fastSent = 0;
+    int gitSent = 0;
+    // One second at 50 Hz, arriving a little early or late
+    for (std::int64_t i = 0; i < 50; ++i)
+    {
+        std::int64_t now = i * kLoop + (i % 2 == 0 ? 300 : -300);
+        slowSent += limiter.Admit(slow, 8, now);
+        fastSent += limiter.Admit(fast, 8, now);
+        gitSent += limiter.Admit(git, 8, now);
+    }
+    // The slack can let one extra update in at the start
+    EXPECT_NEAR(slowSent, 10, 1);
+    EXPECT_EQ(fastSent, 50);
+    EXPECT_EQ(gitSent, 1);
+    EXPECT_EQ(limiter.GetStats().rateLimited,
+              static_cast<std::uint64_t>(50 - slowSent + 49));
+}
+
+TEST(LogBandwidthBudgetTest, WantsWhatTheRateWouldAdmit)
+{
+    LogKeyRegistry keys;
+    LogBandwidthLimiter limiter{keys, MakeBudget(0, "slow=10,git=once")};
+    LogKey slow = keys.Child(kRootLogKey, "slow");
+    LogKey fast = keys.Child(kRootLogKey, "fast");
+    LogKey git = keys.Child(kRootLogKey, "git/sha");
+
+    for (std::int64_t i = 0; i < 50; ++i)
+    {
+        std::int64_t now = i * kLoop + (i % 2 == 0 ? 300 : -300);
+        for (LogKey key : {slow, fast, git})
+        {
+            bool wanted = limiter.Wants(key, now);
+            EXPECT_EQ(wanted, limiter.Admit(key, 8, now)) << i;
+        }
+    }
+    EXPECT_FALSE(limiter.Wants(git, 50 * kLoop));
+
+    // A new budget looks every key's rate up again
+    limiter.SetBudget({});
+    EXPECT_TRUE(limiter.Wants(git, 50 * kLoop));
+    EXPECT_TRUE(limiter.Wants(slow, 50 * kLoop));
+}
+
+TEST(LogBandwidthBudgetTest, HighPriorityKeysGetTheBandwidthFirst)
+{
+    LogKeyRegistry keys;
+    // 100 bytes per loop, and each key wants 80
+    LogBandwidthLimiter limiter{keys,
+                                MakeBudget(5'000, "pose=max@0,extra=max@3")};
+    LogKey pose = keys.Child(kRootLogKey, "pose");
+    LogKey extra = keys.Child(kRootLogKey, "extra");
+
+    int poseSent = 0;
+    int extraSent = 0;
+    for (std::int64_t i = 1; i <= 50; ++i)
+    {
+        // The less important key asks first every loop
+        extraSent += limiter.Admit(extra, 80, i * kLoop);
+        poseSent += limiter.Admit(pose, 80, i * kLoop);
+    }
+    EXPECT_EQ(poseSent, 50);
+    EXPECT_LT(extraSent, 20);
+
+    auto stats = limiter.GetStats();
+    EXPECT_EQ(stats.sent, static_cast<std::uint64_t>(poseSent + extraSent));
+    EXPECT_EQ(stats.deferred, static_cast<std::uint64_t>(50 - extraSent));
+    // Stays within the budget plus the initial burst
+    EXPECT_LE(stats.bytes, 5'000 + 5'000 * LogBandwidthLimiter::kBurst);
+}
+
+TEST(LogBandwidthBudgetTest, ValuesBiggerThanTheBucketStillGetOut)
+{
+    LogKeyRegistry keys;
+    LogBandwidthLimiter limiter{keys, MakeBudget(1'000, "")};
+    LogKey big = keys.Child(kRootLogKey, "big");
+
+    int sent = 0;
+    for (std::int64_t i = 1; i <= 100; ++i)
+    {
+        sent += limiter.Admit(big, 500, i * kLoop);
+    }
+    // Two seconds at 1000 bytes per second
+    EXPECT_GE(sent, 3);
+    EXPECT_LE(sent, 5);
+}
+
+TEST(LogBandwidthBudgetTest, BudgetCanBeReplacedWhileRunning)
+{
+    LogKeyRegistry keys;
+    LogBandwidthLimiter limiter{keys};
+    LogKey key = keys.Child(kRootLogKey, "robot/drive/speed");
+
+    int sent = 0;
+    for (std::int64_t i = 1; i <= 50; ++i)
+    {
+        sent += limiter.Admit(key, 8, i * kLoop);
+    }
+    EXPECT_EQ(sent, 50);
+
+    // As when the FMS attaches partway through
+    limiter.SetBudget(MakeBudget(0, "robot/drive=10"));
+    sent = 0;
+    for (std::int64_t i = 51; i <= 100; ++i)
+    {
+        sent += limiter.Admit(key, 8, i * kLoop);
+    }
+    EXPECT_NEAR(sent, 10, 1);
+
+    EXPECT_THROW(limiter.SetBudget(MakeBudget(-1, "")),
+                 std::invalid_argument);
+}
+
+TEST(LogBandwidthBudgetTest, PriorityZeroIsNeverHeldBack)
+{
+    LogKeyRegistry keys;
+    // 20 bytes per loop, with an event of 100 every loop
+    LogBandwidthLimiter limiter{keys, MakeBudget(1'000, "event=max@0")};
+    LogKey event = keys.Child(kRootLogKey, "event");
+    LogKey other = keys.Child(kRootLogKey, "other");
+
+    int eventSent = 0;
+    int otherSent = 0;
+    for (std::int64_t i = 1; i <= 50; ++i)
+    {
+        eventSent += limiter.Admit(event, 100, i * kLoop);
+        otherSent += limiter.Admit(other, 8, i * kLoop);
+    }
+    EXPECT_EQ(eventSent, 50);
+    // The events' debt keeps everything else waiting
+    EXPECT_EQ(otherSent, 0);
+}
@@ -0,0 +1,241 @@
+#include <logging/LogBuffers.h>
+#include <logging/Logger.h>
+#include <logging/NTLogManager.h>
+#include <networktables/NetworkTable.h>
+#include <networktables/NetworkTableInstance.h>
+#include <units/length.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    constexpr int kWarmupCalls = 3;
+    constexpr int kMeasuredCalls = 100;
+
+    /** @brief Allocations made by `log(i)` over the measured calls */
+    template <typename Log>
+    std::size_t AllocationsOf(Log&& log)
+    {
+        for (int i = 0; i < kWarmupCalls; ++i)
+        {
+            log(i);
+        }
+        auto before = test::AllocationCount();
+        for (int i = 0; i < kMeasuredCalls; ++i)
+        {
+            log(i);
+        }
+        return test::AllocationCount() - before;
+    }
+
+    /**
+     * @brief Publishes arrays through an NTLogManager and straight to NT
+     *
+     * NT copies each value it is given, which allocates on its own. The
+     * manager must not add to that, so each test compares the two.
+     */
+    class NTArrays
+    {
+    public:
+        NTArrays() : manager(keys, "test/buffers/nt")
+        {
+        }
+
+        LogKey Key(std::string_view name)
+        {
+            return keys.Child(kRootLogKey, name);
+        }
+
+        std::shared_ptr<nt::NetworkTable> RawTable() const
+        {
+            return nt::NetworkTableInstance::GetDefault().GetTable(
+                "test/buffers/raw");
+        }
+
+        LogKeyRegistry keys;
+        NTLogManager manager;
+    };
+}  // namespace
+
+TEST(LogBuffersTest, IntegerArraysDoNotAllocateAfterWarmup)
+{
+    std::array<long, 8> values{1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<std::int64_t> buffer;
+
+    for (int i = 0; i < kWarmupCalls; ++i)
+    {
+        AsInt64(buffer, std::span<long>{values});
+    }
+    auto before = test::AllocationCount();
+    for (int i = 0; i < kMeasuredCalls; ++i)
+    {
+        auto converted = AsInt64(buffer, std::span<long>{values});
+        ASSERT_EQ(converted.size(), values.size());
+        EXPECT_EQ(converted[7], 8);
+    }
+    EXPECT_EQ(test::AllocationCount(), before);
+}
+
+TEST(LogBuffersTest, Int64CompatibleLongsAreNotCopied)
+{
+    if constexpr (std::is_same_v<long, std::int64_t>)
+    {
+        std::array<long, 4> values{1, 2, 3, 4};
+        std::vector<std::int64_t> buffer;
+        auto converted = AsInt64(buffer, std::span<long>{values});
+        EXPECT_EQ(converted.data(), values.data());
+        EXPECT_TRUE(buffer.empty());
+    }
+}
+
+TEST(LogBuffersTest, BooleanArraysDoNotAllocateAfterWarmup)
+{
+    std::array<bool, 4> values{true, false, true, true};
+    std::vector<int> buffer;
+
+    for (int i = 0; i < kWarmupCalls; ++i)
+    {
+        ConvertInto(buffer, std::span<bool>{values});
+    }
+    auto before = test::AllocationCount();
+    for (int i = 0; i < kMeasuredCalls; ++i)
+    {
+        auto converted = ConvertInto(buffer, std::span<bool>{values});
+        ASSERT_EQ(converted.size(), values.size());
+        EXPECT_EQ(converted[1], 0);
+    }
+    EXPECT_EQ(test::AllocationCount(), before);
+}
+
+TEST(LogBuffersTest, StringArraysDoNotAllocateAfterWarmup)
+{
+    // Long enough to defeat the small string optimization
+    std::string first(64, 'a');
+    std::string second(64, 'b');
+    std::array<std::string_view, 2> values{first, second};
+    std::vector<std::string> buffer;
+
+    for (int i = 0; i < kWarmupCalls; ++i)
+    {
+        ConvertInto(buffer, std::span<std::string_view>{values});
+    }
+    auto before = test::AllocationCount();
+    for (int i = 0; i < kMeasuredCalls; ++i)
+    {
+        // Alternate lengths: shrinking and regrowing must reuse capacity
+        std::array<std::string_view, 2> shorter{values[0].substr(0, 10),
+                                                values[1]};
+        auto converted = ConvertInto(
+            buffer, std::span<std::string_view>{i % 2 ? shorter : values});
+        ASSERT_EQ(converted.size(), 2u);
+        EXPECT_EQ(converted[1], second);
+    }
+    EXPECT_EQ(test::AllocationCount(), before);
+}
+
+TEST(LogBuffersTest, UnitArraysDoNotAllocateAfterWarmup)
+{
+    std::array<units::meter_t, 4> values{units::meter_t{1}, units::meter_t{2},
+                                         units::meter_t{3}, units::meter_t{4}};
+    auto context = logger["test"]["buffers"]["units"];
+
+    for (int i = 0; i < kWarmupCalls; ++i)
+    {
+        context << std::span<units::meter_t>{values};
+    }
+    auto before = test::AllocationCount();
+    for (int i = 0; i < kMeasuredCalls; ++i)
+    {
+        context << std::span<units::meter_t>{values};
+    }
+    EXPECT_EQ(test::AllocationCount(), before);
+}
+
+TEST(LogBuffersTest, NTIntegerArraysDoNotAllocateAfterWarmup)
+{
+    NTArrays nt;
+    // Alternate values so the change filter lets every call through
+    std::array<std::array<long, 8>, 2> values{
+        std::array<long, 8>{1, 2, 3, 4, 5, 6, 7, 8},
+        std::array<long, 8>{8, 7, 6, 5, 4, 3, 2, 1}};
+    std::array<std::vector<std::int64_t>, 2> converted{
+        std::vector<std::int64_t>(values[0].begin(), values[0].end()),
+        std::vector<std::int64_t>(values[1].begin(), values[1].end())};
+    auto key = nt.Key("ints");
+    auto raw = nt.RawTable()->GetIntegerArrayTopic("ints").Publish();
+
+    auto logged = AllocationsOf(
+        [&](int i)
+        {
+            nt.manager.Log(key, std::span<long>{values[i % 2]});
+        });
+    auto direct = AllocationsOf(
+        [&](int i)
+        {
+            raw.Set(std::span<const std::int64_t>{converted[i % 2]});
+        });
+    EXPECT_EQ(logged, direct);
+}
+
+TEST(LogBuffersTest, NTBooleanArraysDoNotAllocateAfterWarmup)
+{
+    NTArrays nt;
+    std::array<std::array<bool, 4>, 2> values{
+        std::array<bool, 4>{true, false, true, true},
+        std::array<bool, 4>{false, true, false, false}};
+    std::array<std::vector<int>, 2> converted{
+        std::vector<int>(values[0].begin(), values[0].end()),
+        std::vector<int>(values[1].begin(), values[1].end())};
+    auto key = nt.Key("bools");
+    auto raw = nt.RawTable()->GetBooleanArrayTopic("bools").Publish();
+
+    auto logged = AllocationsOf(
+        [&](int i)
+        {
+            nt.manager.Log(key, std::span<bool>{values[i % 2]});
+        });
+    auto direct = AllocationsOf(
+        [&](int i)
+        {
+            raw.Set(std::span<const int>{converted[i % 2]});
+        });
+    EXPECT_EQ(logged, direct);
+}
+
+TEST(LogBuffersTest, NTStringArraysDoNotAllocateAfterWarmup)
+{
+    NTArrays nt;
+    // Long enough to defeat the small string optimization
+    std::string first(64, 'a');
+    std::string second(64, 'b');
+    std::array<std::array<std::string_view, 2>, 2> values{
+        std::array<std::string_view, 2>{first, second},
+        std::array<std::string_view, 2>{second.substr(0, 10), first}};
+    std::array<std::vector<std::string>, 2> converted{
+        std::vector<std::string>(values[0].begin(), values[0].end()),
+        std::vector<std::string>(values[1].begin(), values[1].end())};
+    auto key = nt.Key("strings");
+    auto raw = nt.RawTable()->GetStringArrayTopic("strings").Publish();
+
+    auto logged = AllocationsOf(
+        [&](int i)
+        {
+            nt.manager.Log(key, std::span<std::string_view>{values[i % 2]});
+        });
+    auto direct = AllocationsOf(
+        [&](int i)
+        {
+            raw.Set(std::span<const std::string>{converted[i % 2]});
+        });
+    EXPECT_EQ(logged, direct);
+}
@@ -0,0 +1,115 @@
+#include <logging/LogLevel.h>
+#include <logging/Logger.h>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+// Tests that log at debug level need it compiled in
+#define SKIP_IF_DEBUG_COMPILED_OUT()                              \
+    if constexpr (kCompiledLogLevel > LogLevel::kDebug)           \
+    {                                                             \
+        GTEST_SKIP() << "Debug logging is compiled out";          \
+    }
+
+TEST(LogLevelTest, LongestMatchingPrefixWins)
+{
+    auto rules = LogLevelRules::Parse(
+        " robot=critical, robot/drive=debug ,robot/drive/sim=off");
+    ASSERT_TRUE(rules);
+
+    EXPECT_EQ(rules->Find("robot"), LogLevel::kCritical);
+    EXPECT_EQ(rules->Find("robot/Robot3d/Robot"), LogLevel::kCritical);
+    EXPECT_EQ(rules->Find("robot/drive/pose"), LogLevel::kDebug);
+    EXPECT_EQ(rules->Find("robot/drive/sim/period"), LogLevel::kOff);
+    // Whole segments only
+    EXPECT_EQ(rules->Find("robot/drivetrain"), LogLevel::kCritical);
+    EXPECT_FALSE(rules->Find("perf/loop"));
+}
+
+TEST(LogLevelTest, RejectsMalformedRules)
+{
+    EXPECT_FALSE(LogLevelRules::Parse("robot"));
+    EXPECT_FALSE(LogLevelRules::Parse("robot=loud"));
+    EXPECT_FALSE(LogLevelRules::Parse("=debug"));
+    ASSERT_TRUE(LogLevelRules::Parse(""));
+    EXPECT_TRUE(LogLevelRules::Parse("")->Empty());
+}
+
+TEST(LogLevelTest, ContextsBelowTheThresholdAreDisabled)
+{
+    SKIP_IF_DEBUG_COMPILED_OUT();
+    Logger logger;
+    EXPECT_TRUE(logger["a"].At(LogLevel::kDebug));
+
+    logger.SetLogLevel(LogLevel::kInfo);
+    EXPECT_TRUE(logger["a"]);
+    EXPECT_FALSE(logger["a"].At(LogLevel::kDebug));
+    // Children inherit their parent's level
+    EXPECT_FALSE(logger["a"].At(LogLevel::kDebug)["b"]);
+    EXPECT_TRUE(logger["a"].At(LogLevel::kCritical)["b"]);
+}
+
+TEST(LogLevelTest, RulesOverrideTheThresholdUnderAPrefix)
+{
+    SKIP_IF_DEBUG_COMPILED_OUT();
+    Logger logger;
+    logger.SetLogLevel(LogLevel::kInfo);
+    ASSERT_TRUE(logger.SetLogLevelRules("a/b=off,c=debug"));
+
+    EXPECT_TRUE(logger["a"]["c"]);
+    EXPECT_FALSE(logger["a"]["b"]["c"]);
+    EXPECT_FALSE(logger["a/b"].At(LogLevel::kCritical));
+    EXPECT_TRUE(logger["c"]["d"].At(LogLevel::kDebug));
+
+    EXPECT_FALSE(logger.SetLogLevelRules("a/b"));
+    EXPECT_FALSE(logger["a"]["b"]);  // Malformed rules change nothing
+
+    ASSERT_TRUE(logger.SetLogLevelRules(""));
+    EXPECT_TRUE(logger["a"]["b"]);
+}
+
+TEST(LogLevelTest, CheckedKeysFollowLaterRuleChanges)
+{
+    Logger logger;
+    ASSERT_TRUE(logger.SetLogLevelRules("a=off"));
+    // Resolve and cache each key's threshold under the first rules
+    EXPECT_FALSE(logger["a"]["b"]);
+    EXPECT_TRUE(logger["c"]);
+
+    ASSERT_TRUE(logger.SetLogLevelRules("a=info,c=off"));
+    EXPECT_TRUE(logger["a"]["b"]);
+    EXPECT_FALSE(logger["c"]);
+
+    // Keys no rule matches still follow the global threshold
+    ASSERT_TRUE(logger.SetLogLevelRules("c=off"));
+    EXPECT_TRUE(logger["a"]["b"]);
+    logger.SetLogLevel(LogLevel::kCritical);
+    EXPECT_FALSE(logger["a"]["b"]);
+    EXPECT_TRUE(logger["a"]["b"].At(LogLevel::kCritical));
+}
+
+TEST(LogLevelTest, DisabledStatementsDoNotEvaluateTheirArguments)
+{
+    SKIP_IF_DEBUG_COMPILED_OUT();
+    Logger logger;
+    int evaluated = 0;
+    auto expensive = [&]
+    {
+        ++evaluated;
+        return 1.0;
+    };
+
+    NFR_LOG_DEBUG(logger["a"]) << expensive();
+    EXPECT_EQ(evaluated, 1);
+
+    logger.SetLogLevel(LogLevel::kInfo);
+    NFR_LOG_DEBUG(logger["a"]) << expensive();
+    NFR_LOG_DEBUG(logger["a"]) << [&](const LogContext& log)
+    { log["b"] << expensive(); };
+    EXPECT_EQ(evaluated, 1);
+
+    NFR_LOG_INFO(logger["a"]) << [&](const LogContext& log)
+    { log["b"] << expensive(); };
+    EXPECT_EQ(evaluated, 2);
+}
@@ -0,0 +1,64 @@
+#include <logging/LogRecord.h>
+#include <logging/LogRingBuffer.h>
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    using LongArrayCodec = LogRecordCodec<std::span<long>>;
+
+    /** @brief Replay function that collects decoded long arrays */
+    void CollectLongs(void* target, LogKey, std::span<std::byte> payload)
+    {
+        auto* arrays = static_cast<std::vector<std::vector<long>>*>(target);
+        LongArrayCodec::Decode(payload, [&](std::span<long> values)
+                               { arrays->emplace_back(values.begin(),
+                                                      values.end()); });
+    }
+
+    void PushLongs(LogRingBuffer& ring, std::span<long> values)
+    {
+        auto payload =
+            ring.TryReserve(1, &CollectLongs, LongArrayCodec::Size(values));
+        ASSERT_NE(payload.data(), nullptr);
+        LongArrayCodec::Encode(values, payload);
+    }
+}  // namespace
+
+TEST(LogRingBufferTest, PayloadsExcludeAlignmentPadding)
+{
+    LogRingBuffer ring{4096};
+    std::array<long, 3> values{1, 2, 3};
+    std::vector<std::vector<long>> drained;
+
+    PushLongs(ring, values);
+    ring.Commit();
+    ASSERT_EQ(ring.Drain(&drained), 1u);
+    ASSERT_EQ(drained.size(), 1u);
+    EXPECT_EQ(drained[0], std::vector<long>(values.begin(), values.end()));
+}
+
+TEST(LogRingBufferTest, RecordsSurviveWrapAround)
+{
+    LogRingBuffer ring{4096};
+    std::array<long, 5> values{1, 2, 3, 4, 5};
+    std::vector<std::vector<long>> drained;
+
+    // Odd-sized records make the padding at the end of the buffer vary
+    for (long i = 0; i < 500; ++i)
+    {
+        values[0] = i;
+        PushLongs(ring, std::span<long>{values}.first(1 + i % 5));
+        ring.Commit();
+        ASSERT_EQ(ring.Drain(&drained), 1u);
+        ASSERT_EQ(drained.back().size(), static_cast<size_t>(1 + i % 5));
+        EXPECT_EQ(drained.back()[0], i);
+    }
+}
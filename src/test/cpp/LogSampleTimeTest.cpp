@@ -0,0 +1,99 @@
+#include <logging/Logger.h>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    /** @brief Remembers the timestamp of every double it is given */
+    struct TimestampSink
+    {
+        inline static std::vector<std::int64_t> timestamps;
+
+        explicit TimestampSink(const LogKeyRegistry&) {}
+
+        void Log(LogKey, double, std::int64_t timestamp)
+        {
+            timestamps.push_back(timestamp);
+        }
+        void Log(LogKey, long, std::int64_t) {}
+        void Log(LogKey, bool, std::int64_t) {}
+        void Log(LogKey, std::string_view, std::int64_t) {}
+        void Log(LogKey, std::span<double>, std::int64_t) {}
+        void Log(LogKey, std::span<long>, std::int64_t) {}
+        void Log(LogKey, std::span<bool>, std::int64_t) {}
+        void Log(LogKey, std::span<std::string_view>, std::int64_t) {}
+    };
+
+    using TestLogger = BasicLogger<TimestampSink>;
+
+    /** @brief Logs one value inside a sample and one after it */
+    void LogAroundSample(TestLogger& logger)
+    {
+        LogKey key = logger.GetKeys().Child(kRootLogKey, "x");
+        logger.BeginFrame();
+        logger.BeginSample(1'234);
+        logger.Log(key, 1.0);
+        logger.EndSample();
+        logger.Log(key, 2.0);
+        logger.EndFrame();
+    }
+}  // namespace
+
+TEST(LogSampleTimeTest, SamplesKeepTheirCaptureTime)
+{
+    TimestampSink::timestamps.clear();
+    TestLogger logger;
+    logger.EnableSink<TimestampSink>();
+    LogAroundSample(logger);
+
+    ASSERT_EQ(TimestampSink::timestamps.size(), 2u);
+    EXPECT_EQ(TimestampSink::timestamps[0], 1'234);
+    EXPECT_GT(TimestampSink::timestamps[1], 1'234);
+}
+
+TEST(LogSampleTimeTest, SamplesKeepTheirCaptureTimeWhenAsync)
+{
+    TimestampSink::timestamps.clear();
+    TestLogger logger;
+    logger.EnableSink<TimestampSink>();
+    logger.EnableAsyncLogging(1 << 16);
+    LogAroundSample(logger);
+    logger.DisableAsyncLogging();
+
+    ASSERT_EQ(TimestampSink::timestamps.size(), 2u);
+    EXPECT_EQ(TimestampSink::timestamps[0], 1'234);
+    EXPECT_GT(TimestampSink::timestamps[1], 1'234);
+}
+
+TEST(LogSampleTimeTest, EverySampleReachesADecimatingWPILog)
+{
+    Logger logger;
+    logger.EnableWPILogging(5);
+    auto* wpilog = logger.GetSink<WPILogManager>();
+    auto samples = logger["odometry"]["pose"];
+    logger.KeepEvery(samples.GetKey());
+
+    // A cycle's worth of 200 Hz samples, each logged once
+    int written = 0;
+    logger.BeginFrame();
+    for (int i = 0; i < 20; ++i)
+    {
+        logger.BeginSample(1'000 + 5'000 * i);
+        EXPECT_TRUE(wpilog->Wants(samples.GetKey()));
+        samples << [&]
+        {
+            ++written;
+            return static_cast<double>(i);
+        };
+        logger.EndSample();
+    }
+    logger.EndFrame();
+    EXPECT_EQ(written, 20);
+}
@@ -0,0 +1,96 @@
+#include <logging/LogRecord.h>
+#include <logging/LogStaging.h>
+
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    constexpr int kThreads = 4;
+    constexpr long kValuesPerThread = 5000;
+
+    /** @brief Per-key sums, so every value must arrive exactly once */
+    struct Totals
+    {
+        std::vector<long> sums = std::vector<long>(kThreads, 0);
+        std::vector<long> counts = std::vector<long>(kThreads, 0);
+    };
+
+    void Collect(void* target, LogKey key, std::span<std::byte> payload)
+    {
+        auto* totals = static_cast<Totals*>(target);
+        LogRecordCodec<long>::Decode(payload,
+                                     [&](long value)
+                                     {
+                                         totals->sums[key] += value;
+                                         ++totals->counts[key];
+                                     });
+    }
+}  // namespace
+
+TEST(LogStagingTest, DrainsEveryThreadsValues)
+{
+    LogStaging staging{1 << 20};
+    Totals totals;
+    std::atomic<int> finished{0};
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; ++thread)
+    {
+        threads.emplace_back(
+            [&, thread]
+            {
+                for (long i = 1; i <= kValuesPerThread; ++i)
+                {
+                    ASSERT_TRUE(
+                        staging.Push(static_cast<LogKey>(thread), &Collect, i));
+                }
+                finished.fetch_add(1);
+            });
+    }
+
+    // Drain while the producers are still running, like the writer thread
+    while (finished.load() < kThreads)
+    {
+        staging.Drain(&totals);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    staging.Drain(&totals);
+
+    for (int thread = 0; thread < kThreads; ++thread)
+    {
+        EXPECT_EQ(totals.counts[thread], kValuesPerThread);
+        EXPECT_EQ(totals.sums[thread],
+                  kValuesPerThread * (kValuesPerThread + 1) / 2);
+    }
+    auto stats = staging.GetStats();
+    EXPECT_EQ(stats.threads, static_cast<std::size_t>(kThreads));
+    EXPECT_EQ(stats.queued, static_cast<std::uint64_t>(kThreads) *
+                                kValuesPerThread);
+    EXPECT_EQ(stats.dropped, 0u);
+}
+
+TEST(LogStagingTest, DropsWhenAThreadsBufferIsFull)
+{
+    LogStaging staging{4096};
+    Totals totals;
+    long pushed = 0;
+    while (staging.Push(0, &Collect, 1L))
+    {
+        ++pushed;
+    }
+
+    EXPECT_EQ(staging.GetStats().dropped, 1u);
+    EXPECT_EQ(staging.Drain(&totals), static_cast<std::size_t>(pushed));
+    EXPECT_TRUE(staging.Push(0, &Collect, 1L));
+}
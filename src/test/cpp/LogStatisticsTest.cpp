@@ -0,0 +1,154 @@
+#include <logging/LogKeyRegistry.h>
+#include <logging/LogStatistics.h>
+#include <logging/Logger.h>
+
+#include <chrono>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    constexpr std::int64_t kSecond = 1'000'000;
+
+    /** @brief Counts the doubles it is given by key path */
+    template <bool SummariesOnly>
+    struct CountingSink
+    {
+        static constexpr bool kSummariesOnly = SummariesOnly;
+        inline static std::map<std::string, int> counts;
+
+        explicit CountingSink(const LogKeyRegistry& keys) : keys(keys)
+        {
+            counts.clear();
+        }
+
+        void Log(LogKey key, double, std::int64_t)
+        {
+            ++counts[std::string{keys.Path(key)}];
+        }
+        void Log(LogKey, long, std::int64_t) {}
+        void Log(LogKey, bool, std::int64_t) {}
+        void Log(LogKey, std::string_view, std::int64_t) {}
+        void Log(LogKey, std::span<double>, std::int64_t) {}
+        void Log(LogKey, std::span<long>, std::int64_t) {}
+        void Log(LogKey, std::span<bool>, std::int64_t) {}
+        void Log(LogKey, std::span<std::string_view>, std::int64_t) {}
+
+        const LogKeyRegistry& keys;
+    };
+
+    using SummarySink = CountingSink<true>;
+    using EverythingSink = CountingSink<false>;
+}  // namespace
+
+TEST(LogStatisticsTest, SummarizesAWindow)
+{
+    LogKeyRegistry keys;
+    LogStatistics stats{keys, "robot/drive/speed"};
+    LogKey speed = keys.Child(kRootLogKey, "robot/drive/speed");
+    std::vector<LogSummary> summaries;
+    EXPECT_FALSE(stats.Collect(kSecond, summaries));
+
+    for (long i = 1; i <= 100; ++i)
+    {
+        stats.Log(speed, i);
+    }
+    EXPECT_FALSE(stats.Collect(kSecond + kSecond / 2, summaries));
+    ASSERT_TRUE(stats.Collect(2 * kSecond, summaries));
+    ASSERT_EQ(summaries.size(), 1u);
+
+    const auto& summary = summaries[0];
+    EXPECT_EQ(summary.key, speed);
+    EXPECT_EQ(summary.count, 100u);
+    EXPECT_DOUBLE_EQ(summary.min, 1);
+    EXPECT_DOUBLE_EQ(summary.max, 100);
+    EXPECT_DOUBLE_EQ(summary.mean, 50.5);
+    EXPECT_NEAR(summary.stddev, 29.011, 1e-3);
+    EXPECT_DOUBLE_EQ(summary.p50, 50);
+    EXPECT_DOUBLE_EQ(summary.p90, 90);
+    EXPECT_DOUBLE_EQ(summary.p99, 99);
+
+    // The next window starts empty
+    ASSERT_TRUE(stats.Collect(3 * kSecond, summaries));
+    EXPECT_TRUE(summaries.empty());
+}
+
+TEST(LogStatisticsTest, OnlySummarizesKeysUnderItsPrefixes)
+{
+    LogKeyRegistry keys;
+    LogStatistics stats{keys, " perf/ ,robot/drive/speed"};
+    LogKey loop = keys.Child(kRootLogKey, "perf/loop");
+    LogKey speeds = keys.Child(kRootLogKey, "robot/drive/speeds");
+    LogKey summary = keys.Child(kRootLogKey, "stats/perf/loop/mean");
+
+    EXPECT_TRUE(stats.Wants(loop));
+    EXPECT_FALSE(stats.Wants(speeds));
+    EXPECT_FALSE(stats.Wants(summary));
+
+    std::vector<LogSummary> summaries;
+    stats.Collect(kSecond, summaries);
+    stats.Log(loop, 1.0);
+    stats.Log(speeds, 1.0);
+    stats.Log(summary, 1.0);
+    ASSERT_TRUE(stats.Collect(2 * kSecond, summaries));
+    ASSERT_EQ(summaries.size(), 1u);
+    EXPECT_EQ(summaries[0].key, loop);
+}
+
+TEST(LogStatisticsTest, SamplesPercentilesOfLongWindows)
+{
+    LogKeyRegistry keys;
+    LogStatistics stats{keys, "x", std::chrono::seconds{1}, 256};
+    LogKey x = keys.Child(kRootLogKey, "x");
+    std::vector<LogSummary> summaries;
+    stats.Collect(kSecond, summaries);
+
+    for (int i = 0; i < 10'000; ++i)
+    {
+        stats.Log(x, static_cast<double>(i));
+    }
+    ASSERT_TRUE(stats.Collect(2 * kSecond, summaries));
+    ASSERT_EQ(summaries.size(), 1u);
+
+    // Everything but the percentiles is still exact
+    EXPECT_EQ(summaries[0].count, 10'000u);
+    EXPECT_DOUBLE_EQ(summaries[0].max, 9'999);
+    EXPECT_DOUBLE_EQ(summaries[0].mean, 4'999.5);
+    EXPECT_NEAR(summaries[0].p50, 5'000, 1'000);
+    EXPECT_NEAR(summaries[0].p90, 9'000, 500);
+}
+
+TEST(LogStatisticsTest, SummariesOnlySinksDoNotGetSummarizedValues)
+{
+    BasicLogger<LogStatistics, SummarySink, EverythingSink> logger;
+    logger.EnableStatistics("speed", std::chrono::milliseconds{1});
+    logger.EnableSink<SummarySink>();
+    logger.EnableSink<EverythingSink>();
+    LogKey speed = logger.GetKeys().Child(kRootLogKey, "speed");
+    LogKey other = logger.GetKeys().Child(kRootLogKey, "other");
+
+    for (int i = 0; i < 10; ++i)
+    {
+        logger.Log(speed, 1.0);
+        logger.Log(other, 1.0);
+    }
+    EXPECT_EQ(SummarySink::counts["speed"], 0);
+    EXPECT_EQ(SummarySink::counts["other"], 10);
+    EXPECT_EQ(EverythingSink::counts["speed"], 10);
+
+    // Both get the summaries
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    logger.Flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    logger.Flush();
+    EXPECT_EQ(SummarySink::counts["stats/speed/mean"], 1);
+    EXPECT_EQ(EverythingSink::counts["stats/speed/mean"], 1);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file LoggerBenchmark.cpp
+ * @brief Throughput and allocation benchmarks for the logger front end and
+ *        sinks
+ *
+ * Every LogContext::operator<< overload is timed against three loggers: one
+ * with no sink enabled (the cost of the front end alone), one writing to
+ * WPILog and one publishing to NetworkTables. Each case reports ns/op and
+ * allocations/op and fails if it allocates more than its budget or is
+ * slower than its time budget, so a change that makes logging much slower
+ * shows up as a test failure instead of a slow loop.
+ *
+ * ```bash
+ * ./gradlew test                                   # Runs with all tests
+ * frcUserProgramTest --gtest_filter='LoggerBenchmark*'
+ * NFR_BENCHMARK_SCALE=1 frcUserProgramTest ...     # Budgets as written
+ * NFR_BENCHMARK_SCALE=0 frcUserProgramTest ...     # Only report times
+ * ```
+ *
+ * The time budgets are for a debug desktop build and are loose on purpose:
+ * they catch order-of-magnitude regressions, not noise (see
+ * test::TimeScale()).
+ */
+
+#include <frc/geometry/Pose2d.h>
+#include <logging/Logger.h>
+#include <units/length.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    constexpr int kWarmupOps = 100;
+    constexpr int kOpsPerBatch = 2000;
+    constexpr int kBatches = 5;
+
+    /** @brief Most a single case may cost before the benchmark fails */
+    struct Budget
+    {
+        double nsPerOp;
+        double allocationsPerOp;
+    };
+
+    // No sink: every steady-state write must be allocation free
+    constexpr Budget kNoSinkBudget{1'000, 0};
+    // DataLog appends into preallocated buffers; a new buffer is only
+    // allocated now and then, so allow a small average
+    constexpr Budget kWPILogBudget{10'000, 0.1};
+    // NT copies strings and arrays (element by element for string arrays)
+    // into values of its own
+    constexpr Budget kNTBudget{20'000, 8};
+
+    struct Result
+    {
+        double nsPerOp;
+        double allocationsPerOp;
+    };
+
+    /**
+     * @brief Times an operation by its fastest batch, and counts
+     *        allocations by the batch that made the most
+     */
+    template <typename F>
+    Result Measure(F&& op)
+    {
+        for (int i = 0; i < kWarmupOps; ++i)
+        {
+            op(i);
+        }
+
+        Result result{0, 0};
+        auto fastest = test::Fastest(
+            kBatches,
+            [&]
+            {
+                auto allocations = test::AllocationCount();
+                for (int i = 0; i < kOpsPerBatch; ++i)
+                {
+                    op(i);
+                }
+                double allocationsPerOp =
+                    static_cast<double>(test::AllocationCount() -
+                                        allocations) /
+                    kOpsPerBatch;
+                result.allocationsPerOp =
+                    std::max(result.allocationsPerOp, allocationsPerOp);
+            });
+        result.nsPerOp =
+            std::chrono::duration<double, std::nano>(fastest).count() /
+            kOpsPerBatch;
+        return result;
+    }
+
+    /** @brief Runs one case, prints its numbers and checks its budget */
+    template <typename F>
+    void Run(std::string_view sink, std::string_view name,
+             const Budget& budget, F&& op)
+    {
+        Result result = Measure(op);
+        std::printf("[ BENCH    ] %-8s %-28s %10.1f ns/op %8.3f allocs/op\n",
+                    std::string{sink}.c_str(), std::string{name}.c_str(),
+                    result.nsPerOp, result.allocationsPerOp);
+
+        if (double scale = test::TimeScale(); scale > 0)
+        {
+            EXPECT_LE(result.nsPerOp, budget.nsPerOp * scale)
+                << sink << " " << name << " is slower than its budget";
+        }
+        EXPECT_LE(result.allocationsPerOp, budget.allocationsPerOp)
+            << sink << " " << name << " allocates more than its budget";
+    }
+
+    frc::Pose2d PoseAt(int i)
+    {
+        return frc::Pose2d{units::meter_t{double(i)}, units::meter_t{0}, {}};
+    }
+
+    /**
+     * @brief Times every operator<< overload and key depth on a logger
+     *
+     * Values change on every call so change filters can't skip the writes.
+     */
+    void RunAllCases(Logger& logger, std::string_view sink,
+                     const Budget& budget)
+    {
+        auto root = logger["bench"];
+
+        Run(sink, "double", budget,
+            [&](int i) { root["double"] << static_cast<double>(i); });
+        Run(sink, "int", budget, [&](int i) { root["int"] << i; });
+        Run(sink, "long", budget,
+            [&](int i) { root["long"] << static_cast<long>(i); });
+        Run(sink, "bool", budget,
+            [&](int i) { root["bool"] << (i % 2 == 0); });
+
+        std::array<std::string, 2> strings{"state_a", "state_b"};
+        Run(sink, "string_view", budget, [&](int i)
+            { root["string"] << std::string_view{strings[i % 2]}; });
+
+        std::array<double, 8> doubles{};
+        Run(sink, "span<double>[8]", budget,
+            [&](int i)
+            {
+                doubles[0] = i;
+                root["doubles"] << std::span<double>{doubles};
+            });
+
+        std::array<long, 8> longs{};
+        Run(sink, "span<long>[8]", budget,
+            [&](int i)
+            {
+                longs[0] = i;
+                root["longs"] << std::span<long>{longs};
+            });
+
+        std::array<bool, 8> bools{};
+        Run(sink, "span<bool>[8]", budget,
+            [&](int i)
+            {
+                bools[0] = i % 2 == 0;
+                root["bools"] << std::span<bool>{bools};
+            });
+
+        std::array<std::string_view, 4> views{"a", "b", "c", "d"};
+        Run(sink, "span<string_view>[4]", budget,
+            [&](int i)
+            {
+                views[0] = strings[i % 2];
+                root["strings"] << std::span<std::string_view>{views};
+            });
+
+        Run(sink, "struct", budget,
+            [&](int i)
+            { root["pose"] << PoseAt(i); });
+
+        std::array<frc::Pose2d, 4> poses{};
+        Run(sink, "struct array[4]", budget,
+            [&](int i)
+            {
+                poses[0] = PoseAt(i);
+                root["poses"] << std::span<frc::Pose2d>{poses};
+            });
+
+        Run(sink, "unit", budget,
+            [&](int i) { root["meters"] << units::meter_t{double(i)}; });
+
+        std::array<units::meter_t, 4> distances{};
+        Run(sink, "span<unit>[4]", budget,
+            [&](int i)
+            {
+                distances[0] = units::meter_t{double(i)};
+                root["distances"] << std::span<units::meter_t>{distances};
+            });
+
+        // Resolving a key costs one child lookup per level
+        Run(sink, "depth 1", budget,
+            [&](int i) { logger["depth1"] << static_cast<double>(i); });
+        Run(sink, "depth 4", budget,
+            [&](int i)
+            { logger["depth4"]["b"]["c"]["d"] << static_cast<double>(i); });
+        Run(sink, "depth 8", budget,
+            [&](int i)
+            {
+                logger["depth8"]["b"]["c"]["d"]["e"]["f"]["g"]["h"]
+                    << static_cast<double>(i);
+            });
+        Run(sink, "depth 4 as one path", budget,
+            [&](int i) { logger["path4/b/c/d"] << static_cast<double>(i); });
+    }
+}  // namespace
+
+TEST(LoggerBenchmark, NoSink)
+{
+    Logger logger;
+    RunAllCases(logger, "none", kNoSinkBudget);
+}
+
+TEST(LoggerBenchmark, WPILog)
+{
+    Logger logger;
+    logger.EnableWPILogging();
+    RunAllCases(logger, "wpilog", kWPILogBudget);
+}
+
+TEST(LoggerBenchmark, NetworkTables)
+{
+    Logger logger;
+    LogChangeFilter filter;
+    filter.enabled = false;  // Measure the full publish path
+    logger.EnableNTLogging("benchmark", std::move(filter));
+    RunAllCases(logger, "nt", kNTBudget);
+}
@@ -0,0 +1,327 @@
+#include <pathfinding/NavGrid.h>
+#include <pathfinding/Pathfinder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "gtest/gtest.h"
+
+using namespace nfr;
+using namespace units::literals;
+
+namespace
+{
+    /**
+     * @brief A field-sized grid (17.7 × 8.1 m at 0.3 m cells) with walls
+     *        and two large obstacles in the middle, like the navgrid
+     */
+    NavGrid FieldGrid()
+    {
+        NavGrid grid{59, 27, 0.3_m};
+        for (int x = 0; x < grid.Width(); ++x)
+        {
+            grid.SetBlocked({x, 0});
+            grid.SetBlocked({x, grid.Height() - 1});
+        }
+        for (int y = 0; y < grid.Height(); ++y)
+        {
+            grid.SetBlocked({0, y});
+            grid.SetBlocked({grid.Width() - 1, y});
+        }
+        for (int y = 9; y < 18; ++y)
+        {
+            for (int x = 13; x < 20; ++x)
+            {
+                grid.SetBlocked({x, y});
+                grid.SetBlocked({grid.Width() - 1 - x, y});
+            }
+        }
+        return grid;
+    }
+
+    /** @brief Every point along a path is in a free cell */
+    void ExpectClear(const NavGrid& grid,
+                     const std::vector<frc::Translation2d>& points)
+    {
+        for (const auto& point : points)
+        {
+            EXPECT_FALSE(grid.IsBlocked(grid.CellAt(point)))
+                << point.X().value() << ", " << point.Y().value();
+        }
+    }
+
+    std::vector<frc::Translation2d> Points(const CachedTrajectory& trajectory)
+    {
+        std::vector<frc::Translation2d> points;
+        for (std::size_t i = 0; i < trajectory.Size(); ++i)
+        {
+            points.emplace_back(trajectory[i].x, trajectory[i].y);
+        }
+        return points;
+    }
+
+    double PathLength(const std::vector<frc::Translation2d>& waypoints)
+    {
+        double length = 0;
+        for (std::size_t i = 1; i < waypoints.size(); ++i)
+        {
+            length += waypoints[i].Distance(waypoints[i - 1]).value();
+        }
+        return length;
+    }
+}  // namespace
+
+TEST(PathfinderTest, PacksCellsIntoWords)
+{
+    // Wide enough that rows span three words
+    NavGrid grid{130, 3, 0.1_m};
+    grid.SetBlocked({63, 1});
+    grid.SetBlocked({64, 1});
+    grid.SetBlocked({129, 2});
+    EXPECT_TRUE(grid.IsBlocked({63, 1}));
+    EXPECT_TRUE(grid.IsBlocked({64, 1}));
+    EXPECT_TRUE(grid.IsBlocked({129, 2}));
+    EXPECT_FALSE(grid.IsBlocked({65, 1}));
+    EXPECT_FALSE(grid.IsBlocked({63, 0}));
+    EXPECT_EQ(grid.BlockedCount(), 3);
+
+    grid.SetBlocked({64, 1}, false);
+    EXPECT_FALSE(grid.IsBlocked({64, 1}));
+    // Off the field counts as blocked
+    EXPECT_TRUE(grid.IsBlocked({-1, 0}));
+    EXPECT_TRUE(grid.IsBlocked({130, 0}));
+
+    EXPECT_EQ(grid.CellAt({0.35_m, 0.05_m}), (GridCell{3, 0}));
+    EXPECT_EQ(grid.CellAt({-1_m, 50_m}), (GridCell{0, 2}));
+    EXPECT_NEAR(grid.CenterOf({3, 0}).X().value(), 0.35, 1e-9);
+}
+
+TEST(PathfinderTest, InflatesObstaclesByTheClearance)
+{
+    NavGrid grid{130, 9, 0.1_m};
+    grid.SetBlocked({10, 4});
+    // Either side of a word boundary, and against the end of the row
+    grid.SetBlocked({64, 4});
+    grid.SetBlocked({129, 4});
+    auto inflated = grid.Inflated(0.2_m);
+
+    // Cells whose centers are within 2 cells: 13 around each obstacle,
+    // minus the 4 that would be past the end of the row
+    EXPECT_EQ(inflated.BlockedCount(), 13 + 13 + 13 - 4);
+    EXPECT_TRUE(inflated.IsBlocked({12, 4}));
+    EXPECT_TRUE(inflated.IsBlocked({11, 5}));
+    EXPECT_FALSE(inflated.IsBlocked({12, 5}));
+    EXPECT_FALSE(inflated.IsBlocked({13, 4}));
+    EXPECT_TRUE(inflated.IsBlocked({62, 4}));
+    EXPECT_TRUE(inflated.IsBlocked({66, 4}));
+    EXPECT_TRUE(inflated.IsBlocked({64, 6}));
+    EXPECT_FALSE(inflated.IsBlocked({64, 7}));
+    EXPECT_TRUE(inflated.IsBlocked({127, 4}));
+    // The original is untouched
+    EXPECT_EQ(grid.BlockedCount(), 3);
+}
+
+TEST(PathfinderTest, ChecksLineOfSight)
+{
+    NavGrid grid{10, 10, 0.3_m};
+    grid.SetBlocked({5, 5});
+    EXPECT_TRUE(grid.HasLineOfSight({0, 0}, {9, 2}));
+    EXPECT_FALSE(grid.HasLineOfSight({0, 5}, {9, 5}));
+    EXPECT_FALSE(grid.HasLineOfSight({0, 0}, {9, 9}));
+    EXPECT_TRUE(grid.HasLineOfSight({0, 2}, {7, 9}));
+    // Touching the obstacle's corner is too close
+    EXPECT_FALSE(grid.HasLineOfSight({0, 1}, {8, 9}));
+
+    // Squeezing diagonally between two obstacles that touch at a corner
+    grid.SetBlocked({2, 3});
+    grid.SetBlocked({3, 2});
+    EXPECT_FALSE(grid.HasLineOfSight({2, 2}, {3, 3}));
+    EXPECT_FALSE(grid.HasLineOfSight({0, 0}, {4, 4}));
+}
+
+TEST(PathfinderTest, GoesStraightAcrossOpenField)
+{
+    NavGrid grid{20, 20, 0.3_m};
+    Pathfinder pathfinder{grid};
+    std::vector<frc::Translation2d> waypoints;
+    ASSERT_TRUE(
+        pathfinder.FindPath({0.5_m, 0.4_m}, {5.1_m, 2.3_m}, waypoints));
+
+    // Any angle: no turns at all, where A* would zig-zag
+    ASSERT_EQ(waypoints.size(), 2u);
+    EXPECT_DOUBLE_EQ(waypoints.front().X().value(), 0.5);
+    EXPECT_DOUBLE_EQ(waypoints.back().Y().value(), 2.3);
+}
+
+TEST(PathfinderTest, FindsShortPathsAroundObstacles)
+{
+    auto field = FieldGrid();
+    auto grid = field.Inflated(0.3_m);
+    Pathfinder pathfinder{grid};
+    std::vector<frc::Translation2d> waypoints;
+
+    // From one end of the field to the other, past both obstacles
+    frc::Translation2d start{1_m, 4_m};
+    frc::Translation2d goal{16.5_m, 4.2_m};
+    ASSERT_TRUE(pathfinder.FindPath(start, goal, waypoints));
+    ASSERT_GE(waypoints.size(), 3u);
+    EXPECT_LE(waypoints.size(), 8u);
+    for (std::size_t i = 1; i < waypoints.size(); ++i)
+    {
+        EXPECT_TRUE(grid.HasLineOfSight(grid.CellAt(waypoints[i - 1]),
+                                        grid.CellAt(waypoints[i])));
+    }
+    // Not much longer than going straight through
+    double straight = goal.Distance(start).value();
+    EXPECT_GT(PathLength(waypoints), straight);
+    EXPECT_LT(PathLength(waypoints), straight * 1.15);
+
+    // The robot's center never gets within the clearance of an obstacle,
+    // even where the corners are rounded off
+    auto trajectory =
+        ToTrajectory(grid, waypoints, 0_deg, 90_deg, PathConstraints{});
+    ExpectClear(grid, Points(trajectory));
+}
+
+TEST(PathfinderTest, RoundsCornersOnlyAsFarAsTheyStayClear)
+{
+    // A turn around an obstacle's corner: both sides are clear, but
+    // rounding it off 1.5 m out cuts across the obstacle
+    NavGrid grid{25, 25, 0.3_m};
+    grid.SetBlocked({10, 10});
+    std::vector<frc::Translation2d> waypoints{
+        {6.45_m, 2.85_m}, {2.85_m, 2.85_m}, {3.15_m, 5.85_m}};
+    for (std::size_t i = 1; i < waypoints.size(); ++i)
+    {
+        ASSERT_TRUE(grid.HasLineOfSight(grid.CellAt(waypoints[i - 1]),
+                                        grid.CellAt(waypoints[i])));
+    }
+
+    PathConstraints constraints;
+    constraints.cornerRadius = 1.5_m;
+    auto points =
+        Points(ToTrajectory(grid, waypoints, 0_deg, 0_deg, constraints));
+    for (std::size_t i = 1; i < points.size(); ++i)
+    {
+        EXPECT_TRUE(grid.HasLineOfSight(grid.CellAt(points[i - 1]),
+                                        grid.CellAt(points[i])))
+            << points[i].X().value() << ", " << points[i].Y().value();
+    }
+    // Still rounded, just more tightly: no point is the corner itself
+    for (const auto& point : points)
+    {
+        EXPECT_GT(point.Distance(waypoints[1]).value(), 0.01);
+    }
+}
+
+TEST(PathfinderTest, HandlesBlockedAndUnreachableEnds)
+{
+    auto grid = FieldGrid();
+    Pathfinder pathfinder{grid};
+    std::vector<frc::Translation2d> waypoints;
+
+    // Pushed against the wall: starts from the nearest free cell
+    ASSERT_TRUE(pathfinder.FindPath({0.1_m, 4_m}, {3_m, 4_m}, waypoints));
+    ASSERT_EQ(waypoints.size(), 3u);
+    EXPECT_DOUBLE_EQ(waypoints[0].X().value(), 0.1);
+    EXPECT_FALSE(grid.IsBlocked(grid.CellAt(waypoints[1])));
+
+    // A goal deep inside an obstacle has no free cell nearby
+    NavGrid solid{20, 20, 0.3_m};
+    for (int y = 0; y < 20; ++y)
+    {
+        for (int x = 0; x < 20; ++x)
+        {
+            solid.SetBlocked({x, y}, x > 1 || y > 1);
+        }
+    }
+    Pathfinder boxedIn{solid};
+    EXPECT_FALSE(boxedIn.FindPath({0.3_m, 0.3_m}, {5_m, 5_m}, waypoints));
+    EXPECT_TRUE(waypoints.empty());
+
+    // Walled off
+    for (int y = 0; y < grid.Height(); ++y)
+    {
+        grid.SetBlocked({30, y});
+    }
+    EXPECT_FALSE(pathfinder.FindPath({1_m, 4_m}, {16_m, 4_m}, waypoints));
+    EXPECT_TRUE(waypoints.empty());
+}
+
+TEST(PathfinderTest, TrajectoryRespectsConstraints)
+{
+    std::vector<frc::Translation2d> waypoints{
+        {1_m, 1_m}, {5_m, 1_m}, {5_m, 4_m}, {8_m, 4_m}};
+    PathConstraints constraints;
+    constraints.maxVelocity = 2_mps;
+    constraints.maxAcceleration = 4_mps_sq;
+    NavGrid open{30, 20, 0.3_m};
+    auto trajectory =
+        ToTrajectory(open, waypoints, 0_deg, 180_deg, constraints);
+    ASSERT_GT(trajectory.Size(), 100u);
+
+    auto first = trajectory[0];
+    auto last = trajectory[trajectory.Size() - 1];
+    EXPECT_DOUBLE_EQ(first.x.value(), 1);
+    EXPECT_DOUBLE_EQ(last.x.value(), 8);
+    EXPECT_DOUBLE_EQ(last.y.value(), 4);
+    EXPECT_DOUBLE_EQ(first.vx.value(), 0);
+    EXPECT_DOUBLE_EQ(last.vx.value(), 0);
+    EXPECT_NEAR(std::abs(last.heading.value()), std::numbers::pi, 1e-9);
+
+    double topSpeed = 0;
+    double cornerSpeed = 10;
+    for (std::size_t i = 1; i < trajectory.Size(); ++i)
+    {
+        auto sample = trajectory[i];
+        auto previous = trajectory[i - 1];
+        EXPECT_GT(sample.timestamp, previous.timestamp);
+        double speed = std::hypot(sample.vx.value(), sample.vy.value());
+        double previousSpeed =
+            std::hypot(previous.vx.value(), previous.vy.value());
+        EXPECT_LE(speed, 2 + 1e-9);
+        double dt = (sample.timestamp - previous.timestamp).value();
+        EXPECT_LE(std::abs(speed - previousSpeed) / dt, 4 + 1e-6);
+        topSpeed = std::max(topSpeed, speed);
+        // Passing the first corner, at (5, 1)
+        if (std::hypot(sample.x.value() - 5, sample.y.value() - 1) < 0.3)
+        {
+            cornerSpeed = std::min(cornerSpeed, speed);
+        }
+    }
+    EXPECT_NEAR(topSpeed, 2, 1e-9);
+    EXPECT_LT(cornerSpeed, 2);
+    EXPECT_GT(cornerSpeed, 0.5);
+}
+
+TEST(PathfinderTest, SearchesTheFieldQuicklyWithoutAllocating)
+{
+    auto grid = FieldGrid().Inflated(0.3_m);
+    Pathfinder pathfinder{grid};
+    std::vector<frc::Translation2d> waypoints;
+    waypoints.reserve(grid.Width() * grid.Height());
+
+    // Corner to corner, around both obstacles
+    frc::Translation2d start{0.7_m, 0.7_m};
+    frc::Translation2d goal{16.9_m, 7.3_m};
+    ASSERT_TRUE(pathfinder.FindPath(start, goal, waypoints));
+
+    auto before = test::AllocationCount();
+    auto fastest = test::Fastest(
+        20, [&] { pathfinder.FindPath(start, goal, waypoints); });
+    EXPECT_EQ(test::AllocationCount(), before);
+
+    double microseconds =
+        std::chrono::duration<double, std::micro>(fastest).count();
+    RecordProperty("microseconds", static_cast<int>(microseconds));
+    RecordProperty("expanded", pathfinder.LastExpanded());
+    // A debug desktop build; the roboRIO is several times slower
+    if (double scale = test::TimeScale(); scale > 0)
+    {
+        EXPECT_LT(microseconds, 500 * scale);
+    }
+}
@@ -0,0 +1,86 @@
+#include <frc/DriverStation.h>
+#include <frc/geometry/Pose2d.h>
+#include <replay/ReplayInputs.h>
+#include <units/angle.h>
+#include <units/length.h>
+#include <wpi/DataLog.h>
+#include <wpi/DataLogWriter.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+using namespace units::literals;
+
+namespace
+{
+    /** @brief Writes a short log with the entries a match log would have */
+    std::string WriteMatchLog()
+    {
+        auto path = std::filesystem::temp_directory_path() /
+                    "replay_inputs_test.wpilog";
+        std::error_code ec;
+        wpi::log::DataLogWriter log{path.string(), ec};
+        EXPECT_FALSE(ec) << ec.message();
+
+        wpi::log::BooleanLogEntry enabled{log, "DS:enabled", 1'000};
+        enabled.Append(false, 1'000);
+        enabled.Append(true, 2'000'000);
+
+        wpi::log::FloatArrayLogEntry axes{log, "DS:joystick1/axes", 1'000};
+        axes.Append({0.5f, -1.0f}, 1'000);
+
+        wpi::log::BooleanArrayLogEntry buttons{log, "DS:joystick1/buttons",
+                                               1'000};
+        buttons.Append({false, true}, 1'000);
+
+        wpi::log::StructLogEntry<frc::Pose2d> pose{log, "robot/drive/pose",
+                                                   1'000};
+        pose.Append(frc::Pose2d{0_m, 0_m, 0_deg}, 1'000'000);
+        pose.Append(frc::Pose2d{2_m, 0_m, 0_deg}, 2'000'000);
+
+        log.Flush();
+        return path.string();
+    }
+}  // namespace
+
+TEST(ReplayInputsTest, StartsAtTheFirstDriverStationSample)
+{
+    ReplayInputs inputs{WriteMatchLog()};
+    EXPECT_EQ(inputs.GetStartTime(), 1'000);
+    EXPECT_EQ(inputs.GetEndTime(), 2'000'000);
+}
+
+TEST(ReplayInputsTest, InterpolatesPosesBetweenSamples)
+{
+    ReplayInputs inputs{WriteMatchLog()};
+    EXPECT_FALSE(inputs.GetPose(500'000));
+
+    auto pose = inputs.GetPose(1'500'000);
+    ASSERT_TRUE(pose);
+    EXPECT_NEAR(pose->X().value(), 1.0, 1e-9);
+
+    // Holds the last sample past the end of the log
+    EXPECT_NEAR(inputs.GetPose(3'000'000)->X().value(), 2.0, 1e-9);
+}
+
+TEST(ReplayInputsTest, AppliesRecordedJoysticks)
+{
+    ReplayInputs inputs{WriteMatchLog()};
+    inputs.ApplyDriverStation(2'000'000);
+    frc::DriverStation::RefreshData();
+
+    EXPECT_FLOAT_EQ(frc::DriverStation::GetStickAxis(1, 0), 0.5);
+    EXPECT_FLOAT_EQ(frc::DriverStation::GetStickAxis(1, 1), -1.0);
+    EXPECT_FALSE(frc::DriverStation::GetStickButton(1, 1));
+    EXPECT_TRUE(frc::DriverStation::GetStickButton(1, 2));
+}
+
+TEST(ReplayInputsTest, RejectsFilesThatAreNotLogs)
+{
+    EXPECT_THROW(ReplayInputs{"does_not_exist.wpilog"}, std::runtime_error);
+}
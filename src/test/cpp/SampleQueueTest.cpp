@@ -0,0 +1,63 @@
+#include <util/SampleQueue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+TEST(SampleQueueTest, DropsSamplesWhileFull)
+{
+    SampleQueue<int> queue{3};
+    ASSERT_EQ(queue.Capacity(), 4u);
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(queue.TryPush(i), i < 4);
+    }
+    EXPECT_EQ(queue.Dropped(), 2u);
+
+    int expected = 0;
+    EXPECT_EQ(queue.Drain([&](int sample) { EXPECT_EQ(sample, expected++); }),
+              4u);
+    EXPECT_TRUE(queue.TryPush(4));
+    EXPECT_EQ(queue.Drain([](int sample) { EXPECT_EQ(sample, 4); }), 1u);
+}
+
+TEST(SampleQueueTest, DeliversEverySampleInOrderAcrossThreads)
+{
+    constexpr std::int64_t kSamples = 10'000;
+    SampleQueue<std::int64_t> queue{64};
+    std::atomic<bool> done{false};
+
+    std::thread producer{[&]
+                         {
+                             for (std::int64_t i = 0; i < kSamples;)
+                             {
+                                 // Retry instead of dropping, to check order
+                                 if (queue.TryPush(i))
+                                 {
+                                     ++i;
+                                 }
+                                 else
+                                 {
+                                     std::this_thread::yield();
+                                 }
+                             }
+                             done = true;
+                         }};
+
+    std::int64_t next = 0;
+    auto consume = [&](std::int64_t sample) { ASSERT_EQ(sample, next++); };
+    while (!done)
+    {
+        if (queue.Drain(consume) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    queue.Drain(consume);
+    producer.join();
+    EXPECT_EQ(next, kSamples);
+}
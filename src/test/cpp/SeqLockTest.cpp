@@ -0,0 +1,108 @@
+#include <util/SeqLock.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+
+namespace
+{
+    /** @brief Bigger than a word, with fields that must match each other */
+    struct Reading
+    {
+        std::int64_t sequence = 0;
+        double values[5] = {};
+        bool valid = false;
+    };
+
+    Reading MakeReading(std::int64_t sequence)
+    {
+        Reading reading;
+        reading.sequence = sequence;
+        for (auto& value : reading.values)
+        {
+            value = static_cast<double>(sequence);
+        }
+        reading.valid = true;
+        return reading;
+    }
+}  // namespace
+
+TEST(SeqLockTest, LoadsWhatWasStored)
+{
+    SeqLock<Reading> lock;
+    EXPECT_FALSE(lock.Load().valid);
+
+    lock.Store(MakeReading(7));
+    auto reading = lock.Load();
+    EXPECT_TRUE(reading.valid);
+    EXPECT_EQ(reading.sequence, 7);
+    EXPECT_DOUBLE_EQ(reading.values[4], 7.0);
+}
+
+TEST(SeqLockTest, ReadersNeverSeeTornValues)
+{
+    constexpr std::int64_t kWrites = 20'000;
+    SeqLock<Reading> lock{MakeReading(0)};
+    std::atomic<bool> done{false};
+
+    std::thread writer{[&]
+                       {
+                           for (std::int64_t i = 1; i <= kWrites; ++i)
+                           {
+                               lock.Store(MakeReading(i));
+                           }
+                           done = true;
+                       }};
+
+    std::int64_t last = 0;
+    while (!done)
+    {
+        auto reading = lock.Load();
+        for (double value : reading.values)
+        {
+            ASSERT_EQ(value, static_cast<double>(reading.sequence));
+        }
+        // Never goes back to an older value
+        ASSERT_GE(reading.sequence, last);
+        last = reading.sequence;
+        std::this_thread::yield();
+    }
+    writer.join();
+    EXPECT_EQ(lock.Load().sequence, kWrites);
+}
+
+TEST(SeqLockTest, WritersFromTwoThreadsTakeTurns)
+{
+    constexpr std::int64_t kWrites = 20'000;
+    SeqLock<Reading> lock{MakeReading(0)};
+    std::atomic<int> running{2};
+
+    auto write = [&](std::int64_t sign)
+    {
+        for (std::int64_t i = 1; i <= kWrites; ++i)
+        {
+            lock.Store(MakeReading(sign * i));
+        }
+        --running;
+    };
+    std::thread first{write, 1};
+    std::thread second{write, -1};
+
+    while (running > 0)
+    {
+        auto reading = lock.Load();
+        for (double value : reading.values)
+        {
+            ASSERT_EQ(value, static_cast<double>(reading.sequence));
+        }
+        std::this_thread::yield();
+    }
+    first.join();
+    second.join();
+    EXPECT_EQ(std::abs(lock.Load().sequence), kWrites);
+}
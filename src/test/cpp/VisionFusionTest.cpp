@@ -0,0 +1,339 @@
+#include <vision/SimulatedCamera.h>
+#include <vision/VisionFusion.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using namespace nfr;
+using namespace units::literals;
+
+namespace
+{
+    /** @brief Odometry of a robot driving along x at 4 m/s for a second */
+    frc::Pose2d DrivingPose(units::second_t time)
+    {
+        return frc::Pose2d{units::meter_t{4 * time.value()}, 0_m, 0_deg};
+    }
+
+    void AddDrivingOdometry(VisionFusion& fusion)
+    {
+        for (int i = 0; i <= 200; ++i)
+        {
+            units::second_t time{i * 0.005};
+            fusion.AddOdometry(time, DrivingPose(time));
+        }
+    }
+
+    VisionObservation Observation(units::second_t time, frc::Pose2d pose,
+                                  int tags = 2,
+                                  units::meter_t distance = 2_m)
+    {
+        VisionObservation observation;
+        observation.timestamp = time;
+        observation.pose = pose;
+        observation.tagCount = tags;
+        observation.averageTagDistance = distance;
+        return observation;
+    }
+}  // namespace
+
+TEST(VisionFusionTest, FusesInCaptureOrderWithScaledDeviations)
+{
+    VisionFusionConfig config;
+    VisionFusion fusion{config};
+    AddDrivingOdometry(fusion);
+
+    // Submitted as they arrived, not as they were captured
+    fusion.Submit(Observation(0.9_s, DrivingPose(0.9_s), 1, 2_m));
+    fusion.Submit(Observation(0.5_s, DrivingPose(0.5_s), 2, 2_m));
+    fusion.Submit(Observation(0.7_s, DrivingPose(0.7_s), 4, 0.5_m));
+    auto measurements = fusion.Process(1_s);
+
+    ASSERT_EQ(measurements.size(), 3u);
+    EXPECT_DOUBLE_EQ(measurements[0].timestamp.value(), 0.5);
+    EXPECT_DOUBLE_EQ(measurements[1].timestamp.value(), 0.7);
+    EXPECT_DOUBLE_EQ(measurements[2].timestamp.value(), 0.9);
+
+    // Two tags 2 m away: 2² / 2 times the multi-tag deviations
+    EXPECT_DOUBLE_EQ(measurements[0].standardDeviations[0],
+                     config.multiTagStandardDeviation[0] * 2);
+    EXPECT_DOUBLE_EQ(measurements[0].standardDeviations[2],
+                     config.multiTagStandardDeviation[2] * 2);
+    // Four close tags are trusted as if they were 1 m away
+    EXPECT_DOUBLE_EQ(measurements[1].standardDeviations[0],
+                     config.multiTagStandardDeviation[0] / 4);
+    // One tag 2 m away: 2² times the single-tag deviations
+    EXPECT_DOUBLE_EQ(measurements[2].standardDeviations[1],
+                     config.singleTagStandardDeviation[1] * 4);
+
+    // Each batch is only returned once
+    EXPECT_TRUE(fusion.Process(1_s).empty());
+}
+
+TEST(VisionFusionTest, ChecksAgainstOdometryAtCaptureTime)
+{
+    VisionFusion fusion{VisionFusionConfig{}};
+    AddDrivingOdometry(fusion);
+    fusion.Submit(Observation(0.5_s, DrivingPose(0.5_s)));
+    ASSERT_EQ(fusion.Process(1_s).size(), 1u);
+
+    // A frame from 0.5 s ago shows where the robot was then, 2 m back
+    fusion.Submit(Observation(0.5_s, DrivingPose(0.5_s)));
+    // Where the robot is now, but stamped 0.5 s ago
+    fusion.Submit(Observation(0.5_s, DrivingPose(1_s)));
+    // Right place, but turned around
+    fusion.Submit(Observation(
+        0.6_s, frc::Pose2d{DrivingPose(0.6_s).Translation(), 180_deg}));
+    auto measurements = fusion.Process(1_s);
+
+    ASSERT_EQ(measurements.size(), 1u);
+    EXPECT_DOUBLE_EQ(measurements[0].pose.X().value(), 2);
+    auto stats = fusion.GetStats();
+    EXPECT_EQ(stats.accepted, 2u);
+    EXPECT_EQ(stats.rejected[VisionFusion::kDisagrees], 2u);
+}
+
+TEST(VisionFusionTest, RejectsUnusableObservations)
+{
+    VisionFusionConfig config;
+    config.historyLength = 0.5_s;
+    VisionFusion fusion{config};
+    fusion.Submit(Observation(0.9_s, DrivingPose(0.9_s)));
+    EXPECT_TRUE(fusion.Process(1_s).empty());  // No odometry yet
+
+    AddDrivingOdometry(fusion);
+    fusion.Submit(Observation(0.9_s, DrivingPose(0.9_s), 0));
+    fusion.Submit(Observation(0.9_s, DrivingPose(0.9_s), 2, 6_m));
+    fusion.Submit(Observation(0.2_s, DrivingPose(0.2_s)));  // Before history
+    fusion.Submit(Observation(1.5_s, DrivingPose(1_s)));    // In the future
+    EXPECT_TRUE(fusion.Process(1_s).empty());
+
+    auto stats = fusion.GetStats();
+    EXPECT_EQ(stats.accepted, 0u);
+    EXPECT_EQ(stats.rejected[VisionFusion::kNoTags], 1u);
+    EXPECT_EQ(stats.rejected[VisionFusion::kTooFar], 1u);
+    EXPECT_EQ(stats.rejected[VisionFusion::kStale], 3u);
+}
+
+TEST(VisionFusionTest, RealignsAfterReset)
+{
+    VisionFusion fusion{VisionFusionConfig{}};
+    AddDrivingOdometry(fusion);
+    fusion.Submit(Observation(0.5_s, DrivingPose(0.5_s)));
+    ASSERT_EQ(fusion.Process(1_s).size(), 1u);
+
+    // Odometry was reset to the wrong spot; vision gets to fix it, but
+    // only with a pose a single tag can't have misread
+    fusion.Reset();
+    fusion.AddOdometry(1_s, frc::Pose2d{});
+    fusion.AddOdometry(1.1_s, frc::Pose2d{});
+    fusion.Submit(Observation(1.05_s, DrivingPose(1_s), 1));
+    EXPECT_TRUE(fusion.Process(1.1_s).empty());
+    EXPECT_EQ(fusion.GetStats().rejected[VisionFusion::kUnaligned], 1u);
+    fusion.Submit(Observation(1.05_s, DrivingPose(1_s), 2));
+    EXPECT_EQ(fusion.Process(1.1_s).size(), 1u);
+    EXPECT_EQ(fusion.GetStats().rejected[VisionFusion::kDisagrees], 0u);
+}
+
+TEST(VisionFusionTest, RealignsWhenOdometryJumps)
+{
+    VisionFusionConfig config;
+    VisionFusion fusion{config};
+    const frc::Pose2d actual;
+    fusion.AddOdometry(0_s, actual);
+    fusion.AddOdometry(0.02_s, actual);
+    fusion.Submit(Observation(0.01_s, actual));
+    ASSERT_EQ(fusion.Process(0.02_s).size(), 1u);
+
+    // Misreads in a row land all over, so odometry isn't given up on
+    for (auto misread : {frc::Pose2d{3_m, 0_m, 0_deg},
+                         frc::Pose2d{-3_m, 0_m, 0_deg},
+                         frc::Pose2d{0_m, 3_m, 0_deg},
+                         frc::Pose2d{0_m, -3_m, 0_deg},
+                         frc::Pose2d{3_m, 3_m, 0_deg}})
+    {
+        fusion.Submit(Observation(0.01_s, misread));
+    }
+    EXPECT_TRUE(fusion.Process(0.02_s).empty());
+
+    // A collision knocks odometry 2 m off. The cameras agree on where the
+    // robot really is, so after a few frames they pull it back in (moving
+    // halfway toward each measurement, like the pose estimator)
+    frc::Pose2d estimate{2_m, 0_m, 0_deg};
+    int fused = 0;
+    for (int cycle = 0; cycle < 10; ++cycle)
+    {
+        units::second_t time{0.04 + cycle * 0.02};
+        fusion.AddOdometry(time, estimate);
+        fusion.AddOdometry(time + 0.02_s, estimate);
+        fusion.Submit(Observation(time + 0.01_s, actual));
+        for (const auto& measurement : fusion.Process(time + 0.02_s))
+        {
+            ++fused;
+            estimate = frc::Pose2d{
+                (estimate.Translation() + measurement.pose.Translation()) *
+                    0.5,
+                estimate.Rotation()};
+        }
+    }
+    EXPECT_LT(estimate.Translation().Norm().value(), 0.1);
+    EXPECT_EQ(fused, 10 - (config.realignAfter - 1));
+
+    auto stats = fusion.GetStats();
+    EXPECT_EQ(stats.realigned, 1u);
+    EXPECT_EQ(stats.rejected[VisionFusion::kDisagrees],
+              5u + static_cast<std::uint64_t>(config.realignAfter - 1));
+
+    // Back in line, so a misread is dropped again
+    units::second_t time{0.24};
+    fusion.AddOdometry(time, estimate);
+    fusion.Submit(Observation(time - 0.01_s, frc::Pose2d{3_m, 0_m, 0_deg}));
+    EXPECT_TRUE(fusion.Process(time).empty());
+}
+
+TEST(VisionFusionTest, PullsFarOffOdometryInBeforeChecking)
+{
+    // The robot booted at the origin, but the cameras see it across the
+    // field. Like the pose estimator, move halfway toward each measurement
+    VisionFusion fusion{VisionFusionConfig{}};
+    const frc::Pose2d actual{5_m, 3_m, 90_deg};
+    frc::Pose2d estimate;
+    for (int cycle = 0; cycle < 6; ++cycle)
+    {
+        units::second_t time{cycle * 0.02};
+        fusion.AddOdometry(time, estimate);
+        fusion.AddOdometry(time + 0.02_s, estimate);
+        fusion.Submit(Observation(time + 0.01_s, actual));
+        auto measurements = fusion.Process(time + 0.02_s);
+        ASSERT_EQ(measurements.size(), 1u) << "cycle " << cycle;
+        const auto& measured = measurements[0].pose;
+        estimate = frc::Pose2d{
+            estimate.Translation() +
+                (measured.Translation() - estimate.Translation()) * 0.5,
+            estimate.Rotation() +
+                frc::Rotation2d{
+                    (measured.Rotation() - estimate.Rotation()).Radians() *
+                    0.5}};
+    }
+    EXPECT_LT(estimate.Translation().Distance(actual.Translation()).value(),
+              0.2);
+
+    // Once a frame has agreed, a misread is checked against odometry
+    fusion.AddOdometry(0.14_s, estimate);
+    fusion.Submit(Observation(0.13_s, frc::Pose2d{7_m, 3_m, 90_deg}));
+    EXPECT_TRUE(fusion.Process(0.14_s).empty());
+    EXPECT_EQ(fusion.GetStats().rejected[VisionFusion::kDisagrees], 1u);
+}
+
+TEST(VisionFusionTest, DropsObservationsBeyondTheQueue)
+{
+    VisionFusionConfig config;
+    config.queueSize = 2;
+    VisionFusion fusion{config};
+    AddDrivingOdometry(fusion);
+    EXPECT_TRUE(fusion.Submit(Observation(0.5_s, DrivingPose(0.5_s))));
+    EXPECT_TRUE(fusion.Submit(Observation(0.6_s, DrivingPose(0.6_s))));
+    EXPECT_FALSE(fusion.Submit(Observation(0.7_s, DrivingPose(0.7_s))));
+    EXPECT_EQ(fusion.Process(1_s).size(), 2u);
+    EXPECT_EQ(fusion.GetStats().dropped, 1u);
+
+    // The queue has room again
+    EXPECT_TRUE(fusion.Submit(Observation(0.8_s, DrivingPose(0.8_s))));
+}
+
+TEST(VisionFusionTest, SimulatedCameraSeesTagsInFront)
+{
+    SimulatedCameraConfig config;
+    config.maxRange = 4_m;
+    config.latency = 50_ms;
+    // A tag 2 m ahead facing the robot, one behind it, one out of range
+    SimulatedCamera camera{config,
+                           {frc::Pose2d{2_m, 0_m, 180_deg},
+                            frc::Pose2d{-2_m, 0_m, 0_deg},
+                            frc::Pose2d{6_m, 0_m, 180_deg}}};
+
+    auto frame = camera.Capture(1_s, frc::Pose2d{});
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->tagCount, 1);
+    EXPECT_DOUBLE_EQ(frame->averageTagDistance.value(), 2);
+    EXPECT_NEAR(frame->pose.X().value(), 0, 0.5);
+
+    // Facing away from it, or behind the tag, sees nothing
+    EXPECT_FALSE(camera.Capture(1_s, frc::Pose2d{0_m, 0_m, 90_deg}));
+    EXPECT_FALSE(camera.Capture(1_s, frc::Pose2d{3_m, 0_m, 180_deg}));
+
+    // Frames come out once their latency has passed, stamped when captured
+    EXPECT_FALSE(camera.Update(2_s, frc::Pose2d{}));
+    auto late = camera.Update(2.05_s, frc::Pose2d{});
+    ASSERT_TRUE(late.has_value());
+    EXPECT_DOUBLE_EQ(late->timestamp.value(), 2);
+}
+
+TEST(VisionFusionTest, RejectsSimulatedOutliersFromACameraThread)
+{
+    // Two tags on a wall ahead, seen by a camera that misreads a fifth of
+    // its frames
+    SimulatedCameraConfig cameraConfig;
+    cameraConfig.outlierRate = 0.2;
+    SimulatedCamera camera{cameraConfig,
+                           {frc::Pose2d{3_m, 1_m, 180_deg},
+                            frc::Pose2d{3_m, -1_m, 180_deg}},
+                           42};
+    constexpr int kFrames = 100;
+    constexpr units::second_t kEnd{kFrames * 0.02};
+    VisionFusionConfig config;
+    config.queueSize = kFrames;
+    config.historyLength = kEnd;
+    VisionFusion fusion{config};
+
+    // The robot sits at the origin, and odometry agrees
+    fusion.AddOdometry(0_s, frc::Pose2d{});
+    fusion.AddOdometry(kEnd, frc::Pose2d{});
+    fusion.Submit(Observation(0_s, frc::Pose2d{}));
+    ASSERT_EQ(fusion.Process(kEnd).size(), 1u);
+
+    std::atomic<bool> done{false};
+    std::thread cameraThread{
+        [&]
+        {
+            for (int i = 1; i <= kFrames; ++i)
+            {
+                auto frame =
+                    camera.Capture(units::second_t{i * 0.02}, frc::Pose2d{});
+                ASSERT_TRUE(frame.has_value());
+                fusion.Submit(*frame);
+                std::this_thread::yield();
+            }
+            done = true;
+        }};
+
+    // The robot thread fuses whatever has arrived each cycle
+    int fused = 0;
+    double worstError = 0;
+    bool finished = false;
+    while (!finished)
+    {
+        finished = done.load();
+        for (const auto& measurement : fusion.Process(kEnd))
+        {
+            ++fused;
+            worstError = std::max(
+                worstError, measurement.pose.Translation().Norm().value());
+        }
+        std::this_thread::yield();
+    }
+    cameraThread.join();
+
+    // Every frame was either fused or rejected, exactly once
+    auto stats = fusion.GetStats();
+    EXPECT_EQ(stats.dropped, 0u);
+    EXPECT_EQ(static_cast<int>(stats.accepted), fused + 1);
+    EXPECT_EQ(stats.accepted + stats.rejected[VisionFusion::kDisagrees],
+              static_cast<std::uint64_t>(kFrames + 1));
+    // Roughly the misread fifth is rejected, and none of it got through
+    EXPECT_NEAR(stats.rejected[VisionFusion::kDisagrees], 20, 12);
+    EXPECT_LT(worstError, 1.0);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file Main.cpp
+ * @brief Command-line tool that saves trajectories in the form the robot maps
+ *
+ * Converts every Choreo trajectory (choreo/<name>.traj) and PathPlanner path
+ * (pathplanner/paths/<name>.path) in the deploy directory to a CachedTrajectory
+ * and saves it as <name>.trajcache, so the robot doesn't parse or generate
+ * anything when autonomous starts. Built for the desktop only, and run from
+ * the project directory by the buildTrajectoryCache task (see build.gradle),
+ * which deploy depends on:
+ *
+ * ```bash
+ * trajectoryCache build/trajectories
+ * ```
+ */
+
+#include <frc/Filesystem.h>
+#include <hal/HALBase.h>
+#include <wpi/fs.h>
+
+#include <cstdio>
+#include <exception>
+#include <set>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "trajectory/TrajectoryImport.h"
+
+using namespace nfr;
+using namespace std;
+
+namespace
+{
+    /** @brief Adds the name of each file in a directory with an extension */
+    void AddNames(const fs::path& directory, string_view extension,
+                  set<string>& names)
+    {
+        error_code ec;
+        for (const auto& file : fs::directory_iterator{directory, ec})
+        {
+            if (file.path().extension() == extension)
+            {
+                names.insert(file.path().stem().string());
+            }
+        }
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: trajectoryCache <output directory>\n");
+        return 1;
+    }
+    // PathPlanner reports its usage through the HAL
+    if (!HAL_Initialize(500, 0))
+    {
+        fprintf(stderr, "FATAL: HAL could not be initialized\n");
+        return 1;
+    }
+
+    fs::path deploy{frc::filesystem::GetDeployDirectory()};
+    set<string> names;
+    AddNames(deploy / "choreo", ".traj", names);
+    AddNames(deploy / "pathplanner" / "paths", ".path", names);
+
+    fs::path output{argv[1]};
+    int failures = 0;
+    try
+    {
+        fs::create_directories(output);
+        for (const auto& name : names)
+        {
+            auto trajectory = ConvertTrajectory(name);
+            if (!trajectory)
+            {
+                ++failures;
+                continue;
+            }
+            auto path = output / (name + string{CachedTrajectory::kExtension});
+            trajectory->Save(path.string());
+            printf("%s: %zu samples, %.2f s\n", name.c_str(),
+                   trajectory->Size(), trajectory->TotalTime().value());
+        }
+    }
+    catch (const exception& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}